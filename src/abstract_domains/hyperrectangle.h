@@ -76,6 +76,18 @@ static inline void hyperrectangle_delete(Hyperrectangle *H) {
 
 
 
+/**
+ * Returns memory held by a hyperrectangle.
+ *
+ * @param[in] x Hyperrectangle
+ * @return Size of hyperrectangle (bytes)
+ */
+static inline size_t hyperrectangle_get_memory_size(const Hyperrectangle x) {
+    return sizeof(struct hyperrectangle) + x->n * sizeof(Interval);
+}
+
+
+
 /**
  * Tells whether a hyperrectangle is bottom: \f$x = \bot\f$.
  *
@@ -184,6 +196,7 @@ static inline Real hyperrectangle_volume(const Hyperrectangle x) {
  * @param[out] r Result
  * @param[in] x First addendum
  * @param[in] y Second addendum
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_add(Hyperrectangle r, const Hyperrectangle x, const Hyperrectangle y) {
     unsigned int i;
@@ -201,6 +214,7 @@ static inline void hyperrectangle_add(Hyperrectangle r, const Hyperrectangle x,
  * @param[out] r Result
  * @param[in] x Minuendum
  * @param[in] y Subtrahendum
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_sub(Hyperrectangle r, const Hyperrectangle x, const Hyperrectangle y) {
     unsigned int i;
@@ -218,6 +232,7 @@ static inline void hyperrectangle_sub(Hyperrectangle r, const Hyperrectangle x,
  * @param[out] r Result
  * @param[in] x First factor
  * @param[in] y Second factor
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_mul(Hyperrectangle r, const Hyperrectangle x, const Hyperrectangle y) {
     unsigned int i;
@@ -235,6 +250,7 @@ static inline void hyperrectangle_mul(Hyperrectangle r, const Hyperrectangle x,
  * @param[out] r Result
  * @param[in] x Base (hyperrectangle)
  * @param[in] degree Natural exponent
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_pow(Hyperrectangle r, const Hyperrectangle x, const unsigned int degree) {
     unsigned int i;
@@ -251,6 +267,7 @@ static inline void hyperrectangle_pow(Hyperrectangle r, const Hyperrectangle x,
  *
  * @param[out] r Result
  * @param[in] x Exponent (hyperrectangle)
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_exp(Hyperrectangle r, const Hyperrectangle x) {
     unsigned int i;
@@ -268,6 +285,7 @@ static inline void hyperrectangle_exp(Hyperrectangle r, const Hyperrectangle x)
  * @param[out] r Result
  * @param[in] x Hyperrectangle
  * @param[in] t Translation vector
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_translate(Hyperrectangle r, const Hyperrectangle x, const Real *t) {
     unsigned int i;
@@ -285,6 +303,7 @@ static inline void hyperrectangle_translate(Hyperrectangle r, const Hyperrectang
  * @param[out] r Result
  * @param[in] x Hyperrectangle
  * @param[in] s Scaling factor
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_scale(Hyperrectangle r, const Hyperrectangle x, const Real *s) {
     unsigned int i;
@@ -302,6 +321,7 @@ static inline void hyperrectangle_scale(Hyperrectangle r, const Hyperrectangle x
  * @param[out] r Result
  * @param[in] x Hyperrectangle
  * @param[in] s Scaling factor
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_scale_homogeneous(Hyperrectangle r, const Hyperrectangle x, const Real s) {
     unsigned int i;
@@ -320,6 +340,7 @@ static inline void hyperrectangle_scale_homogeneous(Hyperrectangle r, const Hype
  * @param[in] alpha Scaling factor
  * @param[in] x First addendum
  * @param[in] y Second addendum
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void hyperrectangle_fma(Hyperrectangle r, const Real alpha, const Hyperrectangle x, const Hyperrectangle y) {
     unsigned int i;
@@ -9,6 +9,9 @@
  * represented symbolically as a pair
  * \f$\langle l, u \rangle \in \mathbb{R}^2\f$.
  *
+ * When ENFORCE_SOUNDNESS is defined, arithmetic transfer functions round
+ * outwards, provided that rounding mode was set by #rounding_begin.
+ *
  * @file interval.h
  * @author Marco Zanella <marco.zanella.1991@gmail.com>
  */
@@ -112,12 +115,11 @@ static inline Real interval_sample(const Interval x) {
  * @param[out] r Result
  * @param[in] x First addendum
  * @param[in] y Second addendum
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_add(Interval *r, const Interval x, const Interval y) {
-    round_down;
-    r->l = x.l + y.l;
-    round_up;
-    r->u = x.u + y.u;
+    r->l = add_down(x.l, y.l);
+    r->u = add_up(x.u, y.u);
 }
 
 
@@ -128,12 +130,11 @@ static inline void interval_add(Interval *r, const Interval x, const Interval y)
  * @param[out] r Result
  * @param[in] x Minuendum
  * @param[in] y Subtrahendum
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_sub(Interval *r, const Interval x, const Interval y) {
-    round_down;
-    r->l = x.l - y.l;
-    round_up;
-    r->u = x.u - y.u;
+    r->l = sub_down(x.l, y.l);
+    r->u = sub_up(x.u, y.u);
 }
 
 
@@ -144,6 +145,7 @@ static inline void interval_sub(Interval *r, const Interval x, const Interval y)
  * @param[out] r Result
  * @param[in] x First factor
  * @param[in] y Second factor
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_mul(Interval *r, const Interval x, const Interval y) {
     if ((x.l == 0.0 && x.u == 0.0) || (y.l == 0.0 && y.u == 0.0)) {
@@ -154,66 +156,48 @@ static inline void interval_mul(Interval *r, const Interval x, const Interval y)
 
     if (x.l >= 0.0) {
         if (y.l >= 0.0) {
-            round_down;
-            r->l = x.l * y.l;
-            round_up;
-            r->u = x.u * y.u;
+            r->l = mul_down(x.l, y.l);
+            r->u = mul_up(x.u, y.u);
         }
 
         else if (y.u <= 0.0) {
-            round_down;
-            r->l = x.u * y.l;
-            round_up;
-            r->u = x.l * y.u;
+            r->l = mul_down(x.u, y.l);
+            r->u = mul_up(x.l, y.u);
         }
 
         else {
-            round_down;
-            r->l = x.u * y.l;
-            round_up;
-            r->u = x.u * y.u;
+            r->l = mul_down(x.u, y.l);
+            r->u = mul_up(x.u, y.u);
         }
     }
 
     else if (x.u <= 0.0) {
         if (y.l >= 0.0) {
-            round_down;
-            r->l = x.l * y.u;
-            round_up;
-            r->u = x.u * y.l;
+            r->l = mul_down(x.l, y.u);
+            r->u = mul_up(x.u, y.l);
         }
         else if (y.u <= 0.0) {
-            round_down;
-            r->l = x.u * y.u;
-            round_up;
-            r->u = x.l * y.l;
+            r->l = mul_down(x.u, y.u);
+            r->u = mul_up(x.l, y.l);
         }
         else {
-            round_down;
-            r->l = x.l * y.u;
-            round_up;
-            r->u = x.l * y.l;
+            r->l = mul_down(x.l, y.u);
+            r->u = mul_up(x.l, y.l);
         }
     }
 
     else {
         if (y.l >= 0.0) {
-            round_down;
-            r->l = x.l * y.u;
-            round_up;
-            r->u = x.u * y.u;
+            r->l = mul_down(x.l, y.u);
+            r->u = mul_up(x.u, y.u);
         }
         else if (y.u <= 0.0) {
-            round_down;
-            r->l = x.u * y.l;
-            round_up;
-            r->u = x.l * y.l;
+            r->l = mul_down(x.u, y.l);
+            r->u = mul_up(x.l, y.l);
         }
         else {
-            round_down;
-            r->l = min(x.l * y.u, x.u * y.l);
-            round_up;
-            r->u = max(x.l * y.l, x.u * y.u);
+            r->l = min(mul_down(x.l, y.u), mul_down(x.u, y.l));
+            r->u = max(mul_up(x.l, y.l), mul_up(x.u, y.u));
         }
     }
 }
@@ -226,6 +210,7 @@ static inline void interval_mul(Interval *r, const Interval x, const Interval y)
  * @param[out] r Result
  * @param[in] x Base (interval)
  * @param[in] degree Natural exponent
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_pow(Interval *r, const Interval x, const unsigned int degree) {
     unsigned int i;
@@ -243,12 +228,11 @@ static inline void interval_pow(Interval *r, const Interval x, const unsigned in
  *
  * @param[out] r Result
  * @param[in] x Exponent (interval)
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_exp(Interval *r, const Interval x) {
-    round_down;
-    r->l = exp(x.l);
-    round_up;
-    r->u = exp(x.u);
+    r->l = to_real_down(exp_down(x.l));
+    r->u = to_real_up(exp_up(x.u));
 }
 
 
@@ -259,12 +243,11 @@ static inline void interval_exp(Interval *r, const Interval x) {
  * @param[out] r Result
  * @param[in] x Interval
  * @param[in] t Translation length
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_translate(Interval *r, const Interval x, const Real t) {
-    round_down;
-    r->l = x.l + t;
-    round_up;
-    r->u = x.u + t;
+    r->l = add_down(x.l, t);
+    r->u = add_up(x.u, t);
 }
 
 
@@ -275,19 +258,16 @@ static inline void interval_translate(Interval *r, const Interval x, const Real
  * @param[out] r Result
  * @param[in] x Interval
  * @param[in] s Scaling factor
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_scale(Interval *r, const Interval x, const Real s) {
     if (s >= 0.0) {
-        round_down;
-        r->l = s * x.l;
-        round_up;
-        r->u = s * x.u;
+        r->l = mul_down(s, x.l);
+        r->u = mul_up(s, x.u);
     }
     else {
-        round_down;
-        r->l = s * x.u;
-        round_up;
-        r->u = s * x.l;
+        r->l = mul_down(s, x.u);
+        r->u = mul_up(s, x.l);
     }
 }
 
@@ -300,19 +280,16 @@ static inline void interval_scale(Interval *r, const Interval x, const Real s) {
  * @param[in] alpha Scaling factor
  * @param[in] x First addendum
  * @param[in] y Second addendum
+ * @pre With ENFORCE_SOUNDNESS, rounding mode was set by #rounding_begin
  */
 static inline void interval_fma(Interval *r, const Real alpha, const Interval x, const Interval y) {
     if (alpha >= 0) {
-        round_down;
-        r->l = alpha * x.l + y.l;
-        round_up;
-        r->u = alpha * x.u + y.u;
+        r->l = add_down(mul_down(alpha, x.l), y.l);
+        r->u = add_up(mul_up(alpha, x.u), y.u);
     }
     else {
-        round_down;
-        r->l = alpha * x.u + y.l;
-        round_up;
-        r->u = alpha * x.l + y.u;
+        r->l = add_down(mul_down(alpha, x.u), y.l);
+        r->u = add_up(mul_up(alpha, x.l), y.u);
     }
 }
 
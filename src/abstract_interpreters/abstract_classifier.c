@@ -73,6 +73,29 @@ void abstract_classifier_is_stable(
 
 
 
+double abstract_classifier_estimate_difficulty(
+    const AbstractClassifier AC,
+    const AdversarialRegion x
+) {
+    if (AC == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    switch (AC->A.type) {
+    case DOMAIN_INTERVAL:
+        fprintf(stderr, "[%s: %d] Cannot use interval abstract domain.\n", __FILE__, __LINE__);
+        abort();
+
+    case DOMAIN_HYPERRECTANGLE:
+        return classifier_hyperrectangle_estimate_difficulty(AC->C, x);
+    }
+
+    return 0.0;
+}
+
+
+
 void abstract_classifier_print(
     const AbstractClassifier AC,
     FILE *stream
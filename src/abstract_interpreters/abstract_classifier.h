@@ -63,6 +63,23 @@ void abstract_classifier_is_stable(
 
 
 
+/**
+ * Estimates difficulty of asserting whether a classifier is stable.
+ *
+ * Estimates are cheap to compute and only meant to compare samples with each
+ * other, for example to analyse the hardest ones first.
+ *
+ * @param[in] AC Abstract classifier to analyse
+ * @param[in] x Adversarial region to analyse
+ * @return Estimated difficulty, higher for harder regions
+ */
+double abstract_classifier_estimate_difficulty(
+    const AbstractClassifier AC,
+    const AdversarialRegion x
+);
+
+
+
 /**
  * Prints an abstract classifier.
  *
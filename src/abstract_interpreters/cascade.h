@@ -0,0 +1,108 @@
+/**
+ * Staged analysis cascade.
+ *
+ * A cascade runs increasingly expensive analyses on the same adversarial
+ * region, escalating to the next stage only when the previous one was
+ * inconclusive: a concrete attack on random points, a one-shot interval
+ * overapproximation, a hyperrectangle search bounded by a refinement
+ * budget and, finally, a hyperrectangle search bounded by the sample
+ * timeout only. The frontier of the bounded search is handed over to the
+ * full search, so no refinement is repeated.
+ *
+ * @file cascade.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef CASCADE_H
+#define CASCADE_H
+
+#include <stdio.h>
+
+
+/** Number of stages in a cascade. */
+#define CASCADE_N_STAGES 4
+
+
+/** Stages of a cascade. */
+typedef enum {
+    CASCADE_ATTACK,          /**< Concrete classification of random points. */
+    CASCADE_INTERVAL,        /**< Interval overapproximation of the whole
+                                  region, without refinement. */
+    CASCADE_BOUNDED_SEARCH,  /**< Hyperrectangle search with a small
+                                  refinement budget. */
+    CASCADE_FULL_SEARCH      /**< Hyperrectangle search bounded by timeout. */
+} CascadeStage;
+
+
+/** Structure of a cascade. */
+struct cascade {
+    unsigned int enabled;            /**< 1 if cascade is enabled, 0 otherwise. */
+    unsigned int n_attack_samples;   /**< Number of random points tried by
+                                          the attack stage. */
+    unsigned int budget;             /**< Maximum number of refinements of the
+                                          bounded search stage. */
+    unsigned int n_entered[CASCADE_N_STAGES];  /**< Number of samples which
+                                                    entered each stage. */
+    unsigned int n_decided[CASCADE_N_STAGES];  /**< Number of samples decided
+                                                    by each stage. */
+    double time[CASCADE_N_STAGES];   /**< CPU time spent in each stage by
+                                          the analysing thread, in seconds. */
+};
+
+
+/** Type of a cascade. */
+typedef struct cascade Cascade;
+
+
+
+/**
+ * Initializes a cascade, resetting its statistics.
+ *
+ * @param[out] cascade Pointer to cascade
+ * @param[in] enabled 1 to enable cascade, 0 otherwise
+ * @param[in] n_attack_samples Number of random points tried by the attack
+ * @param[in] budget Maximum number of refinements of the bounded search
+ */
+static inline void cascade_init(
+    Cascade *cascade,
+    const unsigned int enabled,
+    const unsigned int n_attack_samples,
+    const unsigned int budget
+) {
+    unsigned int i;
+
+    cascade->enabled = enabled;
+    cascade->n_attack_samples = n_attack_samples;
+    cascade->budget = budget;
+    for (i = 0; i < CASCADE_N_STAGES; ++i) {
+        cascade->n_entered[i] = 0;
+        cascade->n_decided[i] = 0;
+        cascade->time[i] = 0.0;
+    }
+}
+
+
+
+/**
+ * Prints statistics of a cascade.
+ *
+ * @param[in] cascade Cascade
+ * @param[out] stream Stream
+ */
+static inline void cascade_print_summary(const Cascade cascade, FILE *stream) {
+    const char *names[CASCADE_N_STAGES] = {"attack", "interval", "bounded", "full"};
+    unsigned int i;
+
+    fprintf(stream, "[CASCADE] %10s %10s %10s %10s\n", "Stage", "Entered", "Decided", "Time (s)");
+    for (i = 0; i < CASCADE_N_STAGES; ++i) {
+        fprintf(
+            stream,
+            "[CASCADE] %10s %10u %10u %10g\n",
+            names[i],
+            cascade.n_entered[i],
+            cascade.n_decided[i],
+            cascade.time[i]
+        );
+    }
+}
+
+#endif
@@ -147,3 +147,41 @@ void classifier_hyperrectangle_is_stable(
 
     hyperrectangle_delete(&h);
 }
+
+
+
+void classifier_hyperrectangle_get_region(
+    Hyperrectangle h,
+    const AdversarialRegion x
+) {
+    if (x.perturbation.type == PERTURBATION_FROM_FILE) {
+        fprintf(stderr, "[%s: %d] Regions read from file cannot be computed in advance.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    adversarial_region_to_hyperrectangle(h, x);
+}
+
+
+
+double classifier_hyperrectangle_estimate_difficulty(
+    const Classifier C,
+    const AdversarialRegion x
+) {
+    Hyperrectangle h;
+    double difficulty = 0.0;
+
+    /* Regions read from file are consumed by the analysis itself, while a
+     * single tree is analysed by one visit */
+    if (x.perturbation.type == PERTURBATION_FROM_FILE
+        || classifier_get_type(C) != CLASSIFIER_FOREST) {
+        return difficulty;
+    }
+
+    hyperrectangle_create(&h, classifier_get_feature_space_size(C));
+    adversarial_region_to_hyperrectangle(h, x);
+    difficulty = forest_hyperrectangle_estimate_difficulty(classifier_get_forest(C), h);
+    hyperrectangle_delete(&h);
+
+    return difficulty;
+}
@@ -30,4 +30,32 @@ void classifier_hyperrectangle_is_stable(
     const Tier t
 );
 
+
+
+/**
+ * Computes the #Hyperrectangle covering an adversarial region.
+ *
+ * @param[out] h #Hyperrectangle
+ * @param[in] x Adversarial region, which must not be read from file
+ */
+void classifier_hyperrectangle_get_region(
+    Hyperrectangle h,
+    const AdversarialRegion x
+);
+
+
+
+/**
+ * Estimates difficulty of analysing a classifier in a #Hyperrectangle
+ * region.
+ *
+ * @param[in] C #Classifier to analyse
+ * @param[in] x Adversarial region to analyse
+ * @return Estimated difficulty, 0 when it cannot be estimated
+ */
+double classifier_hyperrectangle_estimate_difficulty(
+    const Classifier C,
+    const AdversarialRegion x
+);
+
 #endif
@@ -123,7 +123,7 @@ static unsigned int is_counterexample_leaf(const Node node, Context context) {
 static void compute_reachable_paths(List L, const Node node, Context context) {
     struct counterexample_search_data *data = (struct counterexample_search_data *) context;
     unsigned int i;
-    double k;
+    double k, k_up;
 
     switch (decision_tree_node_get_type(node)) {
     case DECISION_TREE_LEAF:
@@ -134,8 +134,9 @@ static void compute_reachable_paths(List L, const Node node, Context context) {
     case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
         i = decision_tree_univariate_linear_split_get_index(node);
         k = decision_tree_univariate_linear_split_get_threshold(node);
+        k_up = decision_tree_univariate_linear_split_get_upper_threshold(node);
 
-        if (data->x->intervals[i].l <= k) {
+        if (data->x->intervals[i].l <= k_up) {
             list_append(L, decision_tree_univariate_linear_split_get_left_child(node));
         }
         if (data->x->intervals[i].u > k) {
@@ -161,13 +162,14 @@ static void leaf_to_hyperrectangle(Hyperrectangle x, const DecisionTreeNode leaf
         previous = current;
         current = decision_tree_node_get_parent(current);
         const unsigned int i = decision_tree_univariate_linear_split_get_index(current);
-        const double k = decision_tree_univariate_linear_split_get_threshold(current);
+        const double k = decision_tree_univariate_linear_split_get_threshold(current),
+                     k_up = decision_tree_univariate_linear_split_get_upper_threshold(current);
 
         if (decision_tree_univariate_linear_split_get_left_child(current) == previous) {
-            x->intervals[i].u = min(x->intervals[i].u, k);
+            x->intervals[i].u = min(x->intervals[i].u, k_up);
         }
         else if (decision_tree_univariate_linear_split_get_right_child(current) == previous) {
-            x->intervals[i].l = max(x->intervals[i].u, k);
+            x->intervals[i].l = max(x->intervals[i].l, k);
         }
     }
 }
@@ -177,6 +179,12 @@ static void leaf_to_hyperrectangle(Hyperrectangle x, const DecisionTreeNode leaf
 /**
  * Search a counterexample to prove unstability.
  *
+ * The midpoint of the region of a leaf with different labels is checked
+ * concretely: when thresholds are stored in single precision, leaves are
+ * also reached by regions lying between the two rounded thresholds of a
+ * split, which no stored value reaches, and the analysis is then
+ * inconclusive.
+ *
  * @param[in,out] status Pointer to stability analysis status
  * @param[in] T #DecisionTree to analyse
  * @param[in] x #Hyperrectangle region to analyse
@@ -208,8 +216,14 @@ static void search_counterexample(
         hyperrectangle_copy(y, x);
         leaf_to_hyperrectangle(y, leaf);
 
-        status->result = STABILITY_FALSE;
         hyperrectangle_midpoint(status->sample_b, y);
+        decision_tree_classify(data.abstract_labels, T, status->sample_b);
+        status->result = set_is_equal(data.abstract_labels, status->labels_a)
+                       ? STABILITY_DONT_KNOW
+                       : STABILITY_FALSE;
+        if (status->result == STABILITY_FALSE) {
+            hyperrectangle_copy(status->region, y);
+        }
 
         hyperrectangle_delete(&y);
     }
@@ -240,15 +254,10 @@ void decision_tree_hyperrectangle_is_stable(
         set_create(&status->labels_a, set_equality_string);
         decision_tree_classify(status->labels_a, T, status->sample_a);
     }
-    status->result = STABILITY_DONT_KNOW;
-
-
     /* If no counterexamples are found, classifier is robust due to
        completeness */
+    status->result = STABILITY_TRUE;
     search_counterexample(status, T, x);
-    if (status->result == STABILITY_DONT_KNOW) {
-        status->result = STABILITY_TRUE;
-    }
 
 
     /* Deallocates memory */
@@ -7,23 +7,22 @@
 #include "forest_hyperrectangle.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
+#include <math.h>
 #include <time.h>
 
 #include "../list.h"
 #include "../stack.h"
 #include "../priority_queue.h"
 #include "../search_algorithms/best_first.h"
+#include "../stopwatch.h"
 
 
 /** Machine precision. */
 #define EPSILON 1e-12
 
 
-/** Container size. */
-#define CONTAINER_SIZE (1024 * 1024)
-
-
 /***********************************************************************
  * Data structures shared among the analysis.
  **********************************************************************/
@@ -32,28 +31,63 @@
 enum internal_status {
     DONT_KNOW,  /**< Analysis has not discovered any information. */
     UNSTABLE,   /**< Unstability was proved. */
-    ABORTED     /**< Analysis was aborted (for example due to timeout). */
+    ABORTED,    /**< Analysis was aborted (for example due to timeout). */
+    EXHAUSTED   /**< Refinement budget was exhausted. */
 };
 
 /** Type of internal status. */
 typedef enum internal_status InternalStatus;
 
 
+/** Type of a hyperrectangle decorator. */
+typedef struct hyperrectangle_decorator *HyperrectangleDecorator;
+
+
 /** Common data used during analysis. */
 struct analysis_data {
     StabilityStatus *status;         /**< Pointer to stability status. */
     Forest F;                        /**< #Forest. */
     time_t start_time;               /**< Start time of analysis. */
     unsigned int timeout;            /**< Maximum execution time per sample. */
+    unsigned int budget;             /**< Maximum number of refinements,
+                                          0 for no limit. */
+    unsigned int n_refinements;      /**< Number of refinements so far. */
     InternalStatus internal_status;  /**< Current status. */
+    unsigned int has_spurious_counterexample;
+                                     /**< Tells whether a region was found
+                                          whose labels differ from those of
+                                          the sample, while its midpoint
+                                          does not. */
+    RoundingMode rounding_mode;      /**< Rounding mode outside the search. */
     char * const *labels;            /**< Set of labels, as array. */
     unsigned int n_labels;           /**< Number of labels. */
     unsigned int n_trees;            /**< Number of trees. */
     DecisionTreeNode *S;             /**< Stack of nodes. */
     DecisionTreeNode *L;             /**< List of nodes. */
+    ForestReachableLeaves native_reachable_leaves;
+                                     /**< Native computation of reachable
+                                          leaves, NULL to interpret trees. */
+    unsigned int *leaf_indices;      /**< Indices of reachable leaves. */
     unsigned int *local_scores;      /**< Array of integer scores. */
     Set local_labels;                /**< Set of labels for local use. */
     Tier tier;                       /**< Feature tiers. */
+    void (*score)(Hyperrectangle, const HyperrectangleDecorator, struct analysis_data * const);
+                                     /**< Kernel overapproximating scores. */
+    void (*margin)(Interval *, const HyperrectangleDecorator, struct analysis_data * const);
+                                     /**< Kernel overapproximating margin
+                                          (binary fast path only). */
+    unsigned int is_binary;          /**< Tells whether binary fast path is
+                                          used. */
+    unsigned int mask_a;             /**< Labels of the sample, as bit set
+                                          (binary fast path only). */
+    PriorityQueue frontier;          /**< Frontier of the search. */
+    size_t memory;                   /**< Memory held by decorators
+                                          (bytes). */
+    size_t peak_memory;              /**< Peak memory held by decorators
+                                          and frontier (bytes). */
+    size_t memory_limit;             /**< Maximum memory held by decorators
+                                          and frontier (bytes), 0 for no
+                                          limit. */
 };
 
 
@@ -96,7 +130,7 @@ static void reachable_leaves(
     ++size;
     while (size) {
         unsigned int i;
-        double k;
+        double k, k_up;
         n = S[size - 1];
         const struct node data = *((struct node *) n->data);
         --size;
@@ -113,8 +147,9 @@ static void reachable_leaves(
         case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
             i = data.data.univariate_linear_split.i;
             k = data.data.univariate_linear_split.k;
+            k_up = data.data.univariate_linear_split.k_up;
 
-            if (intervals[i].l <= k) {
+            if (intervals[i].l <= k_up) {
                 S[size] = n->left_child;
                 ++size;
             }
@@ -131,6 +166,43 @@ static void reachable_leaves(
 
 
 
+/**
+ * Computes set of reachable leaves in a tree of the forest.
+ *
+ * Uses native code generated for the forest, if available, otherwise
+ * interprets the tree.
+ *
+ * @param[out] L List of reachable leaves, as array
+ * @param[out] n_leaves Number of reachable leaves
+ * @param[in] t Index of tree to explore
+ * @param[in] x #Hyperrectangle region to analyse
+ * @param[in] data Analysis data
+ */
+static inline void tree_reachable_leaves(
+    DecisionTreeNode * const L,
+    unsigned int * const n_leaves,
+    const unsigned int t,
+    const Hyperrectangle x,
+    const struct analysis_data * const data
+) {
+    const DecisionTree T = forest_get_trees_as_array(data->F)[t];
+    const DecisionTreeNode *leaves;
+    unsigned int j;
+
+    if (data->native_reachable_leaves == NULL) {
+        reachable_leaves(L, n_leaves, data->S, T, x);
+        return;
+    }
+
+    leaves = decision_tree_get_leaves_as_array(T);
+    *n_leaves = data->native_reachable_leaves(data->leaf_indices, t, (const double *) x->intervals);
+    for (j = 0; j < *n_leaves; ++j) {
+        L[j] = leaves[data->leaf_indices[j]];
+    }
+}
+
+
+
 /**
  * Converts scores overapproximation to a #Set of labels.
  *
@@ -180,9 +252,6 @@ static void scores_to_labels(
  * Functions and data structures related to hyperrectangle decorators.
  **********************************************************************/
 
-/** Type of a hyperrectangle decorator. */
-typedef struct hyperrectangle_decorator *HyperrectangleDecorator;
-
 /** Structure of a hyperrectangle decorator. */
 struct hyperrectangle_decorator {
     Hyperrectangle x;                /**< Constraints, as #Hyperrectangle. */
@@ -190,7 +259,10 @@ struct hyperrectangle_decorator {
     HyperrectangleDecorator parent;  /**< Parent decorator. */
     List children;                   /**< #List of children decorators. */
     Set labels;                      /**< Overapproximation of #Set of labels
-                                          of points in #Hyperrectangle. */
+                                          of points in #Hyperrectangle, NULL
+                                          on binary fast path. */
+    unsigned int mask;               /**< Overapproximation of labels as bit
+                                          set, on binary fast path. */
 };
 
 
@@ -202,6 +274,7 @@ struct hyperrectangle_decorator {
  * @param[in] h #Hyperrectangle
  * @param[in] leaf Leaf of a decision tree
  * @param[in] parent Parent decorator
+ * @param[in] is_binary Tells whether labels are stored as bit set
  * @warning #decorator_delete should be called to ensure proper memory
  *          deallocation.
  */
@@ -209,14 +282,19 @@ static void decorator_create(
     HyperrectangleDecorator *x,
     const Hyperrectangle h,
     const DecisionTreeNode leaf,
-    const HyperrectangleDecorator parent
+    const HyperrectangleDecorator parent,
+    const unsigned int is_binary
 ) {
     HyperrectangleDecorator d = (HyperrectangleDecorator) malloc(sizeof(struct hyperrectangle_decorator));
     d->x = h;
     d->leaf = leaf;
     d->parent = parent;
     list_create(&d->children);
-    set_create(&d->labels, set_equality_string);
+    d->labels = NULL;
+    d->mask = 0;
+    if (!is_binary) {
+        set_create(&d->labels, set_equality_string);
+    }
 
     *x = d;
 }
@@ -242,7 +320,9 @@ static void decorator_delete(HyperrectangleDecorator *x) {
             stack_push(S, list_pop(x->children));
         }
         list_delete(&x->children);
-        set_delete(&x->labels);
+        if (x->labels) {
+            set_delete(&x->labels);
+        }
         free(x);
     }
     stack_delete(&S);
@@ -251,6 +331,21 @@ static void decorator_delete(HyperrectangleDecorator *x) {
 
 
 
+/**
+ * Returns memory held by a hyperrectangle decorator, children excluded.
+ *
+ * @param[in] x Decorator
+ * @return Size of decorator (bytes)
+ */
+static size_t decorator_get_memory_size(const HyperrectangleDecorator x) {
+    return sizeof(struct hyperrectangle_decorator)
+         + (x->x != NULL ? hyperrectangle_get_memory_size(x->x) : 0)
+         + list_get_memory_size(x->children)
+         + set_get_memory_size(x->labels);
+}
+
+
+
 /**
  * Returns depth of a hyperrectangle decorator.
  *
@@ -272,393 +367,606 @@ static unsigned int decorator_get_depth(const HyperrectangleDecorator x) {
 
 
 /**
- * Computes score of a decorator using the max voting sscheme.
- * 
- * Only leaves which are guaranteed to be reached are considered.
+ * Tells whether a leaf votes for a label using the max voting scheme.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] data Analysis data
+ * As in the concrete decision function, scores are read according to the
+ * type of the leaf, and a vote goes to every label having maximum score.
+ *
+ * @param[in] node Leaf
+ * @param[in] i Index of label
+ * @return 1 if leaf votes for label, 0 otherwise
  */
-static void decorator_score_concrete_max(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const AnalysisData data
-) {
-    const unsigned int n_labels = data->n_labels;
-    unsigned int i;
-    HyperrectangleDecorator current = x;
-    (void) data;
+static inline unsigned int leaf_vote(const struct node *node, const unsigned int i) {
+    unsigned int j;
 
-    /* Initializes scores */
-    for (i = 0; i < n_labels; ++i) {
-        scores->intervals[i].l = 0.0;
-        scores->intervals[i].u = 0.0;
-    }
-
-    /* Updates scores with information from each leaf */
-    while (current->leaf) {
-        const unsigned int *leaf_scores = ((struct node *) current->leaf->data)->data.leaf.scores;
-        unsigned int max = ((struct node *) current->leaf->data)->data.leaf.max_score;
-        for (i = 0; i < n_labels; ++i) {
-            if (leaf_scores[i] == max) {
-                scores->intervals[i].l += 1.0;
-                scores->intervals[i].u += 1.0;
-            }
-        }
+    if (node->type == DECISION_TREE_LEAF) {
+        return node->data.leaf.scores[i] == node->data.leaf.max_score;
+    }
 
-        current = current->parent;
+    for (j = 0; j < node->data.leaf_logarithmic.n_labels; ++j) {
+        if (node->data.leaf_logarithmic.scores[j] > node->data.leaf_logarithmic.scores[i]) {
+            return 0;
+        }
     }
+
+    return 1;
 }
 
 
 
 /**
- * Computes score of a decorator using the average voting scheme.
- * 
- * Only leaves which are guaranteed to be reached are considered.
+ * Computes bounds of the score given by a leaf to a label.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] data Analysis data
+ * As in the concrete decision function, scores are read according to the
+ * type of the leaf: leaves counting samples give the fraction of samples
+ * having the label, leaves with logarithmic probabilities give their
+ * score.
+ *
+ * @param[out] l Lower bound of the score
+ * @param[out] u Upper bound of the score
+ * @param[in] node Leaf
+ * @param[in] i Index of label
  */
-static void decorator_score_concrete_average(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const AnalysisData data
+static inline void leaf_score(
+    double *l,
+    double *u,
+    const struct node *node,
+    const unsigned int i
 ) {
-    const unsigned int n_labels = forest_get_n_labels(data->F);
-    unsigned int i;
-    HyperrectangleDecorator current = x;
-
-    /* Initializes scores */
-    for (i = 0; i < n_labels; ++i) {
-        scores->intervals[i].l = 0.0;
-        scores->intervals[i].u = 0.0;
+    if (node->type == DECISION_TREE_LEAF) {
+        *l = div_down((double) node->data.leaf.scores[i], (double) node->data.leaf.n_samples);
+        *u = div_up((double) node->data.leaf.scores[i], (double) node->data.leaf.n_samples);
+    }
+    else {
+        *l = node->data.leaf_logarithmic.scores[i];
+        *u = node->data.leaf_logarithmic.scores[i];
     }
+}
 
-    /* Updates scores with information from each leaf */
-    while (current->leaf) {
-        const unsigned int *leaf_scores = ((struct node *) current->leaf->data)->data.leaf.scores;
-        const unsigned int n_samples = ((struct node *) current->leaf->data)->data.leaf.n_samples;
 
-        for (i = 0; i < n_labels; ++i) {
-            scores->intervals[i].l += (double) leaf_scores[i] / (double) n_samples / (double) data->n_trees;
-            scores->intervals[i].u += (double) leaf_scores[i] / (double) n_samples / (double) data->n_trees;
-        }
 
-        current = current->parent;
+/**
+ * Computes bounds of the difference between scores given by a leaf to
+ * first and second label.
+ *
+ * @param[out] l Lower bound of the difference
+ * @param[out] u Upper bound of the difference
+ * @param[in] node Leaf
+ * @see #leaf_score
+ */
+static inline void leaf_score_difference(
+    double *l,
+    double *u,
+    const struct node *node
+) {
+    if (node->type == DECISION_TREE_LEAF) {
+        const double d = (double) node->data.leaf.scores[0] - (double) node->data.leaf.scores[1];
+        *l = div_down(d, (double) node->data.leaf.n_samples);
+        *u = div_up(d, (double) node->data.leaf.n_samples);
+    }
+    else {
+        *l = sub_down(node->data.leaf_logarithmic.scores[0], node->data.leaf_logarithmic.scores[1]);
+        *u = sub_up(node->data.leaf_logarithmic.scores[0], node->data.leaf_logarithmic.scores[1]);
     }
 }
 
 
 
 /**
- * Computes score of a decorator using the softargmax voting scheme.
+ * Defines a kernel computing scores of a decorator using the max voting
+ * scheme.
  *
- * Only leaves which are guaranteed to be reached are considered.
+ * Leaves which are guaranteed to be reached contribute with their
+ * concrete vote, while each unexplored tree is overapproximated by
+ * abstract interpretation on its set of reachable leaves. The number of
+ * labels is given as an expression, so that kernels for fixed label
+ * counts can be fully unrolled by the compiler.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] data Analysis data
+ * @param[in] NAME Name of the kernel
+ * @param[in] N_LABELS Number of labels
  */
-static void decorator_score_concrete_softargmax(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const AnalysisData data
-) {
-    const unsigned int n_labels = forest_get_n_labels(data->F);
-    unsigned int i;
-    HyperrectangleDecorator current = x;
+#define DEFINE_SCORE_KERNEL_MAX(NAME, N_LABELS)                              \
+static void NAME(                                                            \
+    Hyperrectangle scores,                                                   \
+    const HyperrectangleDecorator x,                                         \
+    const AnalysisData data                                                  \
+) {                                                                          \
+    const unsigned int n_labels = (N_LABELS);                                \
+    Interval * const intervals = scores->intervals;                          \
+    unsigned int * const local_scores = data->local_scores;                  \
+    DecisionTreeNode * const L = data->L;                                    \
+    HyperrectangleDecorator current = x;                                     \
+    unsigned int i, j, t, n_leaves, depth = 0;                               \
+                                                                             \
+    /* Concrete votes of reached leaves */                                   \
+    for (i = 0; i < n_labels; ++i) {                                         \
+        intervals[i].l = 0.0;                                                \
+        intervals[i].u = 0.0;                                                \
+    }                                                                        \
+    while (current->leaf) {                                                  \
+        const struct node *leaf = (struct node *) current->leaf->data;       \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            const double vote = leaf_vote(leaf, i);                          \
+            intervals[i].l += vote;                                          \
+            intervals[i].u += vote;                                          \
+        }                                                                    \
+        current = current->parent;                                           \
+        ++depth;                                                             \
+    }                                                                        \
+                                                                             \
+    /* Overapproximation of unexplored trees */                              \
+    for (t = depth; t < data->n_trees; ++t) {                                \
+        tree_reachable_leaves(L, &n_leaves, t, x->x, data);                  \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            local_scores[i] = 0;                                             \
+        }                                                                    \
+        for (j = 0; j < n_leaves; ++j) {                                     \
+            const struct node *leaf = (struct node *) L[j]->data;            \
+            for (i = 0; i < n_labels; ++i) {                                 \
+                local_scores[i] += leaf_vote(leaf, i);                       \
+            }                                                                \
+        }                                                                    \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            intervals[i].l += local_scores[i] == n_leaves;                   \
+            intervals[i].u += local_scores[i] > 0;                           \
+        }                                                                    \
+    }                                                                        \
+}
 
-    /* Initializes scores */
-    for (i = 0; i < n_labels; ++i) {
-        scores->intervals[i].l = 0.0;
-        scores->intervals[i].u = 0.0;
-    }
 
-    /* Updates scores with information from each leaf */
-    while (current->leaf) {
-        const double *leaf_scores = ((struct node *) current->leaf->data)->data.leaf_logarithmic.scores;
 
-        for (i = 0; i < n_labels; ++i) {
-            scores->intervals[i].l += leaf_scores[i];
-            scores->intervals[i].u += leaf_scores[i];
-        }
+/**
+ * Defines a kernel computing scores of a decorator using the average
+ * voting scheme.
+ *
+ * @param[in] NAME Name of the kernel
+ * @param[in] N_LABELS Number of labels
+ * @see #DEFINE_SCORE_KERNEL_MAX
+ */
+#define DEFINE_SCORE_KERNEL_AVERAGE(NAME, N_LABELS)                          \
+static void NAME(                                                            \
+    Hyperrectangle scores,                                                   \
+    const HyperrectangleDecorator x,                                         \
+    const AnalysisData data                                                  \
+) {                                                                          \
+    const unsigned int n_labels = (N_LABELS);                                \
+    const double n_trees = data->n_trees;                                    \
+    Interval * const intervals = scores->intervals;                          \
+    DecisionTreeNode * const L = data->L;                                    \
+    HyperrectangleDecorator current = x;                                     \
+    unsigned int i, j, t, n_leaves, depth = 0;                               \
+    double l, u;                                                             \
+                                                                             \
+    /* Concrete scores of reached leaves */                                  \
+    for (i = 0; i < n_labels; ++i) {                                         \
+        intervals[i].l = 0.0;                                                \
+        intervals[i].u = 0.0;                                                \
+    }                                                                        \
+    while (current->leaf) {                                                  \
+        const struct node *leaf = (struct node *) current->leaf->data;       \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            leaf_score(&l, &u, leaf, i);                                     \
+            intervals[i].l = to_real_down(add_down(intervals[i].l, div_down(l, n_trees))); \
+            intervals[i].u = add_up(intervals[i].u, div_up(u, n_trees));     \
+        }                                                                    \
+        current = current->parent;                                           \
+        ++depth;                                                             \
+    }                                                                        \
+                                                                             \
+    /* Overapproximation of unexplored trees */                              \
+    for (t = depth; t < data->n_trees; ++t) {                                \
+        tree_reachable_leaves(L, &n_leaves, t, x->x, data);                  \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            double min = +DBL_MAX, max = -DBL_MAX;                           \
+            for (j = 0; j < n_leaves; ++j) {                                 \
+                leaf_score(&l, &u, (struct node *) L[j]->data, i);           \
+                min = l < min ? l : min;                                     \
+                max = u > max ? u : max;                                     \
+            }                                                                \
+            intervals[i].l = to_real_down(add_down(intervals[i].l, div_down(min, n_trees))); \
+            intervals[i].u = add_up(intervals[i].u, div_up(max, n_trees));   \
+        }                                                                    \
+    }                                                                        \
+}
 
-        current = current->parent;
-    }
+
+
+/**
+ * Defines a kernel computing scores of a decorator using the softargmax
+ * voting scheme.
+ *
+ * @param[in] NAME Name of the kernel
+ * @param[in] N_LABELS Number of labels
+ * @see #DEFINE_SCORE_KERNEL_MAX
+ */
+#define DEFINE_SCORE_KERNEL_SOFTARGMAX(NAME, N_LABELS)                       \
+static void NAME(                                                            \
+    Hyperrectangle scores,                                                   \
+    const HyperrectangleDecorator x,                                         \
+    const AnalysisData data                                                  \
+) {                                                                          \
+    const unsigned int n_labels = (N_LABELS);                                \
+    Interval * const intervals = scores->intervals;                          \
+    DecisionTreeNode * const L = data->L;                                    \
+    HyperrectangleDecorator current = x;                                     \
+    unsigned int i, j, t, n_leaves, depth = 0;                               \
+    double l, u, s_min = 0.0, s_max = 0.0;                                   \
+                                                                             \
+    /* Concrete scores of reached leaves */                                  \
+    for (i = 0; i < n_labels; ++i) {                                         \
+        intervals[i].l = 0.0;                                                \
+        intervals[i].u = 0.0;                                                \
+    }                                                                        \
+    while (current->leaf) {                                                  \
+        const struct node *leaf = (struct node *) current->leaf->data;       \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            leaf_score(&l, &u, leaf, i);                                     \
+            intervals[i].l = to_real_down(add_down(intervals[i].l, l));      \
+            intervals[i].u = add_up(intervals[i].u, u);                      \
+        }                                                                    \
+        current = current->parent;                                           \
+        ++depth;                                                             \
+    }                                                                        \
+                                                                             \
+    /* Overapproximation of unexplored trees */                              \
+    for (t = depth; t < data->n_trees; ++t) {                                \
+        tree_reachable_leaves(L, &n_leaves, t, x->x, data);                  \
+        for (i = 0; i < n_labels; ++i) {                                     \
+            double min = +DBL_MAX, max = -DBL_MAX;                           \
+            for (j = 0; j < n_leaves; ++j) {                                 \
+                leaf_score(&l, &u, (struct node *) L[j]->data, i);           \
+                min = l < min ? l : min;                                     \
+                max = u > max ? u : max;                                     \
+            }                                                                \
+            intervals[i].l = to_real_down(add_down(intervals[i].l, min));    \
+            intervals[i].u = add_up(intervals[i].u, max);                    \
+        }                                                                    \
+    }                                                                        \
+                                                                             \
+    /* Normalization */                                                      \
+    for (i = 0; i < n_labels; ++i) {                                         \
+        s_min = add_down(s_min, exp_down(intervals[i].l));                   \
+        s_max = add_up(s_max, exp_up(intervals[i].u));                       \
+    }                                                                        \
+    for (i = 0; i < n_labels; ++i) {                                         \
+        intervals[i].l = to_real_down(div_down(exp_down(intervals[i].l), s_max)); \
+        intervals[i].u = div_up(exp_up(intervals[i].u), s_min);              \
+    }                                                                        \
 }
 
 
 
+/* Kernels specialised for common label counts, plus generic ones. */
+DEFINE_SCORE_KERNEL_MAX(decorator_score_max_3, 3)
+DEFINE_SCORE_KERNEL_MAX(decorator_score_max_4, 4)
+DEFINE_SCORE_KERNEL_MAX(decorator_score_max_8, 8)
+DEFINE_SCORE_KERNEL_MAX(decorator_score_max_10, 10)
+DEFINE_SCORE_KERNEL_MAX(decorator_score_max_n, data->n_labels)
+
+DEFINE_SCORE_KERNEL_AVERAGE(decorator_score_average_3, 3)
+DEFINE_SCORE_KERNEL_AVERAGE(decorator_score_average_4, 4)
+DEFINE_SCORE_KERNEL_AVERAGE(decorator_score_average_8, 8)
+DEFINE_SCORE_KERNEL_AVERAGE(decorator_score_average_10, 10)
+DEFINE_SCORE_KERNEL_AVERAGE(decorator_score_average_n, data->n_labels)
+
+DEFINE_SCORE_KERNEL_SOFTARGMAX(decorator_score_softargmax_3, 3)
+DEFINE_SCORE_KERNEL_SOFTARGMAX(decorator_score_softargmax_4, 4)
+DEFINE_SCORE_KERNEL_SOFTARGMAX(decorator_score_softargmax_8, 8)
+DEFINE_SCORE_KERNEL_SOFTARGMAX(decorator_score_softargmax_10, 10)
+DEFINE_SCORE_KERNEL_SOFTARGMAX(decorator_score_softargmax_n, data->n_labels)
+
+
+
 /**
- * Computes score of a decorator.
- * 
- * Only leaves which are guaranteed to be reached are considered. Voting
- * scheme depends on the forest. 
+ * Computes score given by a leaf to a label using the max voting scheme.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
+ * @param[out] l Lower bound of the score
+ * @param[out] u Upper bound of the score
+ * @param[in] node Leaf
+ * @param[in] i Index of label
  * @param[in] data Analysis data
  */
-static void decorator_score_concrete(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
+static inline void leaf_score_max(
+    double *l,
+    double *u,
+    const struct node *node,
+    const unsigned int i,
     const AnalysisData data
 ) {
-    switch (forest_get_voting_scheme(data->F)) {
-    case FOREST_VOTING_MAX:
-        decorator_score_concrete_max(scores, x, data);
-        break;
-
-    case FOREST_VOTING_AVERAGE:
-        decorator_score_concrete_average(scores, x, data);
-        break;
-
-    case FOREST_VOTING_SOFTARGMAX:
-        decorator_score_concrete_softargmax(scores, x, data);
-        break;
-    }
+    (void) data;
+    *l = (double) leaf_vote(node, i);
+    *u = *l;
 }
 
 
 
 /**
- * Updates score of a decorator using the max voting scheme.
+ * Computes score given by a leaf to a label using the average voting
+ * scheme.
  *
- * Computes set of reachable leaves in a single tree and uses abstract
- * interpretation to overapproximate scores.
- *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] T #DecisionTree to analyse
+ * @param[out] l Lower bound of the score
+ * @param[out] u Upper bound of the score
+ * @param[in] node Leaf
+ * @param[in] i Index of label
  * @param[in] data Analysis data
  */
-static void decorator_score_sound_max(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const DecisionTree T,
+static inline void leaf_score_average(
+    double *l,
+    double *u,
+    const struct node *node,
+    const unsigned int i,
     const AnalysisData data
 ) {
-    const unsigned int n_labels = data->n_labels;
-    DecisionTreeNode *L = data->L;
-    unsigned int i, j, n_leaves;
-    unsigned int * const local_scores = data->local_scores;
+    leaf_score(l, u, node, i);
+    *l = div_down(*l, (double) data->n_trees);
+    *u = div_up(*u, (double) data->n_trees);
+}
 
-    reachable_leaves(L, &n_leaves, data->S, T, x->x);
-    for (i = 0; i < n_labels; ++i) {
-        local_scores[i] = 0;
-    }
 
-    for (j = 0; j < n_leaves; ++j) {
-        const unsigned int *scores = ((struct node *) L[j]->data)->data.leaf.scores;
-        const unsigned int max = ((struct node *) L[j]->data)->data.leaf.max_score;
-        for (i = 0; i < n_labels; ++i) {
-            if (scores[i] == max) {
-                ++local_scores[i];
-            }
-        }
-    }
 
-    for (i = 0; i < n_labels; ++i) {
-        scores->intervals[i].l += local_scores[i] == n_leaves;
-        scores->intervals[i].u += local_scores[i] > 0;
-    }
+/**
+ * Computes score given by a leaf to a label using the softargmax voting
+ * scheme, before normalization.
+ *
+ * @param[out] l Lower bound of the score
+ * @param[out] u Upper bound of the score
+ * @param[in] node Leaf
+ * @param[in] i Index of label
+ * @param[in] data Analysis data
+ */
+static inline void leaf_score_softargmax(
+    double *l,
+    double *u,
+    const struct node *node,
+    const unsigned int i,
+    const AnalysisData data
+) {
+    (void) data;
+    leaf_score(l, u, node, i);
 }
 
 
 
 /**
- * Updates score of a decorator using the average voting scheme.
- *
- * Computes set of reachable leaves in a single tree and uses abstract
- * interpretation to overapproximate scores.
+ * Computes margin contributed by a leaf using the max voting scheme.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] T #DecisionTree to analyse
+ * @param[out] l Lower bound of the margin
+ * @param[out] u Upper bound of the margin
+ * @param[in] node Leaf
  * @param[in] data Analysis data
  */
-static void decorator_score_sound_average(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const DecisionTree T,
+static inline void leaf_margin_max(
+    double *l,
+    double *u,
+    const struct node *node,
     const AnalysisData data
 ) {
-    const unsigned int n_labels = data->n_labels,
-                       n_trees = data->n_trees;
-    unsigned int i, j, n_leaves;
-    DecisionTreeNode *L = data->L;
-    Interval * const intervals = scores->intervals;
-
-    reachable_leaves(L, &n_leaves, data->S, T, x->x);
-    for (i = 0; i < n_labels; ++i) {
-        double min = 1.0, max = 0.0;
+    (void) data;
+    *l = (double) leaf_vote(node, 0) - (double) leaf_vote(node, 1);
+    *u = *l;
+}
 
-        for (j = 0; j < n_leaves; ++j) {
-            const unsigned int *scores = ((struct node *) L[j]->data)->data.leaf.scores,
-                               n_samples = ((struct node *) L[j]->data)->data.leaf.n_samples;
-            const double p = (double) scores[i] / (double) n_samples;
 
-            if (p < min) {
-                min = p;
-            }
-            if (p > max) {
-                max = p;
-            }
-        }
 
-        intervals[i].l += min / (double) n_trees;
-        intervals[i].u += max / (double) n_trees;
-    }
+/**
+ * Computes margin contributed by a leaf using the average voting scheme.
+ *
+ * @param[out] l Lower bound of the margin
+ * @param[out] u Upper bound of the margin
+ * @param[in] node Leaf
+ * @param[in] data Analysis data
+ */
+static inline void leaf_margin_average(
+    double *l,
+    double *u,
+    const struct node *node,
+    const AnalysisData data
+) {
+    leaf_score_difference(l, u, node);
+    *l = div_down(*l, (double) data->n_trees);
+    *u = div_up(*u, (double) data->n_trees);
 }
 
 
 
 /**
- * Updates score of a decorator using the softargmax voting scheme.
+ * Computes margin contributed by a leaf using the softargmax voting scheme.
  *
- * Computes set of reachable leaves in a single tree and uses abstract
- * interpretation to overapproximate scores.
+ * Since softargmax is monotone, margin is computed on summed scores.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] T #DecisionTree to analyse
+ * @param[out] l Lower bound of the margin
+ * @param[out] u Upper bound of the margin
+ * @param[in] node Leaf
  * @param[in] data Analysis data
  */
-static void decorator_score_sound_softargmax(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const DecisionTree T,
+static inline void leaf_margin_softargmax(
+    double *l,
+    double *u,
+    const struct node *node,
     const AnalysisData data
 ) {
-    const unsigned int n_labels = data->n_labels;
-    unsigned int i, j, n_leaves;
-    DecisionTreeNode *L = data->L;
-    Interval * const intervals = scores->intervals;
-
-    reachable_leaves(L, &n_leaves, data->S, T, x->x);
-    for (i = 0; i < n_labels; ++i) {
-        double min = +DBL_MAX, max = -DBL_MAX;
+    (void) data;
+    leaf_score_difference(l, u, node);
+}
 
-        for (j = 0; j < n_leaves; ++j) {
-            const double *scores = ((struct node *) L[j]->data)->data.leaf_logarithmic.scores,
-                         p = scores[i];
 
-            if (p < min) {
-                min = p;
-            }
-            if (p > max) {
-                max = p;
-            }
-        }
 
-        intervals[i].l += min;
-        intervals[i].u += max;
-    }
+/**
+ * Defines a kernel computing an overapproximation of the margin of a
+ * decorator.
+ *
+ * Margin is the difference between scores of first and second label of
+ * a binary forest, so a positive margin means that only the first label
+ * can be returned, and a negative margin that only the second one can.
+ * Scores of reached leaves are summed label by label, as the n-label
+ * kernels do, so that a fully refined decorator gets the same labels on
+ * both paths; each unexplored tree contributes with the range of margins
+ * of its reachable leaves.
+ *
+ * @param[in] NAME Name of the kernel
+ * @param[in] LEAF_SCORE Function computing score of a leaf
+ * @param[in] LEAF_MARGIN Function computing margin of a leaf
+ */
+#define DEFINE_MARGIN_KERNEL(NAME, LEAF_SCORE, LEAF_MARGIN)                  \
+static void NAME(                                                            \
+    Interval *margin,                                                        \
+    const HyperrectangleDecorator x,                                         \
+    const AnalysisData data                                                  \
+) {                                                                          \
+    DecisionTreeNode * const L = data->L;                                    \
+    HyperrectangleDecorator current = x;                                     \
+    unsigned int j, t, n_leaves, depth = 0;                                  \
+    double l, u;                                                             \
+    Interval a = {0.0, 0.0}, b = {0.0, 0.0};                                 \
+                                                                             \
+    /* Concrete scores of reached leaves */                                  \
+    while (current->leaf) {                                                  \
+        const struct node *leaf = (struct node *) current->leaf->data;       \
+        LEAF_SCORE(&l, &u, leaf, 0, data);                                   \
+        a.l = to_real_down(add_down(a.l, l));                                \
+        a.u = add_up(a.u, u);                                                \
+        LEAF_SCORE(&l, &u, leaf, 1, data);                                   \
+        b.l = to_real_down(add_down(b.l, l));                                \
+        b.u = add_up(b.u, u);                                                \
+        current = current->parent;                                           \
+        ++depth;                                                             \
+    }                                                                        \
+    margin->l = sub_down(a.l, b.u);                                          \
+    margin->u = sub_up(a.u, b.l);                                            \
+                                                                             \
+    /* Overapproximation of unexplored trees */                              \
+    for (t = depth; t < data->n_trees; ++t) {                                \
+        double min = +DBL_MAX, max = -DBL_MAX;                               \
+        tree_reachable_leaves(L, &n_leaves, t, x->x, data);                  \
+        for (j = 0; j < n_leaves; ++j) {                                     \
+            LEAF_MARGIN(&l, &u, (struct node *) L[j]->data, data);           \
+            min = l < min ? l : min;                                         \
+            max = u > max ? u : max;                                         \
+        }                                                                    \
+        margin->l = to_real_down(add_down(margin->l, min));                  \
+        margin->u = add_up(margin->u, max);                                  \
+    }                                                                        \
 }
 
 
 
+DEFINE_MARGIN_KERNEL(decorator_margin_max, leaf_score_max, leaf_margin_max)
+DEFINE_MARGIN_KERNEL(decorator_margin_average, leaf_score_average, leaf_margin_average)
+DEFINE_MARGIN_KERNEL(decorator_margin_softargmax, leaf_score_softargmax, leaf_margin_softargmax)
+
+
+
 /**
- * Updates score of a decorator.
+ * Selects scoring kernels for an analysis.
  *
- * Uses abstract interpretation to overapproximate intervals for scores
- * for given decorator. Voting scheme depends on the forest.
+ * Dispatch on voting scheme and number of labels happens once per
+ * analysis, rather than once per decorator.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
- * @param[in] data Analysis data
+ * @param[in,out] data Analysis data
  */
-static void decorator_score_sound(
-    Hyperrectangle scores,
-    const HyperrectangleDecorator x,
-    const AnalysisData data
-) {
-    const unsigned int depth = decorator_get_depth(x),
-                       n_trees = data->n_trees;
-    const DecisionTree * const trees = forest_get_trees_as_array(data->F);
-    void (*overapproximate)(Hyperrectangle, const HyperrectangleDecorator, const DecisionTree, const AnalysisData) = NULL;
-    unsigned int i;
-
+static void select_kernels(struct analysis_data *data) {
     switch (forest_get_voting_scheme(data->F)) {
     case FOREST_VOTING_MAX:
-        overapproximate = decorator_score_sound_max;
+        data->margin = decorator_margin_max;
+        switch (data->n_labels) {
+        case 3:  data->score = decorator_score_max_3;  break;
+        case 4:  data->score = decorator_score_max_4;  break;
+        case 8:  data->score = decorator_score_max_8;  break;
+        case 10: data->score = decorator_score_max_10; break;
+        default: data->score = decorator_score_max_n;  break;
+        }
         break;
 
     case FOREST_VOTING_AVERAGE:
-        overapproximate = decorator_score_sound_average;
+        data->margin = decorator_margin_average;
+        switch (data->n_labels) {
+        case 3:  data->score = decorator_score_average_3;  break;
+        case 4:  data->score = decorator_score_average_4;  break;
+        case 8:  data->score = decorator_score_average_8;  break;
+        case 10: data->score = decorator_score_average_10; break;
+        default: data->score = decorator_score_average_n;  break;
+        }
         break;
 
     case FOREST_VOTING_SOFTARGMAX:
-        overapproximate = decorator_score_sound_softargmax;
+        data->margin = decorator_margin_softargmax;
+        switch (data->n_labels) {
+        case 3:  data->score = decorator_score_softargmax_3;  break;
+        case 4:  data->score = decorator_score_softargmax_4;  break;
+        case 8:  data->score = decorator_score_softargmax_8;  break;
+        case 10: data->score = decorator_score_softargmax_10; break;
+        default: data->score = decorator_score_softargmax_n;  break;
+        }
         break;
     }
+}
 
-    for (i = depth; i < n_trees; ++i) {
-        overapproximate(scores, x, trees[i], data);
-    }
 
-    if (forest_get_voting_scheme(data->F) == FOREST_VOTING_SOFTARGMAX) {
-        const unsigned int n_labels = forest_get_n_labels(data->F);
-        double s_min = 0.0, s_max = 0.0;
-        for (i = 0; i < n_labels; ++i) {
-            s_min += exp(scores->intervals[i].l);
-            s_max += exp(scores->intervals[i].u);
-        }
-        for (i = 0; i < n_labels; ++i) {
-            scores->intervals[i].l = exp(scores->intervals[i].l) / s_max;
-            scores->intervals[i].u = exp(scores->intervals[i].u) / s_min;
-        }
+
+/**
+ * Computes an overapproximation of set of labels of points in a decorator.
+ *
+ * Firs computes an overapproximation of scores, then determines which
+ * labels have a maximal score. On binary fast path, labels are derived
+ * from the sign of the margin and stored as bit set.
+ *
+ * @param[in,out] x Decorator to analyse
+ * @param[in] data Analysis data
+ */
+static void decorator_compute_labels(
+    const HyperrectangleDecorator x,
+    const AnalysisData data
+) {
+    Hyperrectangle scores;
+
+    if (data->is_binary) {
+        Interval margin;
+        data->margin(&margin, x, data);
+        x->mask = (margin.u >= 0.0) | ((margin.l <= 0.0) << 1);
+        return;
     }
+
+    hyperrectangle_create(&scores, data->n_labels);
+    data->score(scores, x, data);
+    scores_to_labels(x->labels, scores, data);
+    hyperrectangle_delete(&scores);
 }
 
 
 
 /**
- * Computes an overapproximation of scores, as intervals.
- *
- * Uses concrete information from already reached leaves to compute a
- * guaranteed, partial score, then adds an overapproximation by using
- * abstract interpretation. Voting scheme depends on the forest.
+ * Tells whether labels of a decorator are the same of the sample.
  *
- * @param[out] scores #Hyperrectangle of scores
- * @param[in] x Decorator to analyse
+ * @param[in] x Decorator
  * @param[in] data Analysis data
+ * @return 1 if labels are the same, 0 otherwise
  */
-static void decorator_score_overapproximate(
-    Hyperrectangle scores,
+static unsigned int decorator_is_equal_to_sample(
     const HyperrectangleDecorator x,
     const AnalysisData data
 ) {
-    decorator_score_concrete(scores, x, data);
-    decorator_score_sound(scores, x, data);
+    return data->is_binary
+         ? x->mask == data->mask_a
+         : set_is_equal(x->labels, data->status->labels_a);
 }
 
 
 
 /**
- * Computes an overapproximation of set of labels of points in a decorator.
- *
- * Firs computes an overapproximation of scores, then determines which
- * labels have a maximal score.
+ * Tells whether labels of a decorator have nothing in common with the
+ * labels of the sample.
  *
- * @param[out] labels #Set of labels
- * @param[in] x Decorator to analyse
+ * @param[in] x Decorator
  * @param[in] data Analysis data
+ * @return 1 if labels are disjoint, 0 otherwise
  */
-static void decorator_compute_labels(
-    Set labels,
+static unsigned int decorator_is_disjoint_from_sample(
     const HyperrectangleDecorator x,
     const AnalysisData data
 ) {
-    Hyperrectangle scores;
-
-    hyperrectangle_create(&scores, data->n_labels);
-    decorator_score_overapproximate(scores, x, data);
-    scores_to_labels(labels, scores, data);
-    hyperrectangle_delete(&scores);
+    return data->is_binary
+         ? (x->mask & data->mask_a) == 0
+         : set_is_disjoint(x->labels, data->status->labels_a);
 }
 
 
@@ -722,17 +1030,36 @@ static void adjust_tier(Hyperrectangle x, const Tier tier, const unsigned int i,
 
 
 
+/**
+ * Updates peak memory held by decorators and frontier.
+ *
+ * @param[in,out] data Analysis data
+ * @return Memory currently held (bytes)
+ */
+static size_t update_peak_memory(struct analysis_data *data) {
+    const size_t memory = data->memory + priority_queue_get_memory_size(data->frontier);
+
+    if (memory > data->peak_memory) {
+        data->peak_memory = memory;
+    }
+
+    return memory;
+}
+
+
+
 /**
  * Tells whether an analysis is complete.
  *
  * An analysis is complete when a counterexample was discovered, or a
- * timeout was reached.
+ * timeout or the memory limit was reached.
  *
  * @param[in] x Decorator to analyse
  * @param[in] context Analysis data
  * @return 1 if analysis must stop, 0 otherwise
  */
 static unsigned int is_complete(const Node x, Context context) {
+    size_t memory;
     (void) x;
 
     /* Stops if a counterexample is reached. */
@@ -743,6 +1070,27 @@ static unsigned int is_complete(const Node x, Context context) {
     /* Stops if a timeout was reached */
     if (time(NULL) - ((struct analysis_data *) context)->start_time > ((struct analysis_data *) context)->timeout) {
         ((struct analysis_data *) context)->internal_status = ABORTED;
+        if (((struct analysis_data *) context)->status->trace != NULL) {
+            trace_add(((struct analysis_data *) context)->status->trace, TRACE_INSTANT, "timeout", NULL, 0.0, NULL, 0.0);
+        }
+        return 1;
+    }
+
+    /* Stops if memory limit was exceeded */
+    memory = update_peak_memory((struct analysis_data *) context);
+    if (((struct analysis_data *) context)->memory_limit != 0
+        && memory > ((struct analysis_data *) context)->memory_limit) {
+        ((struct analysis_data *) context)->internal_status = ABORTED;
+        if (((struct analysis_data *) context)->status->trace != NULL) {
+            trace_add(((struct analysis_data *) context)->status->trace, TRACE_INSTANT, "memory limit", "memory", memory, NULL, 0.0);
+        }
+        return 1;
+    }
+
+    /* Stops if refinement budget was exhausted */
+    if (((struct analysis_data *) context)->budget != 0
+        && ((struct analysis_data *) context)->n_refinements >= ((struct analysis_data *) context)->budget) {
+        ((struct analysis_data *) context)->internal_status = EXHAUSTED;
         return 1;
     }
 
@@ -751,6 +1099,34 @@ static unsigned int is_complete(const Node x, Context context) {
 
 
 
+/**
+ * Tells whether the midpoint of a region is a concrete counterexample.
+ *
+ * When thresholds are stored in single precision, regions lying between
+ * the two rounded thresholds of a split reach both of its children,
+ * although no stored value does: leaves of distinct trees may thus be
+ * combined in ways no stored value reaches. Found counterexamples are
+ * therefore checked by classifying their midpoint, with the rounding
+ * mode of concrete classification.
+ *
+ * @param[in] x Region
+ * @param[in] data Analysis data
+ * @return 1 if midpoint gets labels different from the sample, 0
+ *         otherwise; in both cases, midpoint is stored as sample b
+ */
+static unsigned int is_concrete_counterexample(const Hyperrectangle x, const AnalysisData data) {
+    StabilityStatus * const status = data->status;
+
+    hyperrectangle_midpoint(status->sample_b, x);
+    rounding_end(data->rounding_mode);
+    forest_classify(data->local_labels, data->F, status->sample_b);
+    rounding_begin();
+
+    return !set_is_equal(data->local_labels, status->labels_a);
+}
+
+
+
 /**
  * Expands a decorator.
  *
@@ -775,21 +1151,37 @@ static void refine(List refined, const Node n, Context context) {
     StabilityStatus *status = data->status;
     const DecisionTree *trees = forest_get_trees_as_array(F);
     const unsigned int depth = decorator_get_depth(x);
+    const size_t children_memory = list_get_memory_size(x->children);
 
     PriorityQueue Qx, Qt;
 
+    ++data->n_refinements;
+
     /* No more trees for refinement: stops */
     if (depth == forest_get_n_trees(F)) {
         /* Decorator contains a counterexample */
-        if (!set_is_equal(x->labels, data->status->labels_a)) {
+        if (!decorator_is_equal_to_sample(x, data)) {
+            if (!is_concrete_counterexample(x->x, data)) {
+                data->has_spurious_counterexample = 1;
+                return;
+            }
             data->internal_status = UNSTABLE;
-            hyperrectangle_midpoint(status->sample_b, x->x);
             hyperrectangle_copy(status->region, x->x);
+            if (status->trace != NULL) {
+                trace_add(status->trace, TRACE_INSTANT, "counterexample", "tree", depth, NULL, 0.0);
+            }
         }
 
         return;
     }
 
+    if (status->profiler != NULL) {
+        profiler_enter(status->profiler, "refinement");
+    }
+    if (status->trace != NULL) {
+        trace_add(status->trace, TRACE_BEGIN, "refine", "tree", depth, "frontier", priority_queue_get_size(data->frontier));
+    }
+
 
     /* Initializes data structures */
     priority_queue_create(&Qx);
@@ -805,26 +1197,40 @@ static void refine(List refined, const Node n, Context context) {
         Hyperrectangle x_prime = priority_queue_pop(Qx);
         const DecisionTreeNode N = priority_queue_pop(Qt);
         unsigned int i;
-        double k;
-        const unsigned int depth = binary_tree_node_get_depth(N);
+        double k, k_up;
+        const unsigned int node_depth = binary_tree_node_get_depth(N);
 
         /* A leaf was reached */
         if (decision_tree_node_is_leaf(N)) {
             HyperrectangleDecorator h;
-            decorator_create(&h, x_prime, N, x);
+            decorator_create(&h, x_prime, N, x, data->is_binary);
             list_push(x->children, h);
-            decorator_compute_labels(h->labels, h, data);
+            if (status->profiler != NULL) {
+                profiler_enter(status->profiler, "scoring");
+                decorator_compute_labels(h, data);
+                profiler_exit(status->profiler);
+            }
+            else {
+                decorator_compute_labels(h, data);
+            }
+            data->memory += decorator_get_memory_size(h);
 
             /* Leaf contains a counterexample: stops */
-            if (set_is_disjoint(h->labels, data->status->labels_a)) {
+            if (decorator_is_disjoint_from_sample(h, data)) {
+                if (!is_concrete_counterexample(x_prime, data)) {
+                    data->has_spurious_counterexample = 1;
+                    continue;
+                }
                 data->internal_status = UNSTABLE;
-                hyperrectangle_midpoint(status->sample_b, x_prime);
                 hyperrectangle_copy(status->region, x_prime);
+                if (status->trace != NULL) {
+                    trace_add(status->trace, TRACE_INSTANT, "counterexample", "tree", depth, NULL, 0.0);
+                }
                 break;
             }
 
             /* Leaf is "robust", does not help analysis: ignores */
-            else if (set_is_equal(h->labels, data->status->labels_a)) {
+            else if (decorator_is_equal_to_sample(h, data)) {
                 continue;
             }
 
@@ -837,9 +1243,10 @@ static void refine(List refined, const Node n, Context context) {
         /* An univariate linear split is reached */
         i = decision_tree_univariate_linear_split_get_index(N);
         k = decision_tree_univariate_linear_split_get_threshold(N);
+        k_up = decision_tree_univariate_linear_split_get_upper_threshold(N);
 
         /* Hyperrectangle crosses cutting hyperplane: branches */
-        if (x_prime->intervals[i].l <= k && x_prime->intervals[i].u > k) {
+        if (x_prime->intervals[i].l <= k_up && x_prime->intervals[i].u > k) {
             Hyperrectangle x_right, x_left;
             double priority;
 
@@ -847,15 +1254,15 @@ static void refine(List refined, const Node n, Context context) {
             hyperrectangle_create(&x_right, hyperrectangle_get_space_size(x_prime));
             hyperrectangle_copy(x_right, x_prime);
 
-            x_left->intervals[i].u = min(x_left->intervals[i].u, k);
+            x_left->intervals[i].u = min(x_left->intervals[i].u, k_up);
             adjust_tier(x_left, data->tier, i, 0);
-            priority = depth + (k - x_prime->intervals[i].l) / interval_radius(x_prime->intervals[i]);
+            priority = node_depth + (k - x_prime->intervals[i].l) / interval_radius(x_prime->intervals[i]);
             priority_queue_push(Qx, x_left, priority);
             priority_queue_push(Qt, decision_tree_univariate_linear_split_get_left_child(N), priority);
 
-            x_right->intervals[i].l = max(x_left->intervals[i].u, k + EPSILON);
+            x_right->intervals[i].l = to_real_down(max(x_prime->intervals[i].l, k + EPSILON));
             adjust_tier(x_right, data->tier, i, 1);
-            priority = depth + (x_prime->intervals[i].u - k) / interval_radius(x_prime->intervals[i]);
+            priority = node_depth + (x_prime->intervals[i].u - k) / interval_radius(x_prime->intervals[i]);
             priority_queue_push(Qx, x_right, priority);
             priority_queue_push(Qt, decision_tree_univariate_linear_split_get_right_child(N), priority);
         }
@@ -863,15 +1270,15 @@ static void refine(List refined, const Node n, Context context) {
         /* Hyperrectangle belongs to left hyperspace */
         else if (x_prime->intervals[i].u <= k) {
             adjust_tier(x_prime, data->tier, i, 0);
-            double priority = depth + (k - x_prime->intervals[i].l) / interval_radius(x_prime->intervals[i]);
+            double priority = node_depth + (k - x_prime->intervals[i].l) / interval_radius(x_prime->intervals[i]);
             priority_queue_push(Qx, x_prime, priority);
             priority_queue_push(Qt, decision_tree_univariate_linear_split_get_left_child(N), priority);
         }
 
         /* Hyperrectangle belongs to right hyperspace */
-        else if (x_prime->intervals[i].l > k) {
+        else if (x_prime->intervals[i].l > k_up) {
             adjust_tier(x_prime, data->tier, i, 1);
-            double priority = depth + (x_prime->intervals[i].u - k) / interval_radius(x_prime->intervals[i]);
+            double priority = node_depth + (x_prime->intervals[i].u - k) / interval_radius(x_prime->intervals[i]);
             priority_queue_push(Qx, x_prime, priority);
             priority_queue_push(Qt, decision_tree_univariate_linear_split_get_right_child(N), priority);
         }
@@ -886,8 +1293,17 @@ static void refine(List refined, const Node n, Context context) {
     }
     priority_queue_delete(&Qx);
     priority_queue_delete(&Qt);
+    data->memory += list_get_memory_size(x->children) - children_memory;
+    data->memory -= hyperrectangle_get_memory_size(x->x);
     hyperrectangle_delete(&x->x);
     x->x = NULL;
+
+    if (status->trace != NULL) {
+        trace_add(status->trace, TRACE_END, "refine", "children", list_get_size(refined), NULL, 0.0);
+    }
+    if (status->profiler != NULL) {
+        profiler_exit(status->profiler);
+    }
 }
 
 
@@ -924,74 +1340,342 @@ static double compute_priority(const Node x, Context context) {
 
 
 
-/***********************************************************************
- * Public functions.
- **********************************************************************/
+/**
+ * Converts internal status of an analysis into a stability result.
+ *
+ * Stability is not proved when a counterexample found by the analysis
+ * did not hold concretely.
+ *
+ * @param[in] data Analysis data
+ * @return Stability result
+ */
+static StabilityResult internal_status_to_result(const AnalysisData data) {
+    switch (data->internal_status) {
+    case DONT_KNOW:
+        return data->has_spurious_counterexample ? STABILITY_DONT_KNOW : STABILITY_TRUE;
 
-void forest_hyperrectangle_is_stable(
+    case UNSTABLE:
+        return STABILITY_FALSE;
+
+    case ABORTED:
+    case EXHAUSTED:
+        return STABILITY_DONT_KNOW;
+    }
+
+    return STABILITY_DONT_KNOW;
+}
+
+
+
+/**
+ * Starts timing a stage of a cascade.
+ *
+ * @param[out] stopwatch Stopwatch measuring the stage
+ */
+static void stage_begin(Stopwatch stopwatch) {
+    stopwatch_reset(stopwatch);
+    stopwatch_start(stopwatch);
+}
+
+
+
+/**
+ * Stops timing a stage of a cascade, charging its CPU time to the stage.
+ *
+ * @param[in,out] cascade Cascade
+ * @param[in] stage Stage being timed
+ * @param[in,out] stopwatch Stopwatch measuring the stage
+ */
+static void stage_end(Cascade *cascade, const CascadeStage stage, Stopwatch stopwatch) {
+    stopwatch_stop(stopwatch);
+    cascade->time[stage] += stopwatch_get_cpu_time_seconds(stopwatch);
+}
+
+
+
+/**
+ * Searches a counterexample by concretely classifying random points.
+ *
+ * Features belonging to a tier keep the value they have in the sample,
+ * so that every tried point satisfies tier constraints.
+ * Points are drawn feature by feature into doubles, as classified by the
+ * forest, and kept below upperbounds, which upward rounding may exceed.
+ * Labels tie only when their concrete scores are exactly equal, while
+ * the search keeps as tied labels whose score intervals overlap, so the
+ * attack may break a tie that the search reports as stable.
+ *
+ * @param[in,out] status Pointer to stability status
+ * @param[in] F #Forest
+ * @param[in] x #Hyperrectangle region to attack
+ * @param[in] t Feature tiers
+ * @param[in] n_samples Number of random points to try
+ */
+static void attack(
     StabilityStatus *status,
     const Forest F,
     const Hyperrectangle x,
-    const Tier t
+    const Tier t,
+    const unsigned int n_samples
 ) {
-    Hyperrectangle x_prime;
-    HyperrectangleDecorator start, goal;
-    struct analysis_data data;
-    const unsigned int has_sample = status->has_sample;
+    const unsigned int space_size = hyperrectangle_get_space_size(x);
+    double *point = (double *) malloc(space_size * sizeof(double));
+    Set labels;
+    unsigned int i, j;
 
-    /* Ensures presence of a sample */
-    if (!has_sample) {
-        hyperrectangle_midpoint(status->sample_a, x);
-        set_create(&status->labels_a, set_equality_string);
-        forest_classify(status->labels_a, F, status->sample_a);
+    if (point == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    set_create(&labels, set_equality_string);
+    for (i = 0; i < n_samples; ++i) {
+        for (j = 0; j < space_size; ++j) {
+            point[j] = min(interval_sample(x->intervals[j]), x->intervals[j].u);
+        }
+        for (j = 0; j < t.size && j < space_size; ++j) {
+            if (t.tiers[j] != 0) {
+                point[j] = status->sample_a[j];
+            }
+        }
+
+        forest_classify(labels, F, point);
+        if (!set_is_equal(labels, status->labels_a)) {
+            status->result = STABILITY_FALSE;
+            memcpy(status->sample_b, point, space_size * sizeof(double));
+            for (j = 0; j < space_size; ++j) {
+                status->region->intervals[j].l = point[j];
+                status->region->intervals[j].u = point[j];
+            }
+            break;
+        }
     }
 
+    set_delete(&labels);
+    free(point);
+}
+
+
+
+/**
+ * Searches a counterexample using hyperrectangle refinement.
+ *
+ * The whole search is a single sound arithmetic kernel: rounding mode is
+ * set once on entry and restored on exit. Lowerbounds computed in double
+ * precision are stored with #to_real_down, since storing them into a
+ * narrower #Real would round them upwards.
+ *
+ * If a cascade is given, the whole region is first overapproximated
+ * without refinement, then a search bounded by the refinement budget is
+ * performed and, if still inconclusive, its frontier is handed over to a
+ * search bounded by the timeout only.
+ *
+ * @param[in,out] status Pointer to stability status
+ * @param[in] F #Forest
+ * @param[in] x #Hyperrectangle region to analyse
+ * @param[in] t Feature tiers
+ * @param[in] start_time Start time of the analysis
+ * @param[in,out] stopwatch Stopwatch measuring cascade stages, NULL if
+ *                cascade is disabled
+ */
+static void search(
+    StabilityStatus *status,
+    const Forest F,
+    const Hyperrectangle x,
+    const Tier t,
+    const time_t start_time,
+    Stopwatch stopwatch
+) {
+    Cascade * const cascade = status->cascade;
+    const unsigned int container_size = forest_get_max_n_leaves(F);
+    Hyperrectangle x_prime;
+    HyperrectangleDecorator start, goal = NULL;
+    PriorityQueue Q;
+    struct analysis_data data;
+    RoundingMode rounding_mode;
+
     /* Initializes data strucutres */
     hyperrectangle_create(&x_prime, hyperrectangle_get_space_size(x));
     hyperrectangle_copy(x_prime, x);
-    decorator_create(&start, x_prime, NULL, NULL);
+    decorator_create(&start, x_prime, NULL, NULL, forest_get_n_labels(F) == 2);
     data.status = status;
     data.F = F;
-    data.start_time = time(NULL);
+    data.start_time = start_time;
     data.timeout = status->timeout;
+    data.budget = 0;
+    data.n_refinements = 0;
     data.internal_status = DONT_KNOW;
+    data.has_spurious_counterexample = 0;
     data.labels = forest_get_labels_as_array(F);
     data.n_labels = forest_get_n_labels(F);
     data.n_trees = forest_get_n_trees(F);
-    data.S = malloc(CONTAINER_SIZE * sizeof(DecisionTreeNode));
-    data.L = malloc(CONTAINER_SIZE * sizeof(DecisionTreeNode));
+    data.S = malloc(container_size * sizeof(DecisionTreeNode));
+    data.L = malloc(container_size * sizeof(DecisionTreeNode));
+    data.native_reachable_leaves = sizeof(Real) == sizeof(double)
+                                 ? forest_get_reachable_leaves(F)
+                                 : NULL;
+    data.leaf_indices = (unsigned int *) malloc(container_size * sizeof(unsigned int));
     data.local_scores = (unsigned int *) malloc(forest_get_n_labels(F) * sizeof(unsigned int));
     set_create(&data.local_labels, set_equality_string);
     data.tier = t;
+    data.is_binary = data.n_labels == 2;
+    data.mask_a = data.is_binary
+                ? set_has_element(status->labels_a, data.labels[0])
+                  | set_has_element(status->labels_a, data.labels[1]) << 1
+                : 0;
+    select_kernels(&data);
+    priority_queue_create(&Q);
+    data.frontier = Q;
+    data.memory = decorator_get_memory_size(start);
+    data.peak_memory = 0;
+    data.memory_limit = status->memory_limit;
+    priority_queue_push(Q, start, 0.0);
+    rounding_mode = rounding_begin();
+    data.rounding_mode = rounding_mode;
 
 
     /* Runs analysis */
-    best_first_search((Node *) &goal, start, is_complete, refine, compute_priority, &data);
-
+    if (cascade == NULL) {
+        best_first_search_resume((Node *) &goal, Q, is_complete, refine, compute_priority, &data);
+        status->result = internal_status_to_result(&data);
+    }
+    else {
+        /* Interval overapproximation of the whole region, which proves
+         * stability only when the sample has a single label: with ties,
+         * the same overapproximated labels may hide points getting one of
+         * them only */
+        stage_begin(stopwatch);
+        ++cascade->n_entered[CASCADE_INTERVAL];
+        decorator_compute_labels(start, &data);
+        stage_end(cascade, CASCADE_INTERVAL, stopwatch);
+        if (set_is_singleton(status->labels_a) && decorator_is_equal_to_sample(start, &data)) {
+            ++cascade->n_decided[CASCADE_INTERVAL];
+            status->result = STABILITY_TRUE;
+        }
 
-    /* Checks result */
-    switch (data.internal_status) {
-    case DONT_KNOW:
-        status->result = STABILITY_TRUE;
-        break;
+        /* Search bounded by refinement budget */
+        else {
+            stage_begin(stopwatch);
+            ++cascade->n_entered[CASCADE_BOUNDED_SEARCH];
+            data.budget = cascade->budget;
+            best_first_search_resume((Node *) &goal, Q, is_complete, refine, compute_priority, &data);
+            stage_end(cascade, CASCADE_BOUNDED_SEARCH, stopwatch);
+            status->result = internal_status_to_result(&data);
+
+            /* Resumes from the same frontier, bounded by timeout only */
+            if (data.internal_status == EXHAUSTED) {
+                stage_begin(stopwatch);
+                ++cascade->n_entered[CASCADE_FULL_SEARCH];
+                priority_queue_push(Q, goal, compute_priority(goal, &data));
+                data.budget = 0;
+                data.internal_status = DONT_KNOW;
+                best_first_search_resume((Node *) &goal, Q, is_complete, refine, compute_priority, &data);
+                stage_end(cascade, CASCADE_FULL_SEARCH, stopwatch);
+                status->result = internal_status_to_result(&data);
+                cascade->n_decided[CASCADE_FULL_SEARCH] += status->result != STABILITY_DONT_KNOW;
+            }
+            else {
+                cascade->n_decided[CASCADE_BOUNDED_SEARCH] += status->result != STABILITY_DONT_KNOW;
+            }
+        }
+    }
 
-    case UNSTABLE:
-        status->result = STABILITY_FALSE;
-        break;
 
-    case ABORTED:
-        status->result = STABILITY_DONT_KNOW;
-        break;
+    update_peak_memory(&data);
+    status->peak_memory = data.peak_memory;
+    if (status->profiler != NULL) {
+        profiler_count(status->profiler, "refinements", data.n_refinements);
     }
 
 
     /* Deallocates memory */
-    if (!has_sample) {
-        stability_status_unset_sample(status);
-    }
+    rounding_end(rounding_mode);
+    priority_queue_delete(&Q);
     decorator_delete(&start);
     free(data.S);
     free(data.L);
+    free(data.leaf_indices);
     free(data.local_scores);
     set_delete(&data.local_labels);
 }
+
+
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+void forest_hyperrectangle_is_stable(
+    StabilityStatus *status,
+    const Forest F,
+    const Hyperrectangle x,
+    const Tier t
+) {
+    const unsigned int has_sample = status->has_sample;
+    const time_t start_time = time(NULL);
+    Cascade * const cascade = status->cascade;
+    Stopwatch stopwatch = NULL;
+
+    /* Ensures presence of a sample */
+    if (!has_sample) {
+        hyperrectangle_midpoint(status->sample_a, x);
+        set_create(&status->labels_a, set_equality_string);
+        forest_classify(status->labels_a, F, status->sample_a);
+    }
+    status->result = STABILITY_DONT_KNOW;
+    status->peak_memory = 0;
+
+    /* Concrete attack, if cascade is enabled */
+    if (cascade != NULL) {
+        stopwatch_create(&stopwatch);
+        stage_begin(stopwatch);
+        ++cascade->n_entered[CASCADE_ATTACK];
+        attack(status, F, x, t, cascade->n_attack_samples);
+        stage_end(cascade, CASCADE_ATTACK, stopwatch);
+        cascade->n_decided[CASCADE_ATTACK] += status->result == STABILITY_FALSE;
+    }
+
+    /* Hyperrectangle analysis */
+    if (status->result == STABILITY_DONT_KNOW) {
+        search(status, F, x, t, start_time, stopwatch);
+    }
+
+    /* Deallocates memory */
+    if (stopwatch != NULL) {
+        stopwatch_delete(&stopwatch);
+    }
+    if (!has_sample) {
+        stability_status_unset_sample(status);
+    }
+}
+
+
+
+double forest_hyperrectangle_estimate_difficulty(
+    const Forest F,
+    const Hyperrectangle x
+) {
+    const unsigned int n_trees = forest_get_n_trees(F),
+                       container_size = forest_get_max_n_leaves(F);
+    const DecisionTree *trees = forest_get_trees_as_array(F);
+    DecisionTreeNode *S = (DecisionTreeNode *) malloc(container_size * sizeof(DecisionTreeNode)),
+                     *L = (DecisionTreeNode *) malloc(container_size * sizeof(DecisionTreeNode));
+    unsigned int t, n_leaves;
+    double difficulty = 0.0;
+
+    if (S == NULL || L == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (t = 0; t < n_trees; ++t) {
+        reachable_leaves(L, &n_leaves, S, trees[t], x);
+        difficulty += log2(n_leaves);
+    }
+
+    free(S);
+    free(L);
+
+    return difficulty;
+}
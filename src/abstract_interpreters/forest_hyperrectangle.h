@@ -29,4 +29,22 @@ void forest_hyperrectangle_is_stable(
     const Tier t
 );
 
+
+
+/**
+ * Estimates difficulty of analysing a #Forest in a #Hyperrectangle region.
+ *
+ * Difficulty is the logarithm (base 2) of the product of the numbers of
+ * leaves of each tree reachable from the region, that is, of the number of
+ * leaf combinations the analysis may have to explore.
+ *
+ * @param[in] F #Forest to analyse
+ * @param[in] x #Hyperrectangle representing a region
+ * @return Estimated difficulty
+ */
+double forest_hyperrectangle_estimate_difficulty(
+    const Forest F,
+    const Hyperrectangle x
+);
+
 #endif
@@ -10,6 +10,9 @@
 #include <stdio.h>
 #include "../abstract_domains/hyperrectangle.h"
 #include "../set.h"
+#include "cascade.h"
+#include "../profiler.h"
+#include "../trace.h"
 
 /** Types of stability analysis status. */
 enum stability_result {
@@ -39,6 +42,16 @@ struct stability_status {
                                    labels_A = Cl(sample_A)\f$. */
     unsigned int timeout;    /**< Maximum execution time for each sample
                                   (seconds). */
+    Cascade *cascade;        /**< Staged analysis configuration and
+                                  statistics, NULL to run a full search only. */
+    Profiler *profiler;      /**< Profiler of the analysis, NULL to disable
+                                  profiling. */
+    Trace trace;             /**< Trace of the analysis, NULL to disable
+                                  tracing. */
+    size_t memory_limit;     /**< Maximum memory held by the search of each
+                                  sample (bytes), 0 for no limit. */
+    size_t peak_memory;      /**< Peak memory held by the search of the
+                                  last sample (bytes). */
 };
 
 
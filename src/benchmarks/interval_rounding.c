@@ -0,0 +1,172 @@
+/**
+ * Benchmarks sound interval arithmetic.
+ *
+ * Compares three ways of computing interval fused multiply-adds over a
+ * large array: plain arithmetic with no soundness guarantee, switching
+ * rounding mode twice per operation, and setting rounding mode once per
+ * kernel as done by #rounding_begin. Must be compiled with
+ * ENFORCE_SOUNDNESS defined.
+ *
+ * @file interval_rounding.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../abstract_domains/interval.h"
+
+
+/** Number of intervals. */
+#define N_INTERVALS (1024 * 1024)
+
+/** Number of repetitions. */
+#define N_REPETITIONS 32
+
+
+
+/**
+ * Computes \f$x_i = \alpha \cdot x_i + y_i\f$ with no rounding control.
+ *
+ * @param[in,out] x Intervals
+ * @param[in] y Intervals
+ * @param[in] alpha Scaling factor
+ * @param[in] n Number of intervals
+ */
+static void fma_unsound(Interval *x, const Interval *y, const Real alpha, const unsigned int n) {
+    unsigned int i;
+
+    for (i = 0; i < n; ++i) {
+        x[i].l = alpha * x[i].l + y[i].l;
+        x[i].u = alpha * x[i].u + y[i].u;
+    }
+}
+
+
+
+/**
+ * Computes \f$x_i = \alpha \cdot x_i + y_i\f$ switching rounding mode at
+ * each operation.
+ *
+ * @param[in,out] x Intervals
+ * @param[in] y Intervals
+ * @param[in] alpha Scaling factor
+ * @param[in] n Number of intervals
+ */
+static void fma_per_operation(Interval *x, const Interval *y, const Real alpha, const unsigned int n) {
+    unsigned int i;
+
+    for (i = 0; i < n; ++i) {
+        fesetround(FE_DOWNWARD);
+        x[i].l = alpha * x[i].l + y[i].l;
+        fesetround(FE_UPWARD);
+        x[i].u = alpha * x[i].u + y[i].u;
+    }
+    fesetround(FE_TONEAREST);
+}
+
+
+
+/**
+ * Computes \f$x_i = \alpha \cdot x_i + y_i\f$ setting rounding mode once.
+ *
+ * @param[in,out] x Intervals
+ * @param[in] y Intervals
+ * @param[in] alpha Scaling factor
+ * @param[in] n Number of intervals
+ */
+static void fma_per_kernel(Interval *x, const Interval *y, const Real alpha, const unsigned int n) {
+    const RoundingMode mode = rounding_begin();
+    unsigned int i;
+
+    for (i = 0; i < n; ++i) {
+        interval_fma(x + i, alpha, x[i], y[i]);
+    }
+    rounding_end(mode);
+}
+
+
+
+/**
+ * Times a kernel.
+ *
+ * @param[in] kernel Kernel to time
+ * @param[in] x Initial intervals
+ * @param[in] y Intervals
+ * @param[out] checksum Sum of resulting radii
+ * @return Elapsed CPU time, in seconds
+ */
+static double run(
+    void (*kernel)(Interval *, const Interval *, const Real, const unsigned int),
+    const Interval *x,
+    const Interval *y,
+    double *checksum
+) {
+    Interval *z = (Interval *) malloc(N_INTERVALS * sizeof(Interval));
+    unsigned int i;
+    clock_t start;
+    double elapsed;
+
+    if (z == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < N_INTERVALS; ++i) {
+        z[i] = x[i];
+    }
+
+    start = clock();
+    for (i = 0; i < N_REPETITIONS; ++i) {
+        kernel(z, y, 0.5, N_INTERVALS);
+    }
+    elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    *checksum = 0.0;
+    for (i = 0; i < N_INTERVALS; ++i) {
+        *checksum += interval_radius(z[i]);
+    }
+
+    free(z);
+    return elapsed;
+}
+
+
+
+/**
+ * Main.
+ *
+ * @return EXIT_SUCCESS
+ */
+int main(void) {
+    Interval *x = (Interval *) malloc(N_INTERVALS * sizeof(Interval)),
+             *y = (Interval *) malloc(N_INTERVALS * sizeof(Interval));
+    double t_unsound, t_operation, t_kernel, c_unsound, c_operation, c_kernel;
+    unsigned int i;
+
+    if (x == NULL || y == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    srand(42);
+    for (i = 0; i < N_INTERVALS; ++i) {
+        x[i].l = (Real) rand() / RAND_MAX;
+        x[i].u = x[i].l + (Real) rand() / RAND_MAX;
+        y[i].l = (Real) rand() / RAND_MAX / 3.0;
+        y[i].u = y[i].l + (Real) rand() / RAND_MAX / 3.0;
+    }
+
+    t_unsound = run(fma_unsound, x, y, &c_unsound);
+    t_operation = run(fma_per_operation, x, y, &c_operation);
+    t_kernel = run(fma_per_kernel, x, y, &c_kernel);
+
+    printf("%-24s %12s %12s %20s\n", "Rounding", "Time (s)", "Overhead", "Sum of radii");
+    printf("%-24s %12g %12s %20.12g\n", "none (unsound)", t_unsound, "1x", c_unsound);
+    printf("%-24s %12g %11.2fx %20.12g\n", "per operation", t_operation, t_operation / t_unsound, c_operation);
+    printf("%-24s %12g %11.2fx %20.12g\n", "per kernel", t_kernel, t_kernel / t_unsound, c_kernel);
+
+    free(x);
+    free(y);
+    return EXIT_SUCCESS;
+}
@@ -263,6 +263,12 @@ unsigned int binary_heap_get_size(const BinaryHeap H) {
 
 
 
+size_t binary_heap_get_memory_size(const BinaryHeap H) {
+    return H ? sizeof(struct binary_heap) + H->capacity * sizeof(Node) : 0;
+}
+
+
+
 double binary_heap_get_next_key(const BinaryHeap H) {
     return H ? H->nodes[0].key : 0.0;
 }
@@ -64,6 +64,15 @@ unsigned int binary_heap_is_empty(const BinaryHeap H);
 unsigned int binary_heap_get_size(const BinaryHeap H);
 
 
+/**
+ * Returns memory held by a binary heap, node buffer included.
+ *
+ * @param[in] H Binary heap
+ * @return Size of the binary heap (bytes), 0 if heap is NULL
+ */
+size_t binary_heap_get_memory_size(const BinaryHeap H);
+
+
 /**
  * Returns key of first element in a binary heap.
  *
@@ -246,6 +246,25 @@ void binary_tree_node_set_right_child(BinaryTreeNode N, BinaryTreeNode R) {
 
 
 
+void binary_tree_node_detach(BinaryTreeNode N) {
+    if (N == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (N->parent != NULL) {
+        if (N->parent->left_child == N) {
+            N->parent->left_child = NULL;
+        }
+        if (N->parent->right_child == N) {
+            N->parent->right_child = NULL;
+        }
+        N->parent = NULL;
+    }
+}
+
+
+
 void binary_tree_print(
     const BinaryTree T,
     const BinaryTreePrinter printer,
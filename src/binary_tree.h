@@ -169,6 +169,14 @@ void binary_tree_node_set_left_child(BinaryTreeNode N, BinaryTreeNode L);
 void binary_tree_node_set_right_child(BinaryTreeNode N, BinaryTreeNode R);
 
 
+/**
+ * Detaches a node from its parent, making it the root of its subtree.
+ *
+ * @param[in,out] N Node
+ */
+void binary_tree_node_detach(BinaryTreeNode N);
+
+
 
 /**
  * Prints a binary tree.
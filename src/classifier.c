@@ -186,6 +186,53 @@ void classifier_classify(Set labels, const Classifier C, const double *x) {
 
 
 
+void classifier_classify_block(
+    Set *labels,
+    const Classifier C,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+) {
+    if (C == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    switch (C->type) {
+    case CLASSIFIER_TREE:
+        decision_tree_classify_block(labels, C->data.T, columns, first, step, n);
+        break;
+    case CLASSIFIER_FOREST:
+        forest_classify_block(labels, C->data.F, columns, first, step, n);
+        break;
+    }
+}
+
+
+
+unsigned int classifier_optimize(
+    Classifier C,
+    const double *lower,
+    const double *upper
+) {
+    if (C == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    switch (C->type) {
+    case CLASSIFIER_TREE:
+        return decision_tree_optimize(C->data.T, lower, upper);
+    case CLASSIFIER_FOREST:
+        return forest_optimize(C->data.F, lower, upper);
+    }
+
+    return 0;
+}
+
+
+
 void classifier_print(const Classifier C, FILE *stream) {
     if (C == NULL) {
         fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
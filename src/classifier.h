@@ -114,6 +114,45 @@ void classifier_compute_decision_function(
 void classifier_classify(Set labels, const Classifier C, const double *x);
 
 
+/**
+ * Classifies a block of samples stored in column-major layout.
+ *
+ * Sample s of the block, from 0 to n - 1, has feature j in
+ * columns[j][first + s * step].
+ *
+ * @param[out] labels Array of n sets of labels, one for each sample
+ * @param[in] C Classifier
+ * @param[in] columns Feature columns
+ * @param[in] first Position of first sample in columns
+ * @param[in] step Distance between positions of consecutive samples
+ * @param[in] n Number of samples
+ */
+void classifier_classify_block(
+    Set *labels,
+    const Classifier C,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+);
+
+
+/**
+ * Simplifies a classifier, without changing its decision function.
+ *
+ * @param[in,out] C Classifier
+ * @param[in] lower Lower bound of each feature, NULL if unbounded
+ * @param[in] upper Upper bound of each feature, NULL if unbounded
+ * @return Number of removed nodes
+ * @see #decision_tree_optimize for details on simplification and bounds
+ */
+unsigned int classifier_optimize(
+    Classifier C,
+    const double *lower,
+    const double *upper
+);
+
+
 /**
  * Prints a classifier.
  *
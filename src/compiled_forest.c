@@ -0,0 +1,129 @@
+/**
+ * Implements a compiled forest.
+ *
+ * @file compiled_forest.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "compiled_forest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+
+#include "data_mappers/forest_c.h"
+
+
+/** Structure of a compiled forest. */
+struct compiled_forest {
+    void *handle;                                /**< Shared object handle. */
+    ForestDecisionFunction decision_function;    /**< Native decision function. */
+    ForestReachableLeaves reachable_leaves;      /**< Native computation of
+                                                      reachable leaves, NULL if
+                                                      not provided. */
+    unsigned int n_trees;                        /**< Number of trees. */
+    unsigned int n_labels;                       /**< Number of labels. */
+    unsigned int space_size;                     /**< Size of feature space. */
+    unsigned long long hash;                     /**< Structure hash of the
+                                                      forest. */
+};
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Reads an unsigned integer constant from a shared object.
+ *
+ * @param[in] handle Shared object handle
+ * @param[in] name Name of the constant
+ * @return Value of the constant
+ */
+static unsigned int read_constant(void *handle, const char *name) {
+    const unsigned int *value = (const unsigned int *) dlsym(handle, name);
+
+    if (value == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot find symbol %s: %s.\n", __FILE__, __LINE__, name, dlerror());
+        abort();
+    }
+
+    return *value;
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+void compiled_forest_create(CompiledForest *C, const char *path) {
+    CompiledForest c = (CompiledForest) malloc(sizeof(struct compiled_forest));
+    const unsigned long long *hash;
+
+    if (c == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    c->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (c->handle == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot load compiled forest: %s.\n", __FILE__, __LINE__, dlerror());
+        abort();
+    }
+
+    /* Conversion through void ** avoids casting an object pointer to a
+       function pointer, which ISO C does not allow */
+    *(void **) (&c->decision_function) = dlsym(c->handle, FOREST_C_DECISION_FUNCTION);
+    if (c->decision_function == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot find symbol %s: %s.\n", __FILE__, __LINE__, FOREST_C_DECISION_FUNCTION, dlerror());
+        abort();
+    }
+    *(void **) (&c->reachable_leaves) = dlsym(c->handle, FOREST_C_REACHABLE_LEAVES);
+    c->n_trees = read_constant(c->handle, FOREST_C_N_TREES);
+    c->n_labels = read_constant(c->handle, FOREST_C_N_LABELS);
+    c->space_size = read_constant(c->handle, FOREST_C_SPACE_SIZE);
+    hash = (const unsigned long long *) dlsym(c->handle, FOREST_C_HASH);
+    if (hash == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot find symbol %s, recompile the model with silva-compile: %s.\n", __FILE__, __LINE__, FOREST_C_HASH, dlerror());
+        abort();
+    }
+    c->hash = *hash;
+
+    *C = c;
+}
+
+
+
+void compiled_forest_delete(CompiledForest *C) {
+    if (C == NULL || *C == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    dlclose((*C)->handle);
+    free(*C);
+    *C = NULL;
+}
+
+
+
+void compiled_forest_attach(const CompiledForest C, Forest F) {
+    if (C == NULL || F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (C->n_trees != forest_get_n_trees(F)
+        || C->n_labels != forest_get_n_labels(F)
+        || C->space_size != forest_get_feature_space_size(F)
+        || C->hash != forest_hash_structure(F)) {
+        fprintf(stderr, "[%s: %d] Compiled forest was not generated from this forest.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    forest_set_decision_function(F, C->decision_function);
+    forest_set_reachable_leaves(F, C->reachable_leaves);
+}
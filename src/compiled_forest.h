@@ -0,0 +1,57 @@
+/**
+ * Defines a compiled forest.
+ *
+ * A compiled forest is a shared object, generated by silva-compile,
+ * providing a native decision function for a forest.
+ *
+ * @file compiled_forest.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef COMPILED_FOREST_H
+#define COMPILED_FOREST_H
+
+#include "forest.h"
+
+
+/** Type of a compiled forest. */
+typedef struct compiled_forest *CompiledForest;
+
+
+/**
+ * Loads a compiled forest from a shared object.
+ *
+ * @param[out] C Pointer to compiled forest to create
+ * @param[in] path Path to shared object
+ * @warning #compiled_forest_delete should be called to ensure proper
+ *          memory deallocation.
+ */
+void compiled_forest_create(CompiledForest *C, const char *path);
+
+
+/**
+ * Unloads a compiled forest.
+ *
+ * @param[out] C Pointer to compiled forest to delete
+ * @warning Forests attached to the compiled forest must not be used for
+ *          concrete classification afterwards.
+ */
+void compiled_forest_delete(CompiledForest *C);
+
+
+
+/**
+ * Attaches a compiled forest to a forest.
+ *
+ * Concrete classification of the forest will use the native decision
+ * function from then on, and hyperrectangle analysis the native
+ * computation of reachable leaves, if the compiled forest provides it.
+ *
+ * @param[in] C Compiled forest
+ * @param[in,out] F Forest the compiled forest was generated from
+ * @note Aborts if number of trees, number of labels, size of feature
+ *       space or structure hash do not match, since native functions
+ *       refer to leaves of the original forest by position.
+ */
+void compiled_forest_attach(const CompiledForest C, Forest F);
+
+#endif
@@ -8,33 +8,124 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 
 /** Size of the reading buffer. */
-#define BUFFER_SIZE 32
-
-
-/** Stringifier - part 2. */
-#define STR2(x) #x
-
-/** Stringifier - part 1. */
-#define STR(X) STR2(X)
+#define BUFFER_SIZE 64
 
 
 /***********************************************************************
  * Internal functions.
  **********************************************************************/
 
+/** Structure of a cursor over text in memory. */
+struct cursor {
+    const char *position;  /**< Next character to read. */
+    const char *end;       /**< End of text. */
+};
+
+/** Type of a cursor over text in memory. */
+typedef struct cursor Cursor;
+
+
+
+/**
+ * Reads next whitespace-separated token.
+ *
+ * @param[out] token Pointer to first character of token, not terminated
+ * @param[in,out] cursor Cursor
+ * @return Length of token, 0 if text is over
+ */
+static size_t next_token(const char **token, Cursor *cursor) {
+    const char *p = cursor->position;
+
+    while (p < cursor->end && isspace((unsigned char) *p)) {
+        ++p;
+    }
+    *token = p;
+    while (p < cursor->end && !isspace((unsigned char) *p)) {
+        ++p;
+    }
+    cursor->position = p;
+
+    return p - *token;
+}
+
+
+
+/**
+ * Reads next token into a buffer, as a null-terminated string.
+ *
+ * @param[out] buffer Buffer of #BUFFER_SIZE characters
+ * @param[in,out] cursor Cursor
+ * @return 1 if a token fitting the buffer was read, 0 otherwise
+ */
+static unsigned int read_token(char *buffer, Cursor *cursor) {
+    const char *token;
+    const size_t length = next_token(&token, cursor);
+
+    if (length == 0 || length >= BUFFER_SIZE) {
+        return 0;
+    }
+    memcpy(buffer, token, length);
+    buffer[length] = '\0';
+
+    return 1;
+}
+
+
+
+/**
+ * Reads an unsigned integer.
+ *
+ * @param[out] value Value
+ * @param[in,out] cursor Cursor
+ * @return 1 if a value was read, 0 otherwise
+ */
+static unsigned int read_unsigned(unsigned int *value, Cursor *cursor) {
+    char buffer[BUFFER_SIZE], *end;
+
+    if (!read_token(buffer, cursor)) {
+        return 0;
+    }
+    *value = (unsigned int) strtoul(buffer, &end, 10);
+
+    return *end == '\0';
+}
+
+
+
+/**
+ * Reads a real number.
+ *
+ * @param[out] value Value
+ * @param[in,out] cursor Cursor
+ * @return 1 if a value was read, 0 otherwise
+ */
+static unsigned int read_double(double *value, Cursor *cursor) {
+    char buffer[BUFFER_SIZE], *end;
+
+    if (!read_token(buffer, cursor)) {
+        return 0;
+    }
+    *value = strtod(buffer, &end);
+
+    return *end == '\0';
+}
+
+
+
 /**
  * Parses a node or subtree.
  *
  * @param[out] N Node
- * @param[in,out] stream Stream
+ * @param[in,out] cursor Cursor
  * @param[in] n_labels Number of labels
  */
 static void parse_node(
     DecisionTreeNode *N,
-    FILE *stream,
+    Cursor *cursor,
     const unsigned int n_labels
 );
 
@@ -44,15 +135,15 @@ static void parse_node(
  * Parses a leaf.
  *
  * @param[out] N Node
- * @param[in,out] stream Stream
+ * @param[in,out] cursor Cursor
  * @param[in] n_labels Number of labels
  */
 static void parse_leaf(
     DecisionTreeNode *N,
-    FILE *stream,
+    Cursor *cursor,
     const unsigned int n_labels
 ) {
-    unsigned int i, n, *scores = (unsigned int *) malloc(n_labels * sizeof(unsigned int));
+    unsigned int i, *scores = (unsigned int *) malloc(n_labels * sizeof(unsigned int));
 
     if (scores == NULL) {
         fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
@@ -60,8 +151,7 @@ static void parse_leaf(
     }
 
     for (i = 0; i < n_labels; ++i) {
-        n = fscanf(stream, "%u", scores + i);
-        if (n != 1) {
+        if (!read_unsigned(scores + i, cursor)) {
             fprintf(stderr, "[%s: %d] Cannot parse leaf.\n", __FILE__, __LINE__);
             abort();
         }
@@ -76,15 +166,15 @@ static void parse_leaf(
  * Parses a leaf with logarithmic distribution of probabilities.
  *
  * @param[out] N Node
- * @param[in,out] stream Stream
+ * @param[in,out] cursor Cursor
  * @param[in] n_labels Number of labels
  */
 static void parse_leaf_logarithmic(
     DecisionTreeNode *N,
-    FILE *stream,
+    Cursor *cursor,
     const unsigned int n_labels
 ) {
-    unsigned int i, n;
+    unsigned int i;
     double *scores = (double *) malloc(n_labels * sizeof(double));
 
     if (scores == NULL) {
@@ -93,8 +183,7 @@ static void parse_leaf_logarithmic(
     }
 
     for (i = 0; i < n_labels; ++i) {
-        n = fscanf(stream, "%lg", scores + i);
-        if (n != 1) {
+        if (!read_double(scores + i, cursor)) {
             fprintf(stderr, "[%s: %d] Cannot parse leaf.\n", __FILE__, __LINE__);
             abort();
         }
@@ -109,26 +198,25 @@ static void parse_leaf_logarithmic(
  * Parses an univariate linear split.
  *
  * @param[out] N Node
- * @param[in,out] stream Stream
+ * @param[in,out] cursor Cursor
  * @param[in] n_labels Number of labels
  */
 static void parse_univariate_linear_split(
     DecisionTreeNode *N,
-    FILE *stream,
+    Cursor *cursor,
     const unsigned int n_labels
 ) {
-    unsigned int n, feature;
+    unsigned int feature;
     double threshold;
     DecisionTreeNode L, R;
 
-    n = fscanf(stream, "%u %lf", &feature, &threshold);
-    if (n != 2) {
+    if (!read_unsigned(&feature, cursor) || !read_double(&threshold, cursor)) {
         fprintf(stderr, "[%s: %d] Cannot parse univariate linear split.\n", __FILE__, __LINE__);
         abort();
     }
 
-    parse_node(&L, stream, n_labels);
-    parse_node(&R, stream, n_labels);
+    parse_node(&L, cursor, n_labels);
+    parse_node(&R, cursor, n_labels);
 
     decision_tree_univariate_linear_split_create(N, feature, threshold);
     decision_tree_univariate_linear_split_set_left_child(*N, L);
@@ -139,28 +227,26 @@ static void parse_univariate_linear_split(
 
 static void parse_node(
     DecisionTreeNode *N,
-    FILE *stream,
+    Cursor *cursor,
     const unsigned int n_labels
 ) {
-    unsigned int n;
     char node_type[BUFFER_SIZE];
 
-    n = fscanf(stream, "%" STR(BUFFER_SIZE) "s", node_type);
-    if (n != 1) {
+    if (!read_token(node_type, cursor)) {
         fprintf(stderr, "[%s: %d] Cannot parse decision tree node.\n", __FILE__, __LINE__);
         abort();
     }
 
     if (strcmp(node_type, "LEAF") == 0) {
-        parse_leaf(N, stream, n_labels);
+        parse_leaf(N, cursor, n_labels);
     }
 
     else if (strcmp(node_type, "LEAF_LOGARITHMIC") == 0) {
-        parse_leaf_logarithmic(N, stream, n_labels);
+        parse_leaf_logarithmic(N, cursor, n_labels);
     }
 
     else if (strcmp(node_type, "SPLIT") == 0) {
-        parse_univariate_linear_split(N, stream, n_labels);
+        parse_univariate_linear_split(N, cursor, n_labels);
     }
 
     else {
@@ -176,25 +262,52 @@ static void parse_node(
  **********************************************************************/
 
 void decision_tree_silva_read(DecisionTree *T, FILE *stream) {
-    unsigned int n, i, space_size, n_labels;
-    char **labels, buffer[BUFFER_SIZE];
-    BinaryTree root;
+    size_t size = 0, capacity = BUFFER_SIZE, n;
+    char *text = (char *) malloc(capacity * sizeof(char));
 
     if (!stream) {
         fprintf(stderr, "[%s: %d] Cannot read file.\n", __FILE__, __LINE__);
         abort();
     }
 
+    /* Reads the rest of stream */
+    while (text != NULL && (n = fread(text + size, sizeof(char), capacity - size, stream)) > 0) {
+        size += n;
+        if (size == capacity) {
+            capacity *= 2;
+            text = (char *) realloc(text, capacity * sizeof(char));
+        }
+    }
+    if (text == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    decision_tree_silva_parse(T, text, size);
+    free(text);
+}
+
+
+
+const char *decision_tree_silva_parse(DecisionTree *T, const char *text, const size_t size) {
+    unsigned int i, space_size, n_labels;
+    char **labels, buffer[BUFFER_SIZE];
+    const char *label;
+    size_t length;
+    Cursor cursor;
+    BinaryTree root;
+
+    cursor.position = text;
+    cursor.end = text + size;
+
     /* Parses header. */
-    n = fscanf(stream, "%" STR(BUFFER_SIZE) "s", buffer);
-    if (n != 1 || strcmp(buffer, "classifier-decision-tree") != 0) {
+    if (!read_token(buffer, &cursor) || strcmp(buffer, "classifier-decision-tree") != 0) {
         fprintf(stderr, "[%s: %d] Cannot parse decision tree.\n", __FILE__, __LINE__);
         abort();
     }
 
     /* Parses feature space size and number of labels */
-    n = fscanf(stream, "%u %u", &space_size, &n_labels);
-    if (n != 2) {
+    if (!read_unsigned(&space_size, &cursor) || !read_unsigned(&n_labels, &cursor)) {
         fprintf(stderr, "[%s: %d] Cannot parse decision tree.\n", __FILE__, __LINE__);
         abort();
     }
@@ -202,18 +315,22 @@ void decision_tree_silva_read(DecisionTree *T, FILE *stream) {
     /* Parses labels */
     labels = (char **) malloc(n_labels * sizeof(char *));
     for (i = 0; i < n_labels; ++i) {
-        labels[i] = (char *) malloc(BUFFER_SIZE * sizeof(char));
-        n = fscanf(stream, "%" STR(BUFFER_SIZE) "s", labels[i]);
-        if (n != 1) {
+        length = next_token(&label, &cursor);
+        labels[i] = (char *) malloc((length + 1) * sizeof(char));
+        if (length == 0 || labels[i] == NULL) {
             fprintf(stderr, "[%s: %d] Cannot parse decision tree.\n", __FILE__, __LINE__);
             abort();
         }
+        memcpy(labels[i], label, length);
+        labels[i][length] = '\0';
     }
 
     /* Parses decision tree */
-    parse_node(&root, stream, n_labels);
+    parse_node(&root, &cursor, n_labels);
 
 
     /* Builds decision tree */
     decision_tree_create(T, root, space_size, labels, n_labels);
+
+    return cursor.position;
 }
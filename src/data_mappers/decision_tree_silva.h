@@ -22,4 +22,17 @@
  */
 void decision_tree_silva_read(DecisionTree *T, FILE *stream);
 
+
+/**
+ * Parses a decision tree stored in silva format from memory.
+ *
+ * @param[out] T Pointer to decision tree
+ * @param[in] text Text, not necessarily null-terminated
+ * @param[in] size Size of text
+ * @return Pointer to first character after the tree
+ * @warning #decision_tree_delete should be called to ensure proper
+ *          memory deallocation.
+ */
+const char *decision_tree_silva_parse(DecisionTree *T, const char *text, const size_t size);
+
 #endif
@@ -0,0 +1,268 @@
+/**
+ * Data mapper for a forest to C source code.
+ *
+ * @file forest_c.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#include "forest_c.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+
+/***********************************************************************
+ * Private functions and data structures.
+ **********************************************************************/
+
+/**
+ * Writes indentation.
+ *
+ * @param[out] stream Stream
+ * @param[in] depth Indentation level
+ */
+static void write_indentation(FILE *stream, const unsigned int depth) {
+    unsigned int i;
+
+    for (i = 0; i < depth; ++i) {
+        fprintf(stream, "    ");
+    }
+}
+
+
+
+/**
+ * Writes a floating point constant.
+ *
+ * Finite values are written in hexadecimal notation, which is exact.
+ *
+ * @param[out] stream Stream
+ * @param[in] x Value
+ */
+static void write_value(FILE *stream, const double x) {
+    if (isnan(x)) {
+        fprintf(stream, "NAN");
+    }
+    else if (isinf(x)) {
+        fprintf(stream, x > 0.0 ? "INFINITY" : "-INFINITY");
+    }
+    else {
+        fprintf(stream, "%a", x);
+    }
+}
+
+
+
+/**
+ * Writes a subtree as nested if statements.
+ *
+ * Leaves return a static array holding the scores of the tree, as
+ * computed by #decision_tree_compute_decision_function.
+ *
+ * @param[out] stream Stream
+ * @param[in] N Root of the subtree
+ * @param[in] n_labels Number of labels
+ * @param[in] depth Indentation level
+ */
+static void write_node(
+    FILE *stream,
+    const DecisionTreeNode N,
+    const unsigned int n_labels,
+    const unsigned int depth
+) {
+    const struct node *data = (struct node *) N->data;
+    unsigned int i;
+
+    switch (data->type) {
+    case DECISION_TREE_LEAF:
+        write_indentation(stream, depth);
+        fprintf(stream, "static const double s[] = {");
+        for (i = 0; i < n_labels; ++i) {
+            fprintf(stream, "%s", i > 0 ? ", " : "");
+            write_value(stream, (double) data->data.leaf.scores[i] / (double) data->data.leaf.n_samples);
+        }
+        fprintf(stream, "};\n");
+        write_indentation(stream, depth);
+        fprintf(stream, "return s;\n");
+        break;
+
+    case DECISION_TREE_LEAF_LOG:
+        write_indentation(stream, depth);
+        fprintf(stream, "static const double s[] = {");
+        for (i = 0; i < n_labels; ++i) {
+            fprintf(stream, "%s", i > 0 ? ", " : "");
+            write_value(stream, data->data.leaf_logarithmic.scores[i]);
+        }
+        fprintf(stream, "};\n");
+        write_indentation(stream, depth);
+        fprintf(stream, "return s;\n");
+        break;
+
+    case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
+        write_indentation(stream, depth);
+        fprintf(stream, "if (x[%u] <= ", data->data.univariate_linear_split.i);
+        write_value(stream, data->data.univariate_linear_split.k);
+        fprintf(stream, ") {\n");
+        write_node(stream, N->left_child, n_labels, depth + 1);
+        write_indentation(stream, depth);
+        fprintf(stream, "}\n");
+        write_indentation(stream, depth);
+        fprintf(stream, "else {\n");
+        write_node(stream, N->right_child, n_labels, depth + 1);
+        write_indentation(stream, depth);
+        fprintf(stream, "}\n");
+        break;
+    }
+}
+
+
+
+/**
+ * Writes a subtree as code collecting leaves reachable from a box.
+ *
+ * Both branches of a split are visited when the box crosses the
+ * threshold: the left one is reachable up to the upper threshold, the
+ * right one above the lower threshold. Leaves are numbered in depth-first
+ * pre-order, as in #decision_tree_get_leaves_as_array.
+ *
+ * @param[out] stream Stream
+ * @param[in] N Root of the subtree
+ * @param[in,out] leaf_index Index of next leaf
+ * @param[in] depth Indentation level
+ */
+static void write_reachable_node(
+    FILE *stream,
+    const DecisionTreeNode N,
+    unsigned int *leaf_index,
+    const unsigned int depth
+) {
+    const struct node *data = (struct node *) N->data;
+
+    if (data->type != DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        write_indentation(stream, depth);
+        fprintf(stream, "leaves[n++] = %u;\n", *leaf_index);
+        ++*leaf_index;
+        return;
+    }
+
+    write_indentation(stream, depth);
+    fprintf(stream, "if (b[%u] <= ", 2 * data->data.univariate_linear_split.i);
+    write_value(stream, data->data.univariate_linear_split.k_up);
+    fprintf(stream, ") {\n");
+    write_reachable_node(stream, N->left_child, leaf_index, depth + 1);
+    write_indentation(stream, depth);
+    fprintf(stream, "}\n");
+    write_indentation(stream, depth);
+    fprintf(stream, "if (b[%u] > ", 2 * data->data.univariate_linear_split.i + 1);
+    write_value(stream, data->data.univariate_linear_split.k);
+    fprintf(stream, ") {\n");
+    write_reachable_node(stream, N->right_child, leaf_index, depth + 1);
+    write_indentation(stream, depth);
+    fprintf(stream, "}\n");
+}
+
+
+
+/**
+ * Writes combination of trees.
+ *
+ * Mirrors the voting schemes of #forest_compute_decision_function,
+ * performing the same floating point operations in the same order.
+ *
+ * @param[out] stream Stream
+ */
+static void write_decision_function(FILE *stream) {
+    fprintf(stream, "void " FOREST_C_DECISION_FUNCTION "(double *scores, const double *x, const int voting_scheme) {\n");
+    fprintf(stream, "    unsigned int i, j;\n\n");
+    fprintf(stream, "    for (j = 0; j < N_LABELS; ++j) {\n");
+    fprintf(stream, "        scores[j] = 0.0;\n");
+    fprintf(stream, "    }\n\n");
+    fprintf(stream, "    for (i = 0; i < N_TREES; ++i) {\n");
+    fprintf(stream, "        const double *s = trees[i](x);\n");
+    fprintf(stream, "        double max = s[0];\n\n");
+    fprintf(stream, "        switch (voting_scheme) {\n");
+    fprintf(stream, "        case %d:\n", FOREST_VOTING_MAX);
+    fprintf(stream, "            for (j = 1; j < N_LABELS; ++j) {\n");
+    fprintf(stream, "                if (s[j] > max) {\n");
+    fprintf(stream, "                    max = s[j];\n");
+    fprintf(stream, "                }\n");
+    fprintf(stream, "            }\n");
+    fprintf(stream, "            for (j = 0; j < N_LABELS; ++j) {\n");
+    fprintf(stream, "                if (s[j] == max) {\n");
+    fprintf(stream, "                    scores[j] += 1.0;\n");
+    fprintf(stream, "                }\n");
+    fprintf(stream, "            }\n");
+    fprintf(stream, "            break;\n\n");
+    fprintf(stream, "        case %d:\n", FOREST_VOTING_AVERAGE);
+    fprintf(stream, "            for (j = 0; j < N_LABELS; ++j) {\n");
+    fprintf(stream, "                scores[j] += s[j] / (double) N_TREES;\n");
+    fprintf(stream, "            }\n");
+    fprintf(stream, "            break;\n\n");
+    fprintf(stream, "        case %d:\n", FOREST_VOTING_SOFTARGMAX);
+    fprintf(stream, "            for (j = 0; j < N_LABELS; ++j) {\n");
+    fprintf(stream, "                scores[j] += s[j];\n");
+    fprintf(stream, "            }\n");
+    fprintf(stream, "            break;\n");
+    fprintf(stream, "        }\n");
+    fprintf(stream, "    }\n");
+    fprintf(stream, "}\n");
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+void forest_c_create(FILE *stream, const Forest F) {
+    const unsigned int n_trees = forest_get_n_trees(F),
+                       n_labels = forest_get_n_labels(F);
+    const DecisionTree *trees = forest_get_trees_as_array(F);
+    unsigned int i;
+
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot write file.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(stream, "/* Decision function generated by silva-compile. */\n");
+    fprintf(stream, "#include <math.h>\n\n");
+    fprintf(stream, "#define N_TREES %u\n", n_trees);
+    fprintf(stream, "#define N_LABELS %u\n\n", n_labels);
+    fprintf(stream, "const unsigned int " FOREST_C_N_TREES " = N_TREES;\n");
+    fprintf(stream, "const unsigned int " FOREST_C_N_LABELS " = N_LABELS;\n");
+    fprintf(stream, "const unsigned int " FOREST_C_SPACE_SIZE " = %u;\n", forest_get_feature_space_size(F));
+    fprintf(stream, "const unsigned long long " FOREST_C_HASH " = 0x%016llxULL;\n\n", forest_hash_structure(F));
+
+    for (i = 0; i < n_trees; ++i) {
+        fprintf(stream, "static const double *tree_%u(const double *x) {\n", i);
+        write_node(stream, decision_tree_get_root(trees[i]), n_labels, 1);
+        fprintf(stream, "}\n\n");
+    }
+
+    fprintf(stream, "static const double *(* const trees[N_TREES])(const double *) = {\n");
+    for (i = 0; i < n_trees; ++i) {
+        fprintf(stream, "    tree_%u%s\n", i, i + 1 < n_trees ? "," : "");
+    }
+    fprintf(stream, "};\n\n");
+
+    write_decision_function(stream);
+
+    for (i = 0; i < n_trees; ++i) {
+        unsigned int leaf_index = 0;
+        fprintf(stream, "\nstatic unsigned int reach_%u(unsigned int *leaves, const double *b) {\n", i);
+        fprintf(stream, "    unsigned int n = 0;\n");
+        write_reachable_node(stream, decision_tree_get_root(trees[i]), &leaf_index, 1);
+        fprintf(stream, "    return n;\n");
+        fprintf(stream, "}\n");
+    }
+
+    fprintf(stream, "\nstatic unsigned int (* const reach[N_TREES])(unsigned int *, const double *) = {\n");
+    for (i = 0; i < n_trees; ++i) {
+        fprintf(stream, "    reach_%u%s\n", i, i + 1 < n_trees ? "," : "");
+    }
+    fprintf(stream, "};\n\n");
+
+    fprintf(stream, "unsigned int " FOREST_C_REACHABLE_LEAVES "(unsigned int *leaves, const unsigned int tree, const double *bounds) {\n");
+    fprintf(stream, "    return reach[tree](leaves, bounds);\n");
+    fprintf(stream, "}\n");
+}
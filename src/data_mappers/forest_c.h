@@ -0,0 +1,55 @@
+/**
+ * Data mapper for a forest to C source code.
+ *
+ * @file forest_c.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef FOREST_C_H
+#define FOREST_C_H
+
+#include <stdio.h>
+
+#include "../forest.h"
+
+
+/** Name of the generated decision function. */
+#define FOREST_C_DECISION_FUNCTION "silva_decision_function"
+
+/** Name of the generated computation of reachable leaves. */
+#define FOREST_C_REACHABLE_LEAVES "silva_reachable_leaves"
+
+/** Name of the generated constant holding number of trees. */
+#define FOREST_C_N_TREES "silva_n_trees"
+
+/** Name of the generated constant holding number of labels. */
+#define FOREST_C_N_LABELS "silva_n_labels"
+
+/** Name of the generated constant holding size of the feature space. */
+#define FOREST_C_SPACE_SIZE "silva_space_size"
+
+/** Name of the generated constant holding the structure hash of the forest. */
+#define FOREST_C_HASH "silva_forest_hash"
+
+
+/**
+ * Creates C source code computing the decision function of a forest.
+ *
+ * Each tree is compiled into nested if statements, and a function having
+ * type #ForestDecisionFunction, named #FOREST_C_DECISION_FUNCTION,
+ * combines trees using the voting scheme given at runtime. Thresholds and
+ * scores are written in hexadecimal notation, so that compiled code
+ * returns exactly the scores computed by #forest_compute_decision_function.
+ *
+ * Each tree is also compiled into a function computing the leaves
+ * reachable from a box, and a function having type #ForestReachableLeaves,
+ * named #FOREST_C_REACHABLE_LEAVES, dispatches on the tree index.
+ *
+ * Leaves are referred to by position, thus the code is tied to the
+ * forest by its structure hash, named #FOREST_C_HASH.
+ *
+ * @param[out] stream Stream
+ * @param[in] F Forest
+ */
+void forest_c_create(FILE *stream, const Forest F);
+
+#endif
@@ -1,13 +1,24 @@
 /**
  * Data mapper for a random forest to file system.
  *
+ * Trees are located by a quick scan of the model text, which is memory
+ * mapped when it comes from a regular file, and then parsed concurrently
+ * by a pool of threads.
+ *
  * @file forest_silva.c
  * @author Marco Zanella <marco.zanella.1991@gmail.com>
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include "forest_silva.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "decision_tree_silva.h"
 
@@ -15,6 +26,12 @@
 /** Size of read buffer. */
 #define BUFFER_SIZE 32
 
+/** Minimum number of trees given to each parsing thread. */
+#define TREES_PER_THREAD 16
+
+/** Keyword opening a decision tree. */
+#define TREE_KEYWORD "classifier-decision-tree"
+
 
 /** Stringifier - part 2. */
 #define STR2(x) #x
@@ -23,13 +40,138 @@
 #define STR(x) STR2(x)
 
 
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/** Structure of a parsing job shared by threads. */
+struct job {
+    DecisionTree *trees;       /**< Trees to parse. */
+    const char **starts;       /**< Start of each tree, plus end of text. */
+    unsigned int n_trees;      /**< Number of trees. */
+    unsigned int next_tree;    /**< Next tree to parse, updated atomically. */
+};
+
+/** Type of a parsing job. */
+typedef struct job Job;
+
+
+
+/**
+ * Parses trees until none is left.
+ *
+ * @param[in,out] argument Pointer to a job
+ * @return NULL
+ */
+static void *parse_trees(void *argument) {
+    Job *job = (Job *) argument;
+    unsigned int i;
+
+    while ((i = __sync_fetch_and_add(&job->next_tree, 1)) < job->n_trees) {
+        decision_tree_silva_parse(
+            job->trees + i,
+            job->starts[i],
+            job->starts[i + 1] - job->starts[i]
+        );
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * Locates trees in text.
+ *
+ * A tree starts at each occurrence of #TREE_KEYWORD as a whole token.
+ *
+ * @param[out] starts Start of each tree, plus end of text
+ * @param[in] n_trees Expected number of trees
+ * @param[in] text Text
+ * @param[in] size Size of text
+ */
+static void locate_trees(
+    const char **starts,
+    const unsigned int n_trees,
+    const char *text,
+    const size_t size
+) {
+    const size_t length = strlen(TREE_KEYWORD);
+    const char *p = text, *end = text + size;
+    unsigned int n = 0;
+
+    while (p < end) {
+        while (p < end && isspace((unsigned char) *p)) {
+            ++p;
+        }
+        if ((size_t) (end - p) >= length && memcmp(p, TREE_KEYWORD, length) == 0
+            && (p + length == end || isspace((unsigned char) p[length]))) {
+            if (n == n_trees) {
+                break;
+            }
+            starts[n++] = p;
+        }
+        while (p < end && !isspace((unsigned char) *p)) {
+            ++p;
+        }
+    }
+
+    if (n != n_trees || p < end) {
+        fprintf(stderr, "[%s: %d] Cannot parse random forest.\n", __FILE__, __LINE__);
+        abort();
+    }
+    starts[n_trees] = end;
+}
+
+
+
+/**
+ * Reads the rest of a stream into memory.
+ *
+ * @param[out] size Size of text
+ * @param[in,out] stream Stream
+ * @return Text, to be freed by the caller
+ */
+static char *read_rest(size_t *size, FILE *stream) {
+    size_t capacity = 4096, n;
+    char *text = (char *) malloc(capacity * sizeof(char));
+
+    *size = 0;
+    while (text != NULL && (n = fread(text + *size, sizeof(char), capacity - *size, stream)) > 0) {
+        *size += n;
+        if (*size == capacity) {
+            capacity *= 2;
+            text = (char *) realloc(text, capacity * sizeof(char));
+        }
+    }
+    if (text == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return text;
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
 void forest_silva_read(
     Forest *F,
     FILE *stream
 ) {
-    unsigned int n_trees, i, n;
-    char buffer[BUFFER_SIZE];
-    DecisionTree *trees;
+    unsigned int n_trees, i, n, n_threads;
+    char buffer[BUFFER_SIZE], *text, *mapping = NULL;
+    const char **starts;
+    size_t size, mapping_size = 0;
+    long offset;
+    long n_processors;
+    struct stat status;
+    pthread_t *threads;
+    Job job;
 
     if (!stream) {
         fprintf(stderr, "[%s: %d] Cannot read file.\n", __FILE__, __LINE__);
@@ -42,9 +184,69 @@ void forest_silva_read(
         abort();
     }
 
+
+    /* Maps model file if possible, reads it otherwise */
+    offset = ftell(stream);
+    if (offset >= 0 && fstat(fileno(stream), &status) == 0
+        && S_ISREG(status.st_mode) && status.st_size > offset) {
+        mapping_size = (size_t) status.st_size;
+        mapping = (char *) mmap(NULL, mapping_size, PROT_READ, MAP_PRIVATE, fileno(stream), 0);
+        if (mapping == MAP_FAILED) {
+            mapping = NULL;
+        }
+    }
+    if (mapping != NULL) {
+        text = mapping + offset;
+        size = mapping_size - (size_t) offset;
+        fseek(stream, 0, SEEK_END);
+    }
+    else {
+        text = read_rest(&size, stream);
+    }
+
+
+    /* Locates trees */
+    starts = (const char **) malloc((n_trees + 1) * sizeof(const char *));
+    if (starts == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    locate_trees(starts, n_trees, text, size);
+
+
+    /* Parses trees concurrently, calling thread included */
     forest_create(F, n_trees, FOREST_VOTING_MAX);
-    trees = forest_get_trees_as_array(*F);
-    for (i = 0; i < n_trees; ++i) {
-        decision_tree_silva_read(trees + i, stream);
+    job.trees = forest_get_trees_as_array(*F);
+    job.starts = starts;
+    job.n_trees = n_trees;
+    job.next_tree = 0;
+
+    n_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    n_threads = (n_trees + TREES_PER_THREAD - 1) / TREES_PER_THREAD;
+    if (n_processors > 0 && n_threads > (unsigned int) n_processors) {
+        n_threads = (unsigned int) n_processors;
+    }
+
+    threads = (pthread_t *) malloc(n_threads * sizeof(pthread_t));
+    for (i = 0; threads != NULL && i + 1 < n_threads; ++i) {
+        if (pthread_create(threads + i, NULL, parse_trees, &job) != 0) {
+            break;
+        }
+    }
+    parse_trees(&job);
+    n_threads = i;
+    for (i = 0; i < n_threads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+
+    /* Deallocates memory */
+    free(threads);
+    free(starts);
+    if (mapping != NULL) {
+        munmap(mapping, mapping_size);
+    }
+    else {
+        free(text);
     }
 }
@@ -16,13 +16,45 @@
 /** Size of buffer. */
 #define LABEL_BUFFER_SIZE 32
 
+/** Initial capacity of the table of labels. */
+#define LABEL_TABLE_INITIAL_CAPACITY 8
+
+/** Maximum number of distinct values of a dictionary-encoded column. */
+#define DICTIONARY_MAX_SIZE 65536
+
+/** Maximum number of bits of a bit-packed integer. */
+#define PACKED_MAX_WIDTH 16
+
+/** Number of values decoded at once. */
+#define DECODE_BLOCK_SIZE 4096
+
+
+/** Encodings of columns in compressed format. */
+typedef enum {
+    COLUMN_RAW,        /**< One double per row. */
+    COLUMN_DICTIONARY  /**< Sorted distinct values, then bit-packed index of
+                            the value of each row. */
+} ColumnEncoding;
+
+
+/** Type of the identifier of a label. */
+typedef unsigned short LabelId;
+
 
 /** Structure of a dataset. */
 struct dataset {
     unsigned int size;        /**< Number of samples. */
     unsigned int space_size;  /**< Size of the feature space. */
-    double *data;               /**< Features (row major matrix). */
-    char *labels;             /**< Labels. */
+    Storage *data;            /**< Features (row major matrix). */
+    Storage *columns;         /**< Copy of features (column major matrix),
+                                   NULL if not created. */
+    Storage **column_array;   /**< Pointers to columns, NULL if not
+                                   created. */
+    LabelId *label_ids;       /**< Identifier of the label of each sample. */
+    char **labels;            /**< Table of distinct labels, indexed by
+                                   identifier. */
+    unsigned int n_labels;    /**< Number of distinct labels. */
+    unsigned int capacity;    /**< Capacity of the table of labels. */
 };
 
 
@@ -104,6 +136,254 @@ static void parse_header(
 
 
 
+/**
+ * Creates an empty dataset.
+ *
+ * @param[in] n_rows Number of rows
+ * @param[in] n_cols Number of columns (excluding label)
+ * @return Dataset
+ */
+static Dataset dataset_create(const unsigned int n_rows, const unsigned int n_cols) {
+    Dataset dataset = (Dataset) malloc(sizeof(struct dataset));
+
+    if (!dataset) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    dataset->size = n_rows;
+    dataset->space_size = n_cols;
+    dataset->data = (Storage *) malloc(n_rows * n_cols * sizeof(Storage));
+    dataset->columns = NULL;
+    dataset->column_array = NULL;
+    dataset->label_ids = (LabelId *) malloc(n_rows * sizeof(LabelId));
+    dataset->labels = (char **) malloc(LABEL_TABLE_INITIAL_CAPACITY * sizeof(char *));
+    dataset->n_labels = 0;
+    dataset->capacity = LABEL_TABLE_INITIAL_CAPACITY;
+    if ((n_rows > 0 && (!dataset->data || !dataset->label_ids)) || !dataset->labels) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return dataset;
+}
+
+
+
+/**
+ * Returns identifier of a label, adding it to the table of labels if
+ * missing.
+ *
+ * @param[in,out] dataset Dataset
+ * @param[in] label Label
+ * @return Identifier of label
+ */
+static LabelId intern_label(Dataset dataset, const char *label) {
+    unsigned int i;
+
+    for (i = 0; i < dataset->n_labels; ++i) {
+        if (strcmp(dataset->labels[i], label) == 0) {
+            return (LabelId) i;
+        }
+    }
+
+    if (dataset->n_labels > (LabelId) -1) {
+        fprintf(stderr, "[%s: %d] Too many distinct labels.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (dataset->n_labels == dataset->capacity) {
+        dataset->capacity *= 2;
+        dataset->labels = (char **) realloc(dataset->labels, dataset->capacity * sizeof(char *));
+        if (!dataset->labels) {
+            fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+    dataset->labels[i] = (char *) malloc((strlen(label) + 1) * sizeof(char));
+    if (!dataset->labels[i]) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    strcpy(dataset->labels[i], label);
+    ++dataset->n_labels;
+
+    return (LabelId) i;
+}
+
+
+
+/**
+ * Reads a table of labels: number of labels, then one label per line.
+ *
+ * @param[in,out] dataset Dataset
+ * @param[in,out] stream Stream
+ */
+static void read_label_table(Dataset dataset, FILE *stream) {
+    char label[LABEL_BUFFER_SIZE];
+    unsigned int i, n_labels;
+
+    if (fscanf(stream, "%u", &n_labels) != 1) {
+        fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+        abort();
+    }
+    for (i = 0; i < n_labels; ++i) {
+        if (fgetc(stream) != '\n' || fscanf(stream, "%31[^\n]", label) != 1) {
+            fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+            abort();
+        }
+        intern_label(dataset, label);
+    }
+    if (fgetc(stream) != '\n' || dataset->n_labels != n_labels) {
+        fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Writes a table of labels: number of labels, then one label per line.
+ *
+ * @param[in] dataset Dataset
+ * @param[in,out] stream Stream
+ */
+static void write_label_table(const Dataset dataset, FILE *stream) {
+    unsigned int i;
+
+    fprintf(stream, "%u\n", dataset->n_labels);
+    for (i = 0; i < dataset->n_labels; ++i) {
+        fprintf(stream, "%s\n", dataset->labels[i]);
+    }
+}
+
+
+
+/**
+ * Returns number of bits needed to store integers from 0 to n - 1.
+ *
+ * @param[in] n Number of distinct integers
+ * @return Number of bits
+ */
+static unsigned int bit_width(const unsigned int n) {
+    unsigned int width = 0;
+
+    while (width < 32 && (n - 1) >> width) {
+        ++width;
+    }
+
+    return n > 1 ? width : 0;
+}
+
+
+
+/**
+ * Returns number of bytes storing n bit-packed integers.
+ *
+ * @param[in] n Number of integers
+ * @param[in] width Number of bits of each integer
+ * @return Number of bytes
+ */
+static size_t packed_size(const unsigned int n, const unsigned int width) {
+    return ((size_t) n * width + 7) / 8;
+}
+
+
+
+/**
+ * Packs integers, least significant bits first.
+ *
+ * @param[out] packed Packed integers, of #packed_size bytes
+ * @param[in] values Integers to pack, each fitting width bits
+ * @param[in] n Number of integers
+ * @param[in] width Number of bits of each integer, at most 32
+ */
+static void pack(
+    unsigned char *packed,
+    const unsigned int *values,
+    const unsigned int n,
+    const unsigned int width
+) {
+    unsigned long long buffer = 0;
+    unsigned int i, n_bits = 0;
+    size_t k = 0;
+
+    for (i = 0; i < n; ++i) {
+        buffer |= (unsigned long long) values[i] << n_bits;
+        n_bits += width;
+        while (n_bits >= 8) {
+            packed[k++] = (unsigned char) buffer;
+            buffer >>= 8;
+            n_bits -= 8;
+        }
+    }
+    if (n_bits > 0) {
+        packed[k] = (unsigned char) buffer;
+    }
+}
+
+
+
+/**
+ * Unpacks a block of integers packed by #pack.
+ *
+ * @param[out] values Unpacked integers
+ * @param[in] packed Packed integers
+ * @param[in] first Index of first integer to unpack
+ * @param[in] n Number of integers to unpack
+ * @param[in] width Number of bits of each integer, at most 32
+ */
+static void unpack(
+    unsigned int *values,
+    const unsigned char *packed,
+    const unsigned int first,
+    const unsigned int n,
+    const unsigned int width
+) {
+    const unsigned long long mask = (1ULL << width) - 1;
+    const size_t first_bit = (size_t) first * width;
+    unsigned long long buffer = 0;
+    unsigned int i, n_bits = 0;
+    size_t k = first_bit / 8;
+
+    if (width == 0 || n == 0) {
+        memset(values, 0, n * sizeof(unsigned int));
+        return;
+    }
+
+    buffer = packed[k++] >> (first_bit % 8);
+    n_bits = 8 - first_bit % 8;
+    for (i = 0; i < n; ++i) {
+        while (n_bits < width) {
+            buffer |= (unsigned long long) packed[k++] << n_bits;
+            n_bits += 8;
+        }
+        values[i] = (unsigned int) (buffer & mask);
+        buffer >>= width;
+        n_bits -= width;
+    }
+}
+
+
+
+/**
+ * Compares two doubles, for sorting.
+ *
+ * @param[in] a Pointer to first double
+ * @param[in] b Pointer to second double
+ * @return Negative, zero or positive value if a is less than, equal to or
+ *         greater than b; -0 and +0 are distinct
+ */
+static int compare_values(const void *a, const void *b) {
+    const double x = *(const double *) a, y = *(const double *) b;
+
+    if (x != y) {
+        return x < y ? -1 : 1;
+    }
+    return memcmp(&x, &y, sizeof(double));
+}
+
+
+
 /**
  * Reads a dataset in CSV format.
  *
@@ -111,8 +391,8 @@ static void parse_header(
  * @return Dataset
  */
 static Dataset dataset_read_csv(FILE *stream) {
-    char *labels;
-    double *data;
+    char label[LABEL_BUFFER_SIZE];
+    Storage *data;
     Dataset dataset;
     unsigned int n_cols, n_rows, i, j, result;
     DatasetFormat format;
@@ -120,33 +400,25 @@ static Dataset dataset_read_csv(FILE *stream) {
 
     parse_header(&format, &n_rows, &n_cols, stream);
 
-    labels = (char *) malloc(LABEL_BUFFER_SIZE * n_rows * sizeof(char));
-    data = (double *) malloc(n_rows * n_cols * sizeof(double));
+    dataset = dataset_create(n_rows, n_cols);
+    data = dataset->data;
 
     for (i = 0; i < n_rows; ++i) {
         double buffer;
-        memset(labels + i * LABEL_BUFFER_SIZE, 0, LABEL_BUFFER_SIZE * sizeof(char));
-        result = fscanf(stream, "\n%[^,],", labels + (i * LABEL_BUFFER_SIZE));
+        label[0] = '\0';
+        result = fscanf(stream, "\n%31[^,]", label);
+        result = fscanf(stream, "%*[^,]");
+        result = fscanf(stream, ",");
+        dataset->label_ids[i] = intern_label(dataset, label);
         for (j = 0; j < n_cols - 1; ++j) {
             result = fscanf(stream, "%lf,", &buffer);
-            data[i * n_cols + j] = buffer;
+            data[i * n_cols + j] = (Storage) buffer;
         }
 
         result = fscanf(stream, "%lf", &buffer);
-        data[i * n_cols + j] = buffer;
-    }
-
-    dataset = (Dataset) malloc(sizeof(struct dataset));
-    if (!dataset) {
-        fprintf(stderr, "[%s: %d] Cannot parse header.\n", __FILE__, __LINE__);
-        abort();
+        data[i * n_cols + j] = (Storage) buffer;
     }
 
-    dataset->size = n_rows;
-    dataset->space_size = n_cols;
-    dataset->data = data;
-    dataset->labels = labels;
-
     (void) result;
     return dataset;
 }
@@ -162,35 +434,218 @@ static Dataset dataset_read_csv(FILE *stream) {
 static Dataset dataset_read_binary(FILE *stream) {
     Dataset dataset;
     DatasetFormat format;
-    unsigned int i, n_rows, n_cols;
-    char *labels;
-    double *data;
+    unsigned int i, j, n_rows, n_cols;
+    char label[LABEL_BUFFER_SIZE + 1];
+    Storage *data;
+    double *buffer;
     size_t n_read;
 
     parse_header(&format, &n_rows, &n_cols, stream);
 
 
-    dataset = (Dataset) malloc(sizeof(struct dataset));
-    labels = (char *) malloc(LABEL_BUFFER_SIZE * n_rows * sizeof(char));
-    data = (double *) malloc(n_rows * n_cols * sizeof(double));
+    dataset = dataset_create(n_rows, n_cols);
+    data = dataset->data;
+    buffer = (double *) malloc(n_cols * sizeof(double));
 
+    label[LABEL_BUFFER_SIZE] = '\0';
     for (i = 0; i < n_rows; ++i) {
-        n_read = fread(labels + i * LABEL_BUFFER_SIZE, sizeof(char), LABEL_BUFFER_SIZE, stream);
+        n_read = fread(label, sizeof(char), LABEL_BUFFER_SIZE, stream);
         if (n_read != LABEL_BUFFER_SIZE) {
             fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
             abort();
         }
-        n_read = fread(data + i * n_cols, sizeof(double), n_cols, stream);
+        dataset->label_ids[i] = intern_label(dataset, label);
+        n_read = fread(buffer, sizeof(double), n_cols, stream);
         if (n_read != n_cols) {
             fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
             abort();
         }
+        for (j = 0; j < n_cols; ++j) {
+            data[i * n_cols + j] = (Storage) buffer[j];
+        }
     }
 
-    dataset->size = n_rows;
-    dataset->space_size = n_cols;
-    dataset->data = data;
-    dataset->labels = labels;
+    free(buffer);
+
+    return dataset;
+}
+
+
+
+/**
+ * Reads a dataset in encoded binary format.
+ *
+ * Header is followed by the number of distinct labels and by one label per
+ * line, then each row stores the identifier of its label (index in the
+ * table of labels) and its features.
+ *
+ * @param[in,out] stream Stream
+ * @return Dataset
+ */
+static Dataset dataset_read_binary_encoded(FILE *stream) {
+    Dataset dataset;
+    DatasetFormat format;
+    unsigned int i, j, n_rows, n_cols, n_labels;
+    Storage *data;
+    double *buffer;
+    size_t n_read;
+
+    parse_header(&format, &n_rows, &n_cols, stream);
+
+    dataset = dataset_create(n_rows, n_cols);
+    data = dataset->data;
+    buffer = (double *) malloc(n_cols * sizeof(double));
+
+    read_label_table(dataset, stream);
+    n_labels = dataset->n_labels;
+
+    for (i = 0; i < n_rows; ++i) {
+        n_read = fread(dataset->label_ids + i, sizeof(LabelId), 1, stream);
+        if (n_read != 1 || dataset->label_ids[i] >= n_labels) {
+            fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+            abort();
+        }
+        n_read = fread(buffer, sizeof(double), n_cols, stream);
+        if (n_read != n_cols) {
+            fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+            abort();
+        }
+        for (j = 0; j < n_cols; ++j) {
+            data[i * n_cols + j] = (Storage) buffer[j];
+        }
+    }
+
+    free(buffer);
+
+    return dataset;
+}
+
+
+
+/**
+ * Reads n bit-packed integers of given width.
+ *
+ * @param[out] packed Packed integers
+ * @param[in] n Number of integers
+ * @param[in,out] stream Stream
+ * @return Number of bits of each integer
+ */
+static unsigned int read_packed(unsigned char *packed, const unsigned int n, FILE *stream) {
+    unsigned char width;
+
+    if (fread(&width, sizeof(unsigned char), 1, stream) != 1
+        || width > PACKED_MAX_WIDTH
+        || fread(packed, sizeof(unsigned char), packed_size(n, width), stream) != packed_size(n, width)) {
+        fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return width;
+}
+
+
+
+/**
+ * Reads a dataset in compressed format.
+ *
+ * Header is followed by a table of labels, as in encoded binary format,
+ * then by bit-packed identifiers of labels and by each column, either raw
+ * or dictionary-encoded. Columns are decoded by blocks.
+ *
+ * @param[in,out] stream Stream
+ * @return Dataset
+ */
+static Dataset dataset_read_compressed(FILE *stream) {
+    Dataset dataset;
+    DatasetFormat format;
+    unsigned int i, j, k, n, n_rows, n_cols, n_values, width;
+    unsigned char encoding;
+    Storage *data;
+    double *values = (double *) malloc(DECODE_BLOCK_SIZE * sizeof(double)),
+           *dictionary = (double *) malloc(DICTIONARY_MAX_SIZE * sizeof(double));
+    unsigned int *indices = (unsigned int *) malloc(DECODE_BLOCK_SIZE * sizeof(unsigned int));
+    unsigned char *packed;
+
+    parse_header(&format, &n_rows, &n_cols, stream);
+
+    dataset = dataset_create(n_rows, n_cols);
+    data = dataset->data;
+    packed = (unsigned char *) malloc(packed_size(n_rows, PACKED_MAX_WIDTH) + 1);
+    if (values == NULL || dictionary == NULL || indices == NULL || packed == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    read_label_table(dataset, stream);
+
+
+    /* Reads labels */
+    width = read_packed(packed, n_rows, stream);
+    for (i = 0; i < n_rows; i += n) {
+        n = n_rows - i < DECODE_BLOCK_SIZE ? n_rows - i : DECODE_BLOCK_SIZE;
+        unpack(indices, packed, i, n, width);
+        for (k = 0; k < n; ++k) {
+            if (indices[k] >= dataset->n_labels) {
+                fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+                abort();
+            }
+            dataset->label_ids[i + k] = (LabelId) indices[k];
+        }
+    }
+
+
+    /* Reads columns */
+    for (j = 0; j < n_cols; ++j) {
+        if (fread(&encoding, sizeof(unsigned char), 1, stream) != 1) {
+            fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+            abort();
+        }
+
+        switch (encoding) {
+        case COLUMN_RAW:
+            for (i = 0; i < n_rows; i += n) {
+                n = n_rows - i < DECODE_BLOCK_SIZE ? n_rows - i : DECODE_BLOCK_SIZE;
+                if (fread(values, sizeof(double), n, stream) != n) {
+                    fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+                    abort();
+                }
+                for (k = 0; k < n; ++k) {
+                    data[(i + k) * n_cols + j] = (Storage) values[k];
+                }
+            }
+            break;
+
+        case COLUMN_DICTIONARY:
+            if (fread(&n_values, sizeof(unsigned int), 1, stream) != 1
+                || n_values > DICTIONARY_MAX_SIZE
+                || fread(dictionary, sizeof(double), n_values, stream) != n_values) {
+                fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+                abort();
+            }
+            width = read_packed(packed, n_rows, stream);
+            for (i = 0; i < n_rows; i += n) {
+                n = n_rows - i < DECODE_BLOCK_SIZE ? n_rows - i : DECODE_BLOCK_SIZE;
+                unpack(indices, packed, i, n, width);
+                for (k = 0; k < n; ++k) {
+                    if (indices[k] >= n_values) {
+                        fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+                        abort();
+                    }
+                    data[(i + k) * n_cols + j] = (Storage) dictionary[indices[k]];
+                }
+            }
+            break;
+
+        default:
+            fprintf(stderr, "[%s: %d] Cannot read dataset.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+
+    free(values);
+    free(dictionary);
+    free(indices);
+    free(packed);
 
     return dataset;
 }
@@ -200,6 +655,9 @@ static Dataset dataset_read_binary(FILE *stream) {
 /**
  * Writes a dataset in CSV format.
  *
+ * Values are written with 17 significant digits, so that reading them
+ * back gives the same stored values.
+ *
  * @param[in] dataset Dataset
  * @param[in,out] stream Stream
  * @return Dataset
@@ -211,9 +669,9 @@ static void dataset_write_csv(const Dataset dataset, FILE *stream) {
     fprintf(stream, "# %u %u %u\n", DATASET_CSV, dataset->size, dataset->space_size);
 
     for (i = 0; i < dataset->size; ++i) {
-        fprintf(stream, "%s", dataset->labels + i * LABEL_BUFFER_SIZE);
+        fprintf(stream, "%s", dataset->labels[dataset->label_ids[i]]);
         for (j = 0; j < space_size; ++j) {
-            fprintf(stream, ",%g", dataset->data[i * space_size + j]);
+            fprintf(stream, ",%.17g", (double) dataset->data[i * space_size + j]);
         }
         fprintf(stream, "\n");
     }
@@ -231,17 +689,175 @@ static void dataset_write_csv(const Dataset dataset, FILE *stream) {
 static void dataset_write_binary(const Dataset dataset, FILE *stream) {
     const unsigned int size = dataset->size,
                        space_size = dataset->space_size;
-    unsigned int i;
+    unsigned int i, j;
+    size_t length;
+    char label[LABEL_BUFFER_SIZE];
+    double *buffer = (double *) malloc(space_size * sizeof(double));
+
+    if (!buffer) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
 
     fprintf(stream, "# %u %u %u\n", DATASET_BINARY, size, space_size);
 
     for (i = 0; i < size; ++i) {
-        fwrite(dataset->labels + i * LABEL_BUFFER_SIZE, sizeof(char), LABEL_BUFFER_SIZE, stream);
-        fwrite(dataset->data + i * space_size, sizeof(double), space_size, stream);
+        for (j = 0; j < space_size; ++j) {
+            buffer[j] = dataset->data[i * space_size + j];
+        }
+        length = strlen(dataset->labels[dataset->label_ids[i]]);
+        memset(label, 0, LABEL_BUFFER_SIZE * sizeof(char));
+        memcpy(label, dataset->labels[dataset->label_ids[i]], length < LABEL_BUFFER_SIZE ? length : LABEL_BUFFER_SIZE);
+        fwrite(label, sizeof(char), LABEL_BUFFER_SIZE, stream);
+        fwrite(buffer, sizeof(double), space_size, stream);
     }
+
+    free(buffer);
 }
 
 
+
+/**
+ * Writes a dataset in encoded binary format.
+ *
+ * @param[in] dataset Dataset
+ * @param[in,out] stream Stream
+ */
+static void dataset_write_binary_encoded(const Dataset dataset, FILE *stream) {
+    const unsigned int size = dataset->size,
+                       space_size = dataset->space_size;
+    unsigned int i, j;
+    double *buffer = (double *) malloc(space_size * sizeof(double));
+
+    if (!buffer) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(stream, "# %u %u %u\n", DATASET_BINARY_ENCODED, size, space_size);
+    write_label_table(dataset, stream);
+
+    for (i = 0; i < size; ++i) {
+        for (j = 0; j < space_size; ++j) {
+            buffer[j] = dataset->data[i * space_size + j];
+        }
+        fwrite(dataset->label_ids + i, sizeof(LabelId), 1, stream);
+        fwrite(buffer, sizeof(double), space_size, stream);
+    }
+
+    free(buffer);
+}
+
+
+
+/**
+ * Writes n integers, bit-packed using the least width fitting them.
+ *
+ * @param[in] values Integers, from 0 to n_values - 1
+ * @param[in] n Number of integers
+ * @param[in] n_values Number of distinct integers
+ * @param[out] packed Buffer for packed integers
+ * @param[in,out] stream Stream
+ */
+static void write_packed(
+    const unsigned int *values,
+    const unsigned int n,
+    const unsigned int n_values,
+    unsigned char *packed,
+    FILE *stream
+) {
+    const unsigned char width = (unsigned char) bit_width(n_values);
+
+    pack(packed, values, n, width);
+    fwrite(&width, sizeof(unsigned char), 1, stream);
+    fwrite(packed, sizeof(unsigned char), packed_size(n, width), stream);
+}
+
+
+
+/**
+ * Writes a dataset in compressed format.
+ *
+ * Each column is dictionary-encoded when it has few enough distinct values
+ * to take less space than raw doubles, otherwise it is written raw.
+ *
+ * @param[in] dataset Dataset
+ * @param[in,out] stream Stream
+ */
+static void dataset_write_compressed(const Dataset dataset, FILE *stream) {
+    const unsigned int size = dataset->size,
+                       space_size = dataset->space_size;
+    unsigned int i, j, n_values, has_nan;
+    unsigned char encoding;
+    double *values = (double *) malloc(size * sizeof(double)),
+           *dictionary = (double *) malloc(size * sizeof(double));
+    unsigned int *indices = (unsigned int *) malloc(size * sizeof(unsigned int));
+    unsigned char *packed = (unsigned char *) malloc(packed_size(size, PACKED_MAX_WIDTH) + 1);
+
+    if (packed == NULL || (size > 0 && (values == NULL || dictionary == NULL || indices == NULL))) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(stream, "# %u %u %u\n", DATASET_COMPRESSED, size, space_size);
+    write_label_table(dataset, stream);
+
+    /* Writes labels */
+    for (i = 0; i < size; ++i) {
+        indices[i] = dataset->label_ids[i];
+    }
+    write_packed(indices, size, dataset->n_labels, packed, stream);
+
+    /* Writes columns */
+    for (j = 0; j < space_size; ++j) {
+        has_nan = 0;
+        for (i = 0; i < size; ++i) {
+            values[i] = dataset->data[i * space_size + j];
+            has_nan |= values[i] != values[i];
+        }
+
+        /* Collects distinct values */
+        n_values = 0;
+        if (!has_nan && size > 0) {
+            memcpy(dictionary, values, size * sizeof(double));
+            qsort(dictionary, size, sizeof(double), compare_values);
+            n_values = 1;
+            for (i = 1; i < size; ++i) {
+                if (compare_values(dictionary + i, dictionary + n_values - 1) != 0) {
+                    dictionary[n_values++] = dictionary[i];
+                }
+            }
+        }
+
+        encoding = !has_nan
+                   && n_values <= DICTIONARY_MAX_SIZE
+                   && n_values * sizeof(double) + sizeof(unsigned int) + 1 + packed_size(size, bit_width(n_values)) < size * sizeof(double)
+                 ? COLUMN_DICTIONARY
+                 : COLUMN_RAW;
+        fwrite(&encoding, sizeof(unsigned char), 1, stream);
+
+        if (encoding == COLUMN_RAW) {
+            fwrite(values, sizeof(double), size, stream);
+            continue;
+        }
+
+        for (i = 0; i < size; ++i) {
+            const double *value = (const double *) bsearch(values + i, dictionary, n_values, sizeof(double), compare_values);
+            indices[i] = (unsigned int) (value - dictionary);
+        }
+        fwrite(&n_values, sizeof(unsigned int), 1, stream);
+        fwrite(dictionary, sizeof(double), n_values, stream);
+        write_packed(indices, size, n_values, packed, stream);
+    }
+
+    free(values);
+    free(dictionary);
+    free(indices);
+    free(packed);
+}
+
+
+
 /***********************************************************************
  * Public functions.
  **********************************************************************/
@@ -266,6 +882,12 @@ Dataset dataset_read(FILE *stream) {
 
         case DATASET_BINARY:
             return dataset_read_binary(stream);
+
+        case DATASET_BINARY_ENCODED:
+            return dataset_read_binary_encoded(stream);
+
+        case DATASET_COMPRESSED:
+            return dataset_read_compressed(stream);
     }
 
     fprintf(stderr, "[%s: %d] Cannot read dataset file.\n", __FILE__, __LINE__);
@@ -282,25 +904,41 @@ void dataset_write(
     switch (format) {
         case DATASET_CSV:
             dataset_write_csv(dataset, stream);
-            break;
+            return;
 
         case DATASET_BINARY:
             dataset_write_binary(dataset, stream);
-            break;
+            return;
+
+        case DATASET_BINARY_ENCODED:
+            dataset_write_binary_encoded(dataset, stream);
+            return;
+
+        case DATASET_COMPRESSED:
+            dataset_write_compressed(dataset, stream);
+            return;
     }
 
-    fprintf(stderr, "[%s: %d] Unsupporteddataset format.\n", __FILE__, __LINE__);
+    fprintf(stderr, "[%s: %d] Unsupported dataset format.\n", __FILE__, __LINE__);
     abort();
 }
 
 
 
 void dataset_delete(Dataset *dataset) {
+    unsigned int i;
+
     if (dataset == NULL || *dataset == NULL) {
         return;
     }
 
+    for (i = 0; i < (*dataset)->n_labels; ++i) {
+        free((*dataset)->labels[i]);
+    }
     free((*dataset)->data);
+    free((*dataset)->columns);
+    free((*dataset)->column_array);
+    free((*dataset)->label_ids);
     free((*dataset)->labels);
     free(*dataset);
     *dataset = NULL;
@@ -317,11 +955,76 @@ unsigned int dataset_get_space_size(const Dataset dataset) {
 }
 
 
-double *dataset_get_row(const Dataset dataset, const unsigned int i) {
+Storage *dataset_get_row(const Dataset dataset, const unsigned int i) {
     return dataset->data + i * dataset->space_size;
 }
 
 
+void dataset_create_columns(Dataset dataset) {
+    const unsigned int size = dataset->size,
+                       space_size = dataset->space_size;
+    unsigned int i, j;
+
+    if (dataset->columns != NULL) {
+        return;
+    }
+
+    dataset->columns = (Storage *) malloc(size * space_size * sizeof(Storage));
+    dataset->column_array = (Storage **) malloc(space_size * sizeof(Storage *));
+    if ((size * space_size > 0 && dataset->columns == NULL) || (space_size > 0 && dataset->column_array == NULL)) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (j = 0; j < space_size; ++j) {
+        dataset->column_array[j] = dataset->columns + j * size;
+        for (i = 0; i < size; ++i) {
+            dataset->column_array[j][i] = dataset->data[i * space_size + j];
+        }
+    }
+}
+
+
+unsigned int dataset_has_columns(const Dataset dataset) {
+    return dataset->columns != NULL;
+}
+
+
+Storage *dataset_get_column(const Dataset dataset, const unsigned int j) {
+    if (dataset->columns == NULL) {
+        fprintf(stderr, "[%s: %d] Column-major layout was not created.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return dataset->column_array[j];
+}
+
+
+Storage **dataset_get_columns_as_array(const Dataset dataset) {
+    if (dataset->columns == NULL) {
+        fprintf(stderr, "[%s: %d] Column-major layout was not created.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return dataset->column_array;
+}
+
+
 char *dataset_get_label(const Dataset dataset, const unsigned int i) {
-    return dataset->labels + i * LABEL_BUFFER_SIZE;
+    return dataset->labels[dataset->label_ids[i]];
+}
+
+
+unsigned int dataset_get_label_id(const Dataset dataset, const unsigned int i) {
+    return dataset->label_ids[i];
+}
+
+
+unsigned int dataset_get_n_labels(const Dataset dataset) {
+    return dataset->n_labels;
+}
+
+
+char **dataset_get_labels_as_array(const Dataset dataset) {
+    return dataset->labels;
 }
@@ -11,14 +11,21 @@
 
 #include <stdio.h>
 
+#include "type.h"
+
 /** Type of a dataset. */
 typedef struct dataset *Dataset;
 
 
 /** Types of dataset formats. */
 typedef enum {
-    DATASET_CSV,    /**< CSV dataset: \f$ \langle y, x_1, x_2, \ldots, x_n \rangle \f$. */
-    DATASET_BINARY  /**< Binary format: \f$ \langle y, x_1, x_2, \ldots, x_n \rangle \f$. */
+    DATASET_CSV,            /**< CSV dataset: \f$ \langle y, x_1, x_2, \ldots, x_n \rangle \f$. */
+    DATASET_BINARY,         /**< Binary format: \f$ \langle y, x_1, x_2, \ldots, x_n \rangle \f$. */
+    DATASET_BINARY_ENCODED, /**< Binary format with a table of labels, storing
+                                 the index of label \f$ y \f$ in each row. */
+    DATASET_COMPRESSED      /**< Compressed binary format, storing labels and
+                                 each feature column bit-packed over a
+                                 dictionary of values, when smaller. */
 } DatasetFormat;
 
 
@@ -26,7 +33,9 @@ typedef enum {
 /**
  * Reads a dataset from a source.
  *
- * Recognizes automatically the format of the file.
+ * Recognizes automatically the format of the file. Features are
+ * rounded to the nearest #Storage value, hence, with single-precision
+ * storage, entries may differ from the values in the source.
  * 
  * @param[in,out] stream Source to read from
  * @return Dataset read from source
@@ -81,7 +90,51 @@ unsigned int dataset_get_space_size(const Dataset dataset);
  * @param[in] i       Index of entry to read
  * @return Pointer to data of i-esim entry
  */
-double *dataset_get_row(const Dataset dataset, const unsigned int i);
+Storage *dataset_get_row(const Dataset dataset, const unsigned int i);
+
+
+/**
+ * Creates a column-major copy of features of given dataset, which is kept
+ * along with the row-major one until the dataset is deleted.
+ *
+ * Rows i, i + 1, ..., i + n - 1 form a contiguous block both in the row-major
+ * layout, starting from #dataset_get_row, and in each column, starting from
+ * position i.
+ *
+ * @param[in,out] dataset Dataset
+ * @note Does nothing if the copy already exists.
+ */
+void dataset_create_columns(Dataset dataset);
+
+
+/**
+ * Tells whether given dataset has a column-major copy of its features.
+ *
+ * @param[in] dataset Dataset
+ * @return 1 if column-major copy exists, 0 otherwise
+ */
+unsigned int dataset_has_columns(const Dataset dataset);
+
+
+/**
+ * Returns values of j-esim feature of all entries of given dataset.
+ *
+ * @param[in] dataset Dataset
+ * @param[in] j       Index of feature
+ * @return Pointer to j-esim column
+ * @warning #dataset_create_columns must be called first.
+ */
+Storage *dataset_get_column(const Dataset dataset, const unsigned int j);
+
+
+/**
+ * Returns all columns of given dataset, indexed by feature.
+ *
+ * @param[in] dataset Dataset
+ * @return Array of columns
+ * @warning #dataset_create_columns must be called first.
+ */
+Storage **dataset_get_columns_as_array(const Dataset dataset);
 
 
 /**
@@ -93,4 +146,33 @@ double *dataset_get_row(const Dataset dataset, const unsigned int i);
  */
 char *dataset_get_label(const Dataset dataset, const unsigned int i);
 
+
+/**
+ * Returns identifier of the label of i-esim entry of given dataset, that is
+ * index of the label in the table of labels.
+ *
+ * @param[in] dataset Dataset
+ * @param[in] i       Index of entry to read
+ * @return Identifier of label of i-esim entry
+ */
+unsigned int dataset_get_label_id(const Dataset dataset, const unsigned int i);
+
+
+/**
+ * Returns number of distinct labels in given dataset.
+ *
+ * @param[in] dataset Dataset
+ * @return Number of distinct labels
+ */
+unsigned int dataset_get_n_labels(const Dataset dataset);
+
+
+/**
+ * Returns table of distinct labels of given dataset, indexed by identifier.
+ *
+ * @param[in] dataset Dataset
+ * @return Table of labels
+ */
+char **dataset_get_labels_as_array(const Dataset dataset);
+
 #endif
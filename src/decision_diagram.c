@@ -0,0 +1,1545 @@
+/**
+ * Implements a decision diagram.
+ *
+ * Variables are pairs of a feature and one of its thresholds, ordered by
+ * feature and then by increasing threshold. Since \f$x_f \leq t_k\f$
+ * implies \f$x_f \leq t_j\f$ for every \f$j > k\f$, the left child of a
+ * node never tests its feature again: together with the ordering, this
+ * makes every path satisfiable, so that a traversal may check each node
+ * against the hyperrectangle alone, and visit each node at most once.
+ *
+ * Splits are bound to the variable of their downward-rounded threshold.
+ * When thresholds are stored in single precision, splits whose original
+ * thresholds differ may thus share a variable: the greatest of their
+ * upward-rounded thresholds is kept, and queries whose hyperrectangle
+ * reaches between the two rounded thresholds of a variable are
+ * inconclusive.
+ *
+ * Diagrams are built as algebraic decision diagrams, whose terminals hold
+ * the scores accumulated so far, adding trees one at a time; terminals
+ * are then replaced by the set of labels having maximum score.
+ *
+ * Diagrams are stored as a text header, "silva-diagram VERSION",
+ * followed by binary data: hash of the forest, voting scheme, size of the
+ * feature space, labels, variables, terminals and internal nodes.
+ *
+ * @file decision_diagram.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#include "decision_diagram.h"
+#include "hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+
+/** Version of the diagram format. */
+#define DIAGRAM_VERSION 2
+
+/** Variable of terminal nodes. */
+#define TERMINAL UINT_MAX
+
+/** Marker of an empty slot or of a missing node. */
+#define NONE UINT_MAX
+
+/** Number of entries of the operation cache. */
+#define CACHE_SIZE (1u << 18)
+
+/** Minimum number of nodes before garbage is collected. */
+#define MIN_COLLECTION_SIZE (1u << 16)
+
+
+/** Structure of a node of a decision diagram. */
+struct diagram_node {
+    unsigned int variable;  /**< Index of tested variable. */
+    unsigned int left;      /**< Child to follow if
+                                 \f$x_f \leq t\f$. */
+    unsigned int right;     /**< Child to follow otherwise. */
+};
+
+/** Type of a node of a decision diagram. */
+typedef struct diagram_node DiagramNode;
+
+
+/** Structure of a decision diagram. */
+struct decision_diagram {
+    unsigned long long forest_hash;   /**< Hash of the compiled forest. */
+    ForestVotingScheme voting_scheme; /**< Compiled voting scheme. */
+    unsigned int space_size;          /**< Size of the feature space. */
+    unsigned int n_labels;            /**< Number of labels. */
+    char **labels;                    /**< Array of labels. */
+    unsigned int n_variables;         /**< Number of variables. */
+    unsigned int *features;           /**< Feature of each variable. */
+    double *thresholds;               /**< Threshold of each variable. */
+    double *thresholds_up;            /**< Greatest upward-rounded
+                                           threshold of the splits of each
+                                           variable. */
+    unsigned int n_inexact;           /**< Number of variables whose
+                                           thresholds differ. */
+    unsigned int *inexact;            /**< Variables whose thresholds
+                                           differ. */
+    unsigned int n_terminals;         /**< Number of terminals. */
+    unsigned char *terminals;         /**< Labels of each terminal, one
+                                           flag per label. */
+    unsigned int n_nodes;             /**< Number of internal nodes. */
+    DiagramNode *nodes;               /**< Internal nodes, children first.
+                                           References below n_terminals
+                                           are terminals, the others are
+                                           internal nodes shifted by
+                                           n_terminals. */
+    unsigned int root;                /**< Reference to root. */
+
+    unsigned int *visits;             /**< Last query visiting each
+                                           internal node. */
+    unsigned int visit;               /**< Identifier of current query. */
+    unsigned char *sample_labels;     /**< Labels of the sample, one flag
+                                           per label. */
+    double *lower;                    /**< Lower bound of each feature
+                                           along current path. */
+    double *upper;                    /**< Upper bound of each feature
+                                           along current path. */
+    unsigned char *is_open;           /**< 1 if lower bound of a feature is
+                                           excluded, 0 otherwise. */
+};
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Allocates memory, aborting on failure.
+ *
+ * @param[in] size Number of bytes
+ * @return Allocated memory
+ */
+static void *allocate(const size_t size) {
+    void *p = malloc(size);
+
+    if (p == NULL && size > 0) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return p;
+}
+
+
+
+/**
+ * Reallocates memory, aborting on failure.
+ *
+ * @param[in] p Memory to reallocate
+ * @param[in] size Number of bytes
+ * @return Reallocated memory
+ */
+static void *reallocate(void *p, const size_t size) {
+    p = realloc(p, size);
+
+    if (p == NULL && size > 0) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return p;
+}
+
+
+
+/**
+ * Compares thresholds.
+ *
+ * @param[in] a First threshold
+ * @param[in] b Second threshold
+ * @return Negative, zero or positive value if a is less than, equal to
+ *         or greater than b
+ */
+static int compare_thresholds(const void *a, const void *b) {
+    const double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+
+/**
+ * Collects thresholds of a subtree, per feature.
+ *
+ * @param[in,out] thresholds Thresholds of each feature
+ * @param[in,out] n_thresholds Number of thresholds of each feature
+ * @param[in,out] capacities Capacity of each array of thresholds
+ * @param[in] N Root of subtree
+ */
+static void collect_thresholds(
+    double **thresholds,
+    unsigned int *n_thresholds,
+    unsigned int *capacities,
+    const DecisionTreeNode N
+) {
+    unsigned int f;
+
+    if (decision_tree_node_is_leaf(N)) {
+        return;
+    }
+
+    f = decision_tree_univariate_linear_split_get_index(N);
+    if (n_thresholds[f] == capacities[f]) {
+        capacities[f] = capacities[f] > 0 ? 2 * capacities[f] : 16;
+        thresholds[f] = (double *) reallocate(thresholds[f], capacities[f] * sizeof(double));
+    }
+    thresholds[f][n_thresholds[f]++] = decision_tree_univariate_linear_split_get_threshold(N);
+
+    collect_thresholds(thresholds, n_thresholds, capacities, decision_tree_univariate_linear_split_get_left_child(N));
+    collect_thresholds(thresholds, n_thresholds, capacities, decision_tree_univariate_linear_split_get_right_child(N));
+}
+
+
+
+/**
+ * Finds the variable of a split.
+ *
+ * @param[in] D Decision diagram
+ * @param[in] offsets Index of first variable of each feature
+ * @param[in] f Feature
+ * @param[in] threshold Threshold
+ * @return Index of variable
+ */
+static unsigned int find_variable(
+    const DecisionDiagram D,
+    const unsigned int *offsets,
+    const unsigned int f,
+    const double threshold
+) {
+    unsigned int low = offsets[f], high = offsets[f + 1];
+
+    while (high - low > 1) {
+        const unsigned int middle = low + (high - low) / 2;
+        if (D->thresholds[middle] <= threshold) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+
+
+/**
+ * Collects upward-rounded thresholds of a subtree into its variables.
+ *
+ * @param[in,out] D Decision diagram
+ * @param[in] offsets Index of first variable of each feature
+ * @param[in] N Root of the subtree
+ */
+static void collect_upper_thresholds(
+    DecisionDiagram D,
+    const unsigned int *offsets,
+    const DecisionTreeNode N
+) {
+    unsigned int variable;
+    double threshold;
+
+    if (decision_tree_node_is_leaf(N)) {
+        return;
+    }
+
+    variable = find_variable(
+        D,
+        offsets,
+        decision_tree_univariate_linear_split_get_index(N),
+        decision_tree_univariate_linear_split_get_threshold(N)
+    );
+    threshold = decision_tree_univariate_linear_split_get_upper_threshold(N);
+    if (threshold > D->thresholds_up[variable]) {
+        D->thresholds_up[variable] = threshold;
+    }
+
+    collect_upper_thresholds(D, offsets, decision_tree_univariate_linear_split_get_left_child(N));
+    collect_upper_thresholds(D, offsets, decision_tree_univariate_linear_split_get_right_child(N));
+}
+
+
+
+/**
+ * Creates variables of a diagram from thresholds of a forest.
+ *
+ * @param[in,out] D Decision diagram
+ * @param[out] offsets Index of first variable of each feature, plus the
+ *             number of variables
+ * @param[in] F Forest
+ */
+static void create_variables(DecisionDiagram D, unsigned int *offsets, const Forest F) {
+    const unsigned int space_size = D->space_size;
+    double **thresholds = (double **) allocate(space_size * sizeof(double *));
+    unsigned int *n_thresholds = (unsigned int *) allocate(space_size * sizeof(unsigned int)),
+                 *capacities = (unsigned int *) allocate(space_size * sizeof(unsigned int)),
+                 f, i, n;
+
+    for (f = 0; f < space_size; ++f) {
+        thresholds[f] = NULL;
+        n_thresholds[f] = 0;
+        capacities[f] = 0;
+    }
+    for (i = 0; i < forest_get_n_trees(F); ++i) {
+        collect_thresholds(thresholds, n_thresholds, capacities, decision_tree_get_root(forest_get_trees_as_array(F)[i]));
+    }
+
+    /* Sorts thresholds and removes duplicates */
+    D->n_variables = 0;
+    for (f = 0; f < space_size; ++f) {
+        qsort(thresholds[f], n_thresholds[f], sizeof(double), compare_thresholds);
+        for (i = 0, n = 0; i < n_thresholds[f]; ++i) {
+            if (n == 0 || thresholds[f][i] != thresholds[f][n - 1]) {
+                thresholds[f][n++] = thresholds[f][i];
+            }
+        }
+        n_thresholds[f] = n;
+        D->n_variables += n;
+    }
+
+    D->features = (unsigned int *) allocate(D->n_variables * sizeof(unsigned int));
+    D->thresholds = (double *) allocate(D->n_variables * sizeof(double));
+    D->thresholds_up = (double *) allocate(D->n_variables * sizeof(double));
+    for (f = 0, n = 0; f < space_size; ++f) {
+        offsets[f] = n;
+        for (i = 0; i < n_thresholds[f]; ++i, ++n) {
+            D->features[n] = f;
+            D->thresholds[n] = thresholds[f][i];
+            D->thresholds_up[n] = thresholds[f][i];
+        }
+        free(thresholds[f]);
+    }
+    offsets[space_size] = n;
+    for (i = 0; i < forest_get_n_trees(F); ++i) {
+        collect_upper_thresholds(D, offsets, decision_tree_get_root(forest_get_trees_as_array(F)[i]));
+    }
+
+    free(thresholds);
+    free(n_thresholds);
+    free(capacities);
+}
+
+
+
+/***********************************************************************
+ * Construction.
+ **********************************************************************/
+
+/** Operations stored in the cache. */
+enum operation {
+    OPERATION_NONE,  /**< Empty entry. */
+    OPERATION_ADD,   /**< Sum of scores of two diagrams. */
+    OPERATION_ITE    /**< If-then-else on a variable. */
+};
+
+
+/** Structure of a node under construction. */
+struct build_node {
+    unsigned int variable;  /**< Index of tested variable, #TERMINAL for
+                                 terminals. */
+    unsigned int left;      /**< Left child, index of scores for
+                                 terminals. */
+    unsigned int right;     /**< Right child, unused for terminals. */
+};
+
+/** Type of a node under construction. */
+typedef struct build_node BuildNode;
+
+
+/** Structure of an entry of the operation cache. */
+struct cache_entry {
+    unsigned int operation;  /**< Operation, #OPERATION_NONE if empty. */
+    unsigned int a;          /**< First operand. */
+    unsigned int b;          /**< Second operand. */
+    unsigned int c;          /**< Third operand. */
+    unsigned int result;     /**< Result. */
+};
+
+/** Type of an entry of the operation cache. */
+typedef struct cache_entry CacheEntry;
+
+
+/** Structure of the storage of nodes under construction. */
+struct store {
+    unsigned int n_labels;        /**< Number of labels. */
+    const unsigned int *features; /**< Feature of each variable. */
+    BuildNode *nodes;             /**< Nodes. */
+    unsigned int n_nodes;         /**< Number of nodes. */
+    unsigned int capacity;        /**< Capacity of nodes. */
+    double *scores;               /**< Scores of terminals. */
+    unsigned int n_scores;        /**< Number of stored terminal scores. */
+    unsigned int scores_capacity; /**< Capacity of scores, in terminals. */
+    unsigned int *table;          /**< Unique table, #NONE if empty. */
+    unsigned int table_size;      /**< Size of unique table, a power of 2. */
+    CacheEntry *cache;            /**< Operation cache. */
+    unsigned int budget;          /**< Maximum number of nodes. */
+    unsigned int is_over_budget;  /**< 1 if budget was exceeded. */
+};
+
+/** Type of the storage of nodes under construction. */
+typedef struct store Store;
+
+
+
+/**
+ * Clears the operation cache.
+ *
+ * @param[in,out] S Store
+ */
+static void store_clear_cache(Store *S) {
+    unsigned int i;
+
+    for (i = 0; i < CACHE_SIZE; ++i) {
+        S->cache[i].operation = OPERATION_NONE;
+    }
+}
+
+
+
+/**
+ * Creates an empty store.
+ *
+ * @param[out] S Store
+ * @param[in] n_labels Number of labels
+ * @param[in] features Feature of each variable
+ * @param[in] budget Maximum number of nodes
+ */
+static void store_create(
+    Store *S,
+    const unsigned int n_labels,
+    const unsigned int *features,
+    const unsigned int budget
+) {
+    unsigned int i;
+
+    S->n_labels = n_labels;
+    S->features = features;
+    S->capacity = 1024;
+    S->nodes = (BuildNode *) allocate(S->capacity * sizeof(BuildNode));
+    S->n_nodes = 0;
+    S->scores_capacity = 1024;
+    S->scores = (double *) allocate(S->scores_capacity * n_labels * sizeof(double));
+    S->n_scores = 0;
+    S->table_size = 2048;
+    S->table = (unsigned int *) allocate(S->table_size * sizeof(unsigned int));
+    for (i = 0; i < S->table_size; ++i) {
+        S->table[i] = NONE;
+    }
+    S->cache = (CacheEntry *) allocate(CACHE_SIZE * sizeof(CacheEntry));
+    store_clear_cache(S);
+    S->budget = budget;
+    S->is_over_budget = 0;
+}
+
+
+
+/**
+ * Deletes a store.
+ *
+ * @param[in,out] S Store
+ */
+static void store_delete(Store *S) {
+    free(S->nodes);
+    free(S->scores);
+    free(S->table);
+    free(S->cache);
+}
+
+
+
+/**
+ * Computes the hash of a node.
+ *
+ * @param[in] S Store
+ * @param[in] N Node
+ * @return Hash of node
+ */
+static unsigned long long store_hash(const Store *S, const BuildNode N) {
+    unsigned long long hash = HASH_OFFSET;
+
+    if (N.variable == TERMINAL) {
+        return hash_bytes(hash, S->scores + (size_t) N.left * S->n_labels, S->n_labels * sizeof(double));
+    }
+
+    hash = hash_bytes(hash, &N.variable, sizeof(unsigned int));
+    hash = hash_bytes(hash, &N.left, sizeof(unsigned int));
+    return hash_bytes(hash, &N.right, sizeof(unsigned int));
+}
+
+
+
+/**
+ * Tells whether a stored node is equal to a node.
+ *
+ * @param[in] S Store
+ * @param[in] i Index of stored node
+ * @param[in] N Node
+ * @return 1 if nodes are equal, 0 otherwise
+ */
+static unsigned int store_is_equal(const Store *S, const unsigned int i, const BuildNode N) {
+    const BuildNode M = S->nodes[i];
+
+    if (M.variable != N.variable) {
+        return 0;
+    }
+    if (N.variable == TERMINAL) {
+        return memcmp(
+            S->scores + (size_t) M.left * S->n_labels,
+            S->scores + (size_t) N.left * S->n_labels,
+            S->n_labels * sizeof(double)
+        ) == 0;
+    }
+
+    return M.left == N.left && M.right == N.right;
+}
+
+
+
+/**
+ * Inserts a stored node into the unique table.
+ *
+ * @param[in,out] S Store
+ * @param[in] i Index of stored node
+ */
+static void store_insert(Store *S, const unsigned int i) {
+    unsigned int slot = (unsigned int) store_hash(S, S->nodes[i]) & (S->table_size - 1);
+
+    while (S->table[slot] != NONE) {
+        slot = (slot + 1) & (S->table_size - 1);
+    }
+    S->table[slot] = i;
+}
+
+
+
+/**
+ * Rebuilds the unique table, doubling its size if necessary.
+ *
+ * @param[in,out] S Store
+ */
+static void store_rebuild_table(Store *S) {
+    unsigned int i;
+
+    while (2 * (S->n_nodes + 1) > S->table_size) {
+        S->table_size *= 2;
+    }
+    S->table = (unsigned int *) reallocate(S->table, S->table_size * sizeof(unsigned int));
+    for (i = 0; i < S->table_size; ++i) {
+        S->table[i] = NONE;
+    }
+    for (i = 0; i < S->n_nodes; ++i) {
+        store_insert(S, i);
+    }
+}
+
+
+
+/**
+ * Returns the node equal to a given one, adding it if missing.
+ *
+ * @param[in,out] S Store
+ * @param[in] N Node, whose scores are the last ones stored if terminal
+ * @return Index of node, meaningless if budget was exceeded
+ */
+static unsigned int store_find_or_add(Store *S, const BuildNode N) {
+    unsigned int slot = (unsigned int) store_hash(S, N) & (S->table_size - 1);
+
+    while (S->table[slot] != NONE) {
+        if (store_is_equal(S, S->table[slot], N)) {
+            if (N.variable == TERMINAL) {
+                --S->n_scores;
+            }
+            return S->table[slot];
+        }
+        slot = (slot + 1) & (S->table_size - 1);
+    }
+
+    if (S->n_nodes >= S->budget) {
+        S->is_over_budget = 1;
+        return 0;
+    }
+    if (S->n_nodes == S->capacity) {
+        S->capacity *= 2;
+        S->nodes = (BuildNode *) reallocate(S->nodes, S->capacity * sizeof(BuildNode));
+    }
+    S->nodes[S->n_nodes] = N;
+    ++S->n_nodes;
+    if (2 * (S->n_nodes + 1) > S->table_size) {
+        store_rebuild_table(S);
+    }
+    else {
+        S->table[slot] = S->n_nodes - 1;
+    }
+
+    return S->n_nodes - 1;
+}
+
+
+
+/**
+ * Returns room for the scores of the next terminal.
+ *
+ * @param[in,out] S Store
+ * @return Scores of the next terminal
+ * @warning Scores are valid until the next terminal is added.
+ */
+static double *store_next_scores(Store *S) {
+    if (S->n_scores == S->scores_capacity) {
+        S->scores_capacity *= 2;
+        S->scores = (double *) reallocate(S->scores, (size_t) S->scores_capacity * S->n_labels * sizeof(double));
+    }
+
+    return S->scores + (size_t) S->n_scores * S->n_labels;
+}
+
+
+
+/**
+ * Returns the terminal holding the scores given by #store_next_scores.
+ *
+ * @param[in,out] S Store
+ * @return Index of terminal
+ */
+static unsigned int store_terminal(Store *S) {
+    BuildNode N;
+
+    N.variable = TERMINAL;
+    N.left = S->n_scores;
+    N.right = 0;
+    ++S->n_scores;
+
+    return store_find_or_add(S, N);
+}
+
+
+
+/**
+ * Returns the node testing a variable.
+ *
+ * @param[in,out] S Store
+ * @param[in] variable Variable
+ * @param[in] left Child if variable holds
+ * @param[in] right Child otherwise
+ * @return Index of node
+ */
+static unsigned int store_node(
+    Store *S,
+    const unsigned int variable,
+    const unsigned int left,
+    const unsigned int right
+) {
+    BuildNode N;
+
+    if (left == right) {
+        return left;
+    }
+
+    N.variable = variable;
+    N.left = left;
+    N.right = right;
+
+    return store_find_or_add(S, N);
+}
+
+
+
+/**
+ * Looks an operation up in the cache.
+ *
+ * @param[in] S Store
+ * @param[in] operation Operation
+ * @param[in] a First operand
+ * @param[in] b Second operand
+ * @param[in] c Third operand
+ * @return Cached result, #NONE if missing
+ */
+static unsigned int store_lookup(
+    const Store *S,
+    const unsigned int operation,
+    const unsigned int a,
+    const unsigned int b,
+    const unsigned int c
+) {
+    const CacheEntry *E = S->cache + ((a * 2654435761u + b * 40503u + c * 9973u + operation) & (CACHE_SIZE - 1));
+
+    return E->operation == operation && E->a == a && E->b == b && E->c == c ? E->result : NONE;
+}
+
+
+
+/**
+ * Stores the result of an operation in the cache.
+ *
+ * @param[in,out] S Store
+ * @param[in] operation Operation
+ * @param[in] a First operand
+ * @param[in] b Second operand
+ * @param[in] c Third operand
+ * @param[in] result Result
+ */
+static void store_remember(
+    Store *S,
+    const unsigned int operation,
+    const unsigned int a,
+    const unsigned int b,
+    const unsigned int c,
+    const unsigned int result
+) {
+    CacheEntry *E = S->cache + ((a * 2654435761u + b * 40503u + c * 9973u + operation) & (CACHE_SIZE - 1));
+
+    E->operation = operation;
+    E->a = a;
+    E->b = b;
+    E->c = c;
+    E->result = result;
+}
+
+
+
+/**
+ * Restricts a diagram to the left branch of a variable, which is not
+ * greater than its top variable.
+ *
+ * Variables of the same feature with greater thresholds hold as well.
+ *
+ * @param[in] S Store
+ * @param[in] i Index of root of diagram
+ * @param[in] variable Variable
+ * @return Index of root of restricted diagram
+ */
+static unsigned int cofactor_left(const Store *S, const unsigned int i, const unsigned int variable) {
+    const BuildNode N = S->nodes[i];
+
+    if (N.variable == TERMINAL) {
+        return i;
+    }
+    if (N.variable == variable || S->features[N.variable] == S->features[variable]) {
+        return N.left;
+    }
+
+    return i;
+}
+
+
+
+/**
+ * Restricts a diagram to the right branch of a variable, which is not
+ * greater than its top variable.
+ *
+ * @param[in] S Store
+ * @param[in] i Index of root of diagram
+ * @param[in] variable Variable
+ * @return Index of root of restricted diagram
+ */
+static unsigned int cofactor_right(const Store *S, const unsigned int i, const unsigned int variable) {
+    const BuildNode N = S->nodes[i];
+
+    return N.variable == variable ? N.right : i;
+}
+
+
+
+/**
+ * Adds scores of two diagrams.
+ *
+ * @param[in,out] S Store
+ * @param[in] a Index of root of first diagram
+ * @param[in] b Index of root of second diagram
+ * @return Index of root of sum
+ */
+static unsigned int add(Store *S, const unsigned int a, const unsigned int b) {
+    const BuildNode A = S->nodes[a], B = S->nodes[b];
+    unsigned int variable, left, right, result, j;
+
+    if (S->is_over_budget) {
+        return 0;
+    }
+
+    /* Sums scores of terminals */
+    if (A.variable == TERMINAL && B.variable == TERMINAL) {
+        double *scores = store_next_scores(S);
+
+        for (j = 0; j < S->n_labels; ++j) {
+            scores[j] = S->scores[(size_t) A.left * S->n_labels + j] + S->scores[(size_t) B.left * S->n_labels + j];
+        }
+
+        return store_terminal(S);
+    }
+
+    result = store_lookup(S, OPERATION_ADD, a, b, 0);
+    if (result != NONE) {
+        return result;
+    }
+
+    variable = A.variable < B.variable ? A.variable : B.variable;
+    left = add(S, cofactor_left(S, a, variable), cofactor_left(S, b, variable));
+    right = add(S, cofactor_right(S, a, variable), cofactor_right(S, b, variable));
+    result = store_node(S, variable, left, right);
+    if (!S->is_over_budget) {
+        store_remember(S, OPERATION_ADD, a, b, 0, result);
+    }
+
+    return result;
+}
+
+
+
+/**
+ * Builds the diagram choosing between two diagrams on a variable.
+ *
+ * @param[in,out] S Store
+ * @param[in] variable Variable
+ * @param[in] l Index of root of diagram to choose if variable holds
+ * @param[in] r Index of root of diagram to choose otherwise
+ * @return Index of root of resulting diagram
+ */
+static unsigned int if_then_else(
+    Store *S,
+    const unsigned int variable,
+    const unsigned int l,
+    const unsigned int r
+) {
+    unsigned int top, left, right, result;
+
+    if (S->is_over_budget) {
+        return 0;
+    }
+    if (l == r) {
+        return l;
+    }
+
+    result = store_lookup(S, OPERATION_ITE, variable, l, r);
+    if (result != NONE) {
+        return result;
+    }
+
+    top = variable;
+    if (S->nodes[l].variable < top) {
+        top = S->nodes[l].variable;
+    }
+    if (S->nodes[r].variable < top) {
+        top = S->nodes[r].variable;
+    }
+
+    /* Variable comes first */
+    if (top == variable) {
+        left = cofactor_left(S, l, variable);
+        right = cofactor_right(S, r, variable);
+    }
+
+    /* A variable of the same feature comes first: it implies variable */
+    else if (S->features[top] == S->features[variable]) {
+        left = cofactor_left(S, l, top);
+        right = if_then_else(S, variable, cofactor_right(S, l, top), cofactor_right(S, r, top));
+    }
+
+    /* A variable of a previous feature comes first */
+    else {
+        left = if_then_else(S, variable, cofactor_left(S, l, top), cofactor_left(S, r, top));
+        right = if_then_else(S, variable, cofactor_right(S, l, top), cofactor_right(S, r, top));
+    }
+
+    result = store_node(S, top, left, right);
+    if (!S->is_over_budget) {
+        store_remember(S, OPERATION_ITE, variable, l, r, result);
+    }
+
+    return result;
+}
+
+
+
+/**
+ * Converts a subtree into a diagram of its contribution to forest scores.
+ *
+ * @param[in,out] S Store
+ * @param[in] D Decision diagram, holding variables
+ * @param[in] offsets Index of first variable of each feature
+ * @param[in] N Root of subtree
+ * @param[in] F Forest
+ * @param[in,out] scores Buffer of scores
+ * @return Index of root of diagram
+ */
+static unsigned int convert_subtree(
+    Store *S,
+    const DecisionDiagram D,
+    const unsigned int *offsets,
+    const DecisionTreeNode N,
+    const Forest F,
+    double *scores
+) {
+    const unsigned int n_labels = S->n_labels;
+    unsigned int j, variable, left, right;
+    double max;
+
+    if (S->is_over_budget) {
+        return 0;
+    }
+
+    if (decision_tree_node_is_leaf(N)) {
+        if (decision_tree_node_get_type(N) == DECISION_TREE_LEAF) {
+            decision_tree_node_get_probabilities(scores, N);
+        }
+        else {
+            decision_tree_node_get_scores_logarithmic(scores, N);
+        }
+
+        /* Computes contribution as the forest does */
+        switch (forest_get_voting_scheme(F)) {
+        case FOREST_VOTING_MAX:
+            max = scores[0];
+            for (j = 1; j < n_labels; ++j) {
+                if (scores[j] > max) {
+                    max = scores[j];
+                }
+            }
+            for (j = 0; j < n_labels; ++j) {
+                scores[j] = scores[j] == max ? 1.0 : 0.0;
+            }
+            break;
+
+        case FOREST_VOTING_AVERAGE:
+            for (j = 0; j < n_labels; ++j) {
+                scores[j] = scores[j] / (double) forest_get_n_trees(F);
+            }
+            break;
+
+        case FOREST_VOTING_SOFTARGMAX:
+            break;
+        }
+
+        memcpy(store_next_scores(S), scores, n_labels * sizeof(double));
+        return store_terminal(S);
+    }
+
+    variable = find_variable(
+        D,
+        offsets,
+        decision_tree_univariate_linear_split_get_index(N),
+        decision_tree_univariate_linear_split_get_threshold(N)
+    );
+    left = convert_subtree(S, D, offsets, decision_tree_univariate_linear_split_get_left_child(N), F, scores);
+    right = convert_subtree(S, D, offsets, decision_tree_univariate_linear_split_get_right_child(N), F, scores);
+
+    return if_then_else(S, variable, left, right);
+}
+
+
+
+/**
+ * Copies a diagram into new storage, children first.
+ *
+ * @param[in] S Store to copy from
+ * @param[in,out] T Store to copy into
+ * @param[in,out] copies Index of copy of each node, #NONE if not copied
+ * @param[in] i Index of root of diagram
+ * @return Index of copy of root
+ */
+static unsigned int store_copy(const Store *S, Store *T, unsigned int *copies, const unsigned int i) {
+    const BuildNode N = S->nodes[i];
+    BuildNode M;
+
+    if (copies[i] != NONE) {
+        return copies[i];
+    }
+
+    if (N.variable == TERMINAL) {
+        memcpy(T->scores + (size_t) T->n_scores * T->n_labels, S->scores + (size_t) N.left * S->n_labels, S->n_labels * sizeof(double));
+        M.variable = TERMINAL;
+        M.left = T->n_scores++;
+        M.right = 0;
+    }
+    else {
+        M.variable = N.variable;
+        M.left = store_copy(S, T, copies, N.left);
+        M.right = store_copy(S, T, copies, N.right);
+    }
+    T->nodes[T->n_nodes] = M;
+    copies[i] = T->n_nodes++;
+
+    return copies[i];
+}
+
+
+
+/**
+ * Removes nodes which are not reachable from a root.
+ *
+ * @param[in,out] S Store
+ * @param[in] root Index of root
+ * @return Index of root after collection
+ */
+static unsigned int store_collect(Store *S, const unsigned int root) {
+    unsigned int *copies = (unsigned int *) allocate(S->n_nodes * sizeof(unsigned int)), i;
+    Store T = *S;
+
+    for (i = 0; i < S->n_nodes; ++i) {
+        copies[i] = NONE;
+    }
+    T.nodes = (BuildNode *) allocate(S->capacity * sizeof(BuildNode));
+    T.scores = (double *) allocate((size_t) S->scores_capacity * S->n_labels * sizeof(double));
+    T.n_nodes = 0;
+    T.n_scores = 0;
+    i = store_copy(S, &T, copies, root);
+
+    free(S->nodes);
+    free(S->scores);
+    S->nodes = T.nodes;
+    S->scores = T.scores;
+    S->n_nodes = T.n_nodes;
+    S->n_scores = T.n_scores;
+    store_rebuild_table(S);
+    store_clear_cache(S);
+    free(copies);
+
+    return i;
+}
+
+
+
+/**
+ * Replaces scores of terminals with flags of labels having maximum score.
+ *
+ * @param[in,out] S Store
+ * @param[in,out] images Image of each node, #NONE if not computed
+ * @param[in] i Index of root of diagram
+ * @param[in,out] scores Buffer of scores
+ * @return Index of root of image
+ */
+static unsigned int store_classify(Store *S, unsigned int *images, const unsigned int i, double *scores) {
+    const BuildNode N = S->nodes[i];
+    unsigned int j, left, right;
+    double max;
+
+    if (images[i] != NONE) {
+        return images[i];
+    }
+
+    if (N.variable == TERMINAL) {
+        memcpy(scores, S->scores + (size_t) N.left * S->n_labels, S->n_labels * sizeof(double));
+        max = scores[0];
+        for (j = 1; j < S->n_labels; ++j) {
+            if (scores[j] > max) {
+                max = scores[j];
+            }
+        }
+        for (j = 0; j < S->n_labels; ++j) {
+            scores[j] = scores[j] == max ? 1.0 : 0.0;
+        }
+        memcpy(store_next_scores(S), scores, S->n_labels * sizeof(double));
+        images[i] = store_terminal(S);
+    }
+    else {
+        left = store_classify(S, images, N.left, scores);
+        right = store_classify(S, images, N.right, scores);
+        images[i] = store_node(S, N.variable, left, right);
+    }
+
+    return images[i];
+}
+
+
+
+/**
+ * Exports a collected store into a decision diagram.
+ *
+ * @param[in,out] D Decision diagram
+ * @param[in] S Store, holding only nodes reachable from root, children
+ *            first
+ * @param[in] root Index of root
+ */
+static void store_export(DecisionDiagram D, const Store *S, const unsigned int root) {
+    unsigned int *references = (unsigned int *) allocate(S->n_nodes * sizeof(unsigned int)),
+                 i, j, n_terminals = 0, n_nodes = 0;
+
+    for (i = 0; i < S->n_nodes; ++i) {
+        if (S->nodes[i].variable == TERMINAL) {
+            ++n_terminals;
+        }
+    }
+
+    D->n_terminals = n_terminals;
+    D->n_nodes = S->n_nodes - n_terminals;
+    D->terminals = (unsigned char *) allocate((size_t) n_terminals * D->n_labels * sizeof(unsigned char));
+    D->nodes = (DiagramNode *) allocate(D->n_nodes * sizeof(DiagramNode));
+
+    for (i = 0, n_terminals = 0; i < S->n_nodes; ++i) {
+        const BuildNode N = S->nodes[i];
+
+        if (N.variable == TERMINAL) {
+            for (j = 0; j < D->n_labels; ++j) {
+                D->terminals[(size_t) n_terminals * D->n_labels + j] = S->scores[(size_t) N.left * S->n_labels + j] != 0.0;
+            }
+            references[i] = n_terminals++;
+        }
+        else {
+            D->nodes[n_nodes].variable = N.variable;
+            D->nodes[n_nodes].left = references[N.left];
+            D->nodes[n_nodes].right = references[N.right];
+            references[i] = D->n_terminals + n_nodes++;
+        }
+    }
+    D->root = references[root];
+
+    free(references);
+}
+
+
+
+/**
+ * Allocates memory used by queries.
+ *
+ * @param[in,out] D Decision diagram
+ */
+static void prepare_queries(DecisionDiagram D) {
+    unsigned int i;
+
+    D->visits = (unsigned int *) allocate(D->n_nodes * sizeof(unsigned int));
+    for (i = 0; i < D->n_nodes; ++i) {
+        D->visits[i] = 0;
+    }
+    D->visit = 0;
+    D->sample_labels = (unsigned char *) allocate(D->n_labels * sizeof(unsigned char));
+    D->lower = (double *) allocate(D->space_size * sizeof(double));
+    D->upper = (double *) allocate(D->space_size * sizeof(double));
+    D->is_open = (unsigned char *) allocate(D->space_size * sizeof(unsigned char));
+
+    D->n_inexact = 0;
+    for (i = 0; i < D->n_variables; ++i) {
+        D->n_inexact += D->thresholds_up[i] != D->thresholds[i];
+    }
+    D->inexact = (unsigned int *) allocate(D->n_inexact * sizeof(unsigned int));
+    D->n_inexact = 0;
+    for (i = 0; i < D->n_variables; ++i) {
+        if (D->thresholds_up[i] != D->thresholds[i]) {
+            D->inexact[D->n_inexact++] = i;
+        }
+    }
+}
+
+
+
+/**
+ * Searches a path to labels different from those of the sample.
+ *
+ * Bounds are narrowed along the path, and left as found on success.
+ *
+ * @param[in,out] D Decision diagram
+ * @param[in] reference Reference to node
+ * @return 1 if a path was found, 0 otherwise
+ */
+static unsigned int search_counterexample(DecisionDiagram D, const unsigned int reference) {
+    DiagramNode N;
+    unsigned int f, is_open;
+    double t, bound;
+
+    if (reference < D->n_terminals) {
+        return memcmp(D->terminals + (size_t) reference * D->n_labels, D->sample_labels, D->n_labels) != 0;
+    }
+
+    /* Reachable terminals do not depend on the path: visits once */
+    if (D->visits[reference - D->n_terminals] == D->visit) {
+        return 0;
+    }
+    D->visits[reference - D->n_terminals] = D->visit;
+
+    N = D->nodes[reference - D->n_terminals];
+    f = D->features[N.variable];
+    t = D->thresholds[N.variable];
+
+    /* Left branch, where x_f <= t */
+    if (D->lower[f] < t || (D->lower[f] == t && !D->is_open[f])) {
+        bound = D->upper[f];
+        if (!(D->upper[f] <= t)) {
+            D->upper[f] = t;
+        }
+        if (search_counterexample(D, N.left)) {
+            return 1;
+        }
+        D->upper[f] = bound;
+    }
+
+    /* Right branch, including features which are NaN */
+    if (!(D->upper[f] <= t)) {
+        bound = D->lower[f];
+        is_open = D->is_open[f];
+        if (D->lower[f] <= t) {
+            D->lower[f] = t;
+            D->is_open[f] = 1;
+        }
+        if (search_counterexample(D, N.right)) {
+            return 1;
+        }
+        D->lower[f] = bound;
+        D->is_open[f] = is_open;
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * Reads binary data, aborting on failure.
+ *
+ * @param[out] data Data
+ * @param[in] size Size of an element
+ * @param[in] n Number of elements
+ * @param[in,out] stream Stream
+ */
+static void read_data(void *data, const size_t size, const size_t n, FILE *stream) {
+    if (fread(data, size, n, stream) != n) {
+        fprintf(stderr, "[%s: %d] Cannot parse decision diagram.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Writes binary data, aborting on failure.
+ *
+ * @param[in] data Data
+ * @param[in] size Size of an element
+ * @param[in] n Number of elements
+ * @param[in,out] stream Stream
+ */
+static void write_data(const void *data, const size_t size, const size_t n, FILE *stream) {
+    if (fwrite(data, size, n, stream) != n) {
+        fprintf(stderr, "[%s: %d] Cannot write decision diagram.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+unsigned int decision_diagram_create(
+    DecisionDiagram *D,
+    const Forest F,
+    const unsigned int budget
+) {
+    const unsigned int n_trees = forest_get_n_trees(F),
+                       n_labels = forest_get_n_labels(F);
+    DecisionDiagram d = (DecisionDiagram) allocate(sizeof(struct decision_diagram));
+    unsigned int *offsets, *images, i, j, root, tree, size, n_attempts;
+    double *scores;
+    Store S;
+
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    d->forest_hash = forest_hash_structure(F);
+    d->voting_scheme = forest_get_voting_scheme(F);
+    d->space_size = forest_get_feature_space_size(F);
+    d->n_labels = n_labels;
+    d->labels = (char **) allocate(n_labels * sizeof(char *));
+    for (i = 0; i < n_labels; ++i) {
+        d->labels[i] = (char *) allocate(strlen(forest_get_labels_as_array(F)[i]) + 1);
+        strcpy(d->labels[i], forest_get_labels_as_array(F)[i]);
+    }
+    offsets = (unsigned int *) allocate((d->space_size + 1) * sizeof(unsigned int));
+    create_variables(d, offsets, F);
+    d->n_terminals = 0;
+    d->terminals = NULL;
+    d->n_nodes = 0;
+    d->nodes = NULL;
+    d->visits = NULL;
+    d->sample_labels = NULL;
+    d->lower = NULL;
+    d->upper = NULL;
+    d->is_open = NULL;
+    d->inexact = NULL;
+
+
+    /* Adds trees in order, collecting garbage when it doubles the diagram */
+    scores = (double *) allocate(n_labels * sizeof(double));
+    store_create(&S, n_labels, d->features, budget);
+    for (j = 0; j < n_labels; ++j) {
+        store_next_scores(&S)[j] = 0.0;
+    }
+    root = store_terminal(&S);
+    size = S.n_nodes;
+    for (i = 0; i < n_trees && !S.is_over_budget; ++i) {
+        for (n_attempts = 0; n_attempts < 2; ++n_attempts) {
+            tree = convert_subtree(&S, d, offsets, decision_tree_get_root(forest_get_trees_as_array(F)[i]), F, scores);
+            tree = add(&S, root, tree);
+            if (!S.is_over_budget || n_attempts > 0) {
+                break;
+            }
+
+            /* Retries once, without garbage */
+            S.is_over_budget = 0;
+            root = store_collect(&S, root);
+            size = S.n_nodes;
+        }
+        root = tree;
+
+        if (!S.is_over_budget && S.n_nodes >= 2 * size && S.n_nodes >= MIN_COLLECTION_SIZE) {
+            root = store_collect(&S, root);
+            size = S.n_nodes;
+        }
+    }
+
+
+    /* Replaces scores with labels */
+    if (!S.is_over_budget) {
+        root = store_collect(&S, root);
+        images = (unsigned int *) allocate(S.n_nodes * sizeof(unsigned int));
+        for (i = 0; i < S.n_nodes; ++i) {
+            images[i] = NONE;
+        }
+        S.budget = UINT_MAX;
+        root = store_classify(&S, images, root, scores);
+        root = store_collect(&S, root);
+        free(images);
+        store_export(d, &S, root);
+        prepare_queries(d);
+    }
+
+    free(offsets);
+    free(scores);
+    if (S.is_over_budget) {
+        store_delete(&S);
+        decision_diagram_delete(&d);
+        *D = NULL;
+        return 0;
+    }
+    store_delete(&S);
+
+    *D = d;
+    return 1;
+}
+
+
+
+void decision_diagram_delete(DecisionDiagram *D) {
+    unsigned int i;
+
+    if (D == NULL || *D == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < (*D)->n_labels; ++i) {
+        free((*D)->labels[i]);
+    }
+    free((*D)->labels);
+    free((*D)->features);
+    free((*D)->thresholds);
+    free((*D)->thresholds_up);
+    free((*D)->terminals);
+    free((*D)->nodes);
+    free((*D)->visits);
+    free((*D)->sample_labels);
+    free((*D)->lower);
+    free((*D)->upper);
+    free((*D)->is_open);
+    free((*D)->inexact);
+    free(*D);
+    *D = NULL;
+}
+
+
+
+unsigned int decision_diagram_get_n_nodes(const DecisionDiagram D) {
+    if (D == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return D->n_terminals + D->n_nodes;
+}
+
+
+
+unsigned int decision_diagram_matches(const DecisionDiagram D, const Forest F) {
+    if (D == NULL || F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return D->voting_scheme == forest_get_voting_scheme(F)
+        && D->space_size == forest_get_feature_space_size(F)
+        && D->n_labels == forest_get_n_labels(F)
+        && D->forest_hash == forest_hash_structure(F);
+}
+
+
+
+void decision_diagram_is_stable(
+    StabilityStatus *status,
+    const DecisionDiagram D,
+    const Hyperrectangle x
+) {
+    unsigned int i;
+
+    if (status == NULL || D == NULL || x == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (x->n != D->space_size) {
+        fprintf(stderr, "[%s: %d] Hyperrectangle does not match decision diagram.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    /* Starts a new query */
+    if (++D->visit == 0) {
+        for (i = 0; i < D->n_nodes; ++i) {
+            D->visits[i] = 0;
+        }
+        D->visit = 1;
+    }
+    for (i = 0; i < D->n_labels; ++i) {
+        D->sample_labels[i] = set_has_element(status->labels_a, D->labels[i]) ? 1 : 0;
+    }
+    for (i = 0; i < D->space_size; ++i) {
+        D->lower[i] = x->intervals[i].l;
+        D->upper[i] = x->intervals[i].u;
+        D->is_open[i] = 0;
+    }
+
+    /* Original thresholds of a variable are only known to lie between its
+     * rounded ones */
+    for (i = 0; i < D->n_inexact; ++i) {
+        const unsigned int v = D->inexact[i];
+        if (D->lower[D->features[v]] < D->thresholds_up[v] && D->upper[D->features[v]] > D->thresholds[v]) {
+            status->result = STABILITY_DONT_KNOW;
+            return;
+        }
+    }
+
+    if (!search_counterexample(D, D->root)) {
+        status->result = STABILITY_TRUE;
+        return;
+    }
+
+    /* Picks a point inside the bounds of the path */
+    status->result = STABILITY_FALSE;
+    for (i = 0; i < D->space_size; ++i) {
+        double middle = D->lower[i] + (D->upper[i] - D->lower[i]) / 2.0;
+
+        if (D->is_open[i] && !(middle > D->lower[i])) {
+            middle = D->upper[i];
+        }
+        status->sample_b[i] = middle;
+        status->region->intervals[i].l = D->lower[i];
+        status->region->intervals[i].u = D->upper[i];
+    }
+}
+
+
+
+void decision_diagram_read(DecisionDiagram *D, FILE *stream) {
+    unsigned int version, length, i;
+    int voting_scheme;
+    DecisionDiagram d;
+
+    if (!stream) {
+        fprintf(stderr, "[%s: %d] Cannot read file.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (fscanf(stream, "silva-diagram %u", &version) != 1 || fgetc(stream) != '\n'
+        || version != DIAGRAM_VERSION) {
+        fprintf(stderr, "[%s: %d] Cannot parse decision diagram.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    d = (DecisionDiagram) allocate(sizeof(struct decision_diagram));
+    read_data(&d->forest_hash, sizeof(unsigned long long), 1, stream);
+    read_data(&voting_scheme, sizeof(int), 1, stream);
+    d->voting_scheme = (ForestVotingScheme) voting_scheme;
+    read_data(&d->space_size, sizeof(unsigned int), 1, stream);
+    read_data(&d->n_labels, sizeof(unsigned int), 1, stream);
+    d->labels = (char **) allocate(d->n_labels * sizeof(char *));
+    for (i = 0; i < d->n_labels; ++i) {
+        read_data(&length, sizeof(unsigned int), 1, stream);
+        d->labels[i] = (char *) allocate(length + 1);
+        read_data(d->labels[i], sizeof(char), length, stream);
+        d->labels[i][length] = '\0';
+    }
+
+    read_data(&d->n_variables, sizeof(unsigned int), 1, stream);
+    d->features = (unsigned int *) allocate(d->n_variables * sizeof(unsigned int));
+    d->thresholds = (double *) allocate(d->n_variables * sizeof(double));
+    d->thresholds_up = (double *) allocate(d->n_variables * sizeof(double));
+    read_data(d->features, sizeof(unsigned int), d->n_variables, stream);
+    read_data(d->thresholds, sizeof(double), d->n_variables, stream);
+    read_data(d->thresholds_up, sizeof(double), d->n_variables, stream);
+
+    read_data(&d->n_terminals, sizeof(unsigned int), 1, stream);
+    d->terminals = (unsigned char *) allocate((size_t) d->n_terminals * d->n_labels);
+    read_data(d->terminals, sizeof(unsigned char), (size_t) d->n_terminals * d->n_labels, stream);
+    read_data(&d->n_nodes, sizeof(unsigned int), 1, stream);
+    d->nodes = (DiagramNode *) allocate(d->n_nodes * sizeof(DiagramNode));
+    read_data(d->nodes, sizeof(DiagramNode), d->n_nodes, stream);
+    read_data(&d->root, sizeof(unsigned int), 1, stream);
+
+    /* Checks references, so that queries cannot go astray */
+    for (i = 0; i < d->n_variables; ++i) {
+        if (d->features[i] >= d->space_size || !(d->thresholds_up[i] >= d->thresholds[i])) {
+            fprintf(stderr, "[%s: %d] Cannot parse decision diagram.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+    for (i = 0; i < d->n_nodes; ++i) {
+        if (d->nodes[i].variable >= d->n_variables
+            || d->nodes[i].left >= d->n_terminals + i
+            || d->nodes[i].right >= d->n_terminals + i) {
+            fprintf(stderr, "[%s: %d] Cannot parse decision diagram.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+    if (d->root >= d->n_terminals + d->n_nodes) {
+        fprintf(stderr, "[%s: %d] Cannot parse decision diagram.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    prepare_queries(d);
+    *D = d;
+}
+
+
+
+void decision_diagram_write(const DecisionDiagram D, FILE *stream) {
+    const int voting_scheme = D != NULL ? (int) D->voting_scheme : 0;
+    unsigned int length, i;
+
+    if (D == NULL || !stream) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(stream, "silva-diagram %u\n", DIAGRAM_VERSION);
+    write_data(&D->forest_hash, sizeof(unsigned long long), 1, stream);
+    write_data(&voting_scheme, sizeof(int), 1, stream);
+    write_data(&D->space_size, sizeof(unsigned int), 1, stream);
+    write_data(&D->n_labels, sizeof(unsigned int), 1, stream);
+    for (i = 0; i < D->n_labels; ++i) {
+        length = (unsigned int) strlen(D->labels[i]);
+        write_data(&length, sizeof(unsigned int), 1, stream);
+        write_data(D->labels[i], sizeof(char), length, stream);
+    }
+
+    write_data(&D->n_variables, sizeof(unsigned int), 1, stream);
+    write_data(D->features, sizeof(unsigned int), D->n_variables, stream);
+    write_data(D->thresholds, sizeof(double), D->n_variables, stream);
+    write_data(D->thresholds_up, sizeof(double), D->n_variables, stream);
+
+    write_data(&D->n_terminals, sizeof(unsigned int), 1, stream);
+    write_data(D->terminals, sizeof(unsigned char), (size_t) D->n_terminals * D->n_labels, stream);
+    write_data(&D->n_nodes, sizeof(unsigned int), 1, stream);
+    write_data(D->nodes, sizeof(DiagramNode), D->n_nodes, stream);
+    write_data(&D->root, sizeof(unsigned int), 1, stream);
+}
@@ -0,0 +1,129 @@
+/**
+ * Defines a decision diagram.
+ *
+ * A decision diagram is a compilation of the whole decision function of
+ * a forest, generated by silva-compile. Features are binned by the
+ * thresholds used in the forest: every internal node tests whether a
+ * feature is at most one of such thresholds, nodes are ordered by feature
+ * and threshold along every path, and identical subdiagrams are shared.
+ * Terminals hold the set of labels the forest returns. Stability of a
+ * hyperrectangle is then checked by a traversal of the diagram, whose
+ * cost does not depend on the number of trees.
+ *
+ * @file decision_diagram.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef DECISION_DIAGRAM_H
+#define DECISION_DIAGRAM_H
+
+#include <stdio.h>
+
+#include "forest.h"
+#include "abstract_domains/hyperrectangle.h"
+#include "abstract_interpreters/stability_status.h"
+
+
+/** Default maximum number of nodes held while building a diagram. */
+#define DECISION_DIAGRAM_BUDGET 10000000
+
+
+/** Type of a decision diagram. */
+typedef struct decision_diagram *DecisionDiagram;
+
+
+
+/**
+ * Compiles a forest into a decision diagram.
+ *
+ * Trees are added one at a time, in the order of the forest, so that
+ * scores are accumulated exactly as the forest does.
+ *
+ * @param[out] D Pointer to decision diagram to create, NULL if budget was
+ *             exceeded
+ * @param[in] F Forest, with the voting scheme to compile
+ * @param[in] budget Maximum number of nodes held while building
+ * @return 1 if the diagram was built, 0 if budget was exceeded
+ * @warning #decision_diagram_delete should be called to ensure proper
+ *          memory deallocation.
+ */
+unsigned int decision_diagram_create(
+    DecisionDiagram *D,
+    const Forest F,
+    const unsigned int budget
+);
+
+
+/**
+ * Deletes a decision diagram.
+ *
+ * @param[in,out] D Pointer to decision diagram
+ */
+void decision_diagram_delete(DecisionDiagram *D);
+
+
+
+/**
+ * Returns number of nodes of a decision diagram, terminals included.
+ *
+ * @param[in] D Decision diagram
+ * @return Number of nodes
+ */
+unsigned int decision_diagram_get_n_nodes(const DecisionDiagram D);
+
+
+/**
+ * Tells whether a decision diagram was compiled from a forest.
+ *
+ * Forests with the same labels, voting scheme and exact structure match:
+ * a forest simplified when loaded does not match a diagram compiled from
+ * the original one.
+ *
+ * @param[in] D Decision diagram
+ * @param[in] F Forest
+ * @return 1 if diagram matches forest, 0 otherwise
+ */
+unsigned int decision_diagram_matches(const DecisionDiagram D, const Forest F);
+
+
+
+/**
+ * Checks stability of a hyperrectangle.
+ *
+ * The diagram is exact, so the result is #STABILITY_DONT_KNOW only when
+ * thresholds are stored in single precision and the hyperrectangle
+ * reaches between the two rounded thresholds of a split.
+ * When unstable, the counterexample region is the part of the
+ * hyperrectangle following a path to a different set of labels.
+ *
+ * @param[in,out] status Stability status, with labels of the sample set
+ * @param[in] D Decision diagram
+ * @param[in] x Hyperrectangle
+ */
+void decision_diagram_is_stable(
+    StabilityStatus *status,
+    const DecisionDiagram D,
+    const Hyperrectangle x
+);
+
+
+
+/**
+ * Reads a decision diagram.
+ *
+ * @param[out] D Pointer to decision diagram
+ * @param[in,out] stream Stream
+ * @warning #decision_diagram_delete should be called to ensure proper
+ *          memory deallocation.
+ */
+void decision_diagram_read(DecisionDiagram *D, FILE *stream);
+
+
+/**
+ * Writes a decision diagram.
+ *
+ * @param[in] D Decision diagram
+ * @param[in,out] stream Stream
+ */
+void decision_diagram_write(const DecisionDiagram D, FILE *stream);
+
+#endif
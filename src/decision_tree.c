@@ -9,9 +9,11 @@
  * @author Marco Zanella <marco.zanella.1991@gmail.com>
  */
 #include "decision_tree.h"
+#include "hash.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 
 /***********************************************************************
@@ -68,7 +70,8 @@ static void data_delete(Data *D) {
  * Internal functions.
  **********************************************************************/
 
-/** Global identifier counter. */
+/** Global identifier counter, updated atomically as trees may be built
+ * concurrently. */
 static unsigned int next_available_id = 1;
 
 
@@ -125,6 +128,76 @@ static void scores_visitor(
 
 
 
+/**
+ * Visitor which counts leaves.
+ *
+ * @param[in] N Node
+ * @param[in,out] n_leaves Pointer to number of leaves
+ */
+static void leaf_counter_visitor(
+    DecisionTreeNode N,
+    void * const n_leaves
+) {
+    if (binary_tree_node_is_leaf(N)) {
+        ++*((unsigned int *) n_leaves);
+    }
+}
+
+
+
+/**
+ * Visitor which collects leaves.
+ *
+ * @param[in] N Node
+ * @param[in,out] leaves Pointer to pointer to next free position
+ */
+static void leaf_collector_visitor(
+    DecisionTreeNode N,
+    void * const leaves
+) {
+    if (binary_tree_node_is_leaf(N)) {
+        **((DecisionTreeNode **) leaves) = N;
+        ++*((DecisionTreeNode **) leaves);
+    }
+}
+
+
+
+/**
+ * Computes decision function given the leaf reached by a sample.
+ *
+ * @param[out] scores Array of scores
+ * @param[in] T Decision tree
+ * @param[in] D Data of reached leaf
+ */
+static void leaf_decision_function(
+    double *scores,
+    const DecisionTree T,
+    const Data D
+) {
+    unsigned int i;
+
+    switch (D->type) {
+    case DECISION_TREE_LEAF:
+        for (i = 0; i < T->n_labels; ++i) {
+            scores[i] = (double) D->data.leaf.scores[i] / (double) D->data.leaf.n_samples;
+        }
+        break;
+
+    case DECISION_TREE_LEAF_LOG:
+        for (i = 0; i < T->n_labels; ++i) {
+            scores[i] = D->data.leaf_logarithmic.scores[i];
+        }
+        break;
+
+    case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
+        /* Impossible */
+        break;
+    }
+}
+
+
+
 /**
  * Printer for a decision tree.
  *
@@ -166,6 +239,449 @@ static void decision_tree_printer(const void * const D, void *data, FILE *stream
 
 
 
+/** Structure of the region of feature space reaching a node, used while
+ * simplifying or hashing a tree. */
+struct region {
+    double *lower;           /**< Lower bound of each feature. */
+    unsigned char *is_open;  /**< Whether each lower bound is excluded. */
+    double *upper;           /**< Upper bound of each feature, included. */
+    unsigned int has_nan;    /**< Whether samples with NaN features, which
+                                  always go right, reach the node. */
+};
+
+/** Type of region of feature space reaching a node. */
+typedef struct region Region;
+
+
+/** Structure of the bounds of a feature, saved before entering a child. */
+struct saved_bounds {
+    double lower;           /**< Lower bound. */
+    unsigned char is_open;  /**< Whether lower bound is excluded. */
+    double upper;           /**< Upper bound. */
+    unsigned int has_nan;   /**< Whether samples with NaN features reach
+                                 the node. */
+};
+
+/** Type of the bounds of a feature, saved before entering a child. */
+typedef struct saved_bounds SavedBounds;
+
+
+
+/**
+ * Creates a region.
+ *
+ * @param[out] region Region
+ * @param[in] space_size Size of the feature space
+ * @param[in] lower Lower bound of each feature, NULL if unbounded
+ * @param[in] upper Upper bound of each feature, NULL if unbounded
+ */
+static void region_create(
+    Region *region,
+    const unsigned int space_size,
+    const double *lower,
+    const double *upper
+) {
+    unsigned int i;
+
+    region->lower = (double *) malloc(space_size * sizeof(double));
+    region->is_open = (unsigned char *) malloc(space_size * sizeof(unsigned char));
+    region->upper = (double *) malloc(space_size * sizeof(double));
+    if (space_size > 0 && (region->lower == NULL || region->is_open == NULL || region->upper == NULL)) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < space_size; ++i) {
+        region->lower[i] = lower != NULL ? lower[i] : -HUGE_VAL;
+        region->is_open[i] = 0;
+        region->upper[i] = upper != NULL ? upper[i] : HUGE_VAL;
+        if (!(region->lower[i] <= region->upper[i])) {
+            fprintf(stderr, "[%s: %d] Invalid bounds of feature %u.\n", __FILE__, __LINE__, i);
+            abort();
+        }
+    }
+    region->has_nan = lower == NULL || upper == NULL;
+}
+
+
+
+/**
+ * Deletes a region.
+ *
+ * @param[in,out] region Region
+ */
+static void region_delete(Region *region) {
+    free(region->lower);
+    free(region->is_open);
+    free(region->upper);
+}
+
+
+
+/**
+ * Tells which branches of a split can be taken by samples of a region.
+ *
+ * Regions hold real values, for which the original threshold is only
+ * known to lie between the two rounded ones: the left branch is taken up
+ * to the upper threshold, the right one above the lower threshold.
+ *
+ * @param[out] is_left_feasible 1 if left branch can be taken
+ * @param[out] is_right_feasible 1 if right branch can be taken
+ * @param[in] region Region reaching the split
+ * @param[in] D Data payload of the split
+ */
+static void region_get_feasible_branches(
+    unsigned int *is_left_feasible,
+    unsigned int *is_right_feasible,
+    const Region *region,
+    const Data D
+) {
+    const unsigned int i = D->data.univariate_linear_split.i;
+    const double k = D->data.univariate_linear_split.k,
+                 k_up = D->data.univariate_linear_split.k_up;
+
+    *is_left_feasible = region->lower[i] < k_up || (region->lower[i] == k_up && !region->is_open[i]);
+    *is_right_feasible = region->upper[i] > k || region->has_nan;
+}
+
+
+
+/**
+ * Restricts a region to the left branch of a split, up to its upper
+ * threshold.
+ *
+ * @param[in,out] region Region
+ * @param[out] saved Bounds to restore afterwards
+ * @param[in] D Data payload of the split
+ */
+static void region_enter_left(Region *region, SavedBounds *saved, const Data D) {
+    const unsigned int i = D->data.univariate_linear_split.i;
+    const double k = D->data.univariate_linear_split.k_up;
+
+    saved->lower = region->lower[i];
+    saved->is_open = region->is_open[i];
+    saved->upper = region->upper[i];
+    saved->has_nan = region->has_nan;
+
+    if (k < region->upper[i]) {
+        region->upper[i] = k;
+    }
+    region->has_nan = 0;
+}
+
+
+
+/**
+ * Restricts a region to the right branch of a split, x_i > k.
+ *
+ * @param[in,out] region Region
+ * @param[out] saved Bounds to restore afterwards
+ * @param[in] D Data payload of the split
+ */
+static void region_enter_right(Region *region, SavedBounds *saved, const Data D) {
+    const unsigned int i = D->data.univariate_linear_split.i;
+    const double k = D->data.univariate_linear_split.k;
+
+    saved->lower = region->lower[i];
+    saved->is_open = region->is_open[i];
+    saved->upper = region->upper[i];
+    saved->has_nan = region->has_nan;
+
+    if (k >= region->lower[i]) {
+        region->lower[i] = k;
+        region->is_open[i] = 1;
+    }
+}
+
+
+
+/**
+ * Restores a region after leaving a branch of a split.
+ *
+ * @param[in,out] region Region
+ * @param[in] saved Bounds saved when entering the branch
+ * @param[in] D Data payload of the split
+ */
+static void region_leave(Region *region, const SavedBounds saved, const Data D) {
+    const unsigned int i = D->data.univariate_linear_split.i;
+
+    region->lower[i] = saved.lower;
+    region->is_open[i] = saved.is_open;
+    region->upper[i] = saved.upper;
+    region->has_nan = saved.has_nan;
+}
+
+
+
+/**
+ * Visitor which counts nodes.
+ *
+ * @param[in] N Node
+ * @param[in,out] n_nodes Pointer to number of nodes
+ */
+static void node_counter_visitor(
+    DecisionTreeNode N,
+    void * const n_nodes
+) {
+    ++*((unsigned int *) n_nodes);
+
+    (void) N;
+}
+
+
+
+/**
+ * Updates a hash with the data payload of a node.
+ *
+ * @param[in] hash Hash
+ * @param[in] D Data payload
+ * @return Updated hash
+ */
+static unsigned long long hash_data(unsigned long long hash, const Data D) {
+    hash = hash_bytes(hash, &D->type, sizeof(D->type));
+
+    switch (D->type) {
+    case DECISION_TREE_LEAF:
+        hash = hash_bytes(hash, D->data.leaf.scores, D->data.leaf.n_labels * sizeof(unsigned int));
+        break;
+
+    case DECISION_TREE_LEAF_LOG:
+        hash = hash_bytes(hash, D->data.leaf_logarithmic.scores, D->data.leaf_logarithmic.n_labels * sizeof(double));
+        hash = hash_bytes(hash, &D->data.leaf_logarithmic.weight, sizeof(double));
+        break;
+
+    case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
+        hash = hash_bytes(hash, &D->data.univariate_linear_split.i, sizeof(unsigned int));
+        hash = hash_bytes(hash, &D->data.univariate_linear_split.k, sizeof(Storage));
+        hash = hash_bytes(hash, &D->data.univariate_linear_split.k_up, sizeof(Storage));
+        break;
+    }
+
+    return hash;
+}
+
+
+
+/**
+ * Tells whether two nodes have identical data payloads.
+ *
+ * @param[in] A First data payload
+ * @param[in] B Second data payload
+ * @return 1 if payloads are identical, 0 otherwise
+ */
+static unsigned int data_is_equal(const Data A, const Data B) {
+    if (A->type != B->type) {
+        return 0;
+    }
+
+    switch (A->type) {
+    case DECISION_TREE_LEAF:
+        return A->data.leaf.n_labels == B->data.leaf.n_labels
+            && memcmp(A->data.leaf.scores, B->data.leaf.scores, A->data.leaf.n_labels * sizeof(unsigned int)) == 0;
+
+    case DECISION_TREE_LEAF_LOG:
+        return A->data.leaf_logarithmic.n_labels == B->data.leaf_logarithmic.n_labels
+            && memcmp(A->data.leaf_logarithmic.scores, B->data.leaf_logarithmic.scores, A->data.leaf_logarithmic.n_labels * sizeof(double)) == 0
+            && memcmp(&A->data.leaf_logarithmic.weight, &B->data.leaf_logarithmic.weight, sizeof(double)) == 0;
+
+    case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
+        return A->data.univariate_linear_split.i == B->data.univariate_linear_split.i
+            && memcmp(&A->data.univariate_linear_split.k, &B->data.univariate_linear_split.k, sizeof(Storage)) == 0
+            && memcmp(&A->data.univariate_linear_split.k_up, &B->data.univariate_linear_split.k_up, sizeof(Storage)) == 0;
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * Tells whether two subtrees are identical.
+ *
+ * @param[in] A Root of first subtree
+ * @param[in] B Root of second subtree
+ * @return 1 if subtrees are identical, 0 otherwise
+ */
+static unsigned int subtrees_are_equal(const DecisionTreeNode A, const DecisionTreeNode B) {
+    if (!data_is_equal(binary_tree_node_get_data(A), binary_tree_node_get_data(B))) {
+        return 0;
+    }
+    if (binary_tree_node_is_leaf(A)) {
+        return 1;
+    }
+
+    return subtrees_are_equal(binary_tree_node_get_left_child(A), binary_tree_node_get_left_child(B))
+        && subtrees_are_equal(binary_tree_node_get_right_child(A), binary_tree_node_get_right_child(B));
+}
+
+
+
+/**
+ * Replaces a split by one of its children, deleting the other one.
+ *
+ * @param[in,out] N Split to replace
+ * @param[in,out] C Child to keep
+ * @param[in,out] n_removed Pointer to number of removed nodes
+ * @return Kept child, now in place of the split
+ */
+static DecisionTreeNode replace_by_child(
+    DecisionTreeNode N,
+    DecisionTreeNode C,
+    unsigned int *n_removed
+) {
+    const DecisionTreeNode P = binary_tree_node_get_parent(N);
+    const unsigned int is_left = P != NULL && binary_tree_node_get_left_child(P) == N;
+
+    binary_tree_node_detach(C);
+    if (P != NULL) {
+        binary_tree_node_detach(N);
+        if (is_left) {
+            binary_tree_node_set_left_child(P, C);
+        }
+        else {
+            binary_tree_node_set_right_child(P, C);
+        }
+    }
+
+    binary_tree_depth_first_pre_visit(N, node_counter_visitor, n_removed);
+    decision_tree_node_delete(&N);
+
+    return C;
+}
+
+
+
+/**
+ * Simplifies a subtree.
+ *
+ * Splits which can send samples of the region only one way are replaced
+ * by the corresponding child, and splits whose children are identical
+ * are replaced by one of them.
+ *
+ * @param[in,out] N Root of subtree
+ * @param[in,out] region Region of feature space reaching the root,
+ *                restored on return
+ * @param[out] hash Structural hash of the simplified subtree
+ * @param[in,out] n_removed Pointer to number of removed nodes
+ * @return Root of the simplified subtree
+ */
+static DecisionTreeNode simplify_node(
+    DecisionTreeNode N,
+    Region *region,
+    unsigned long long *hash,
+    unsigned int *n_removed
+) {
+    Data D = binary_tree_node_get_data(N);
+    DecisionTreeNode L, R;
+    SavedBounds saved;
+    unsigned long long left_hash, right_hash;
+    unsigned int is_left_feasible, is_right_feasible;
+
+    /* Skips splits with an infeasible branch */
+    while (D->type == DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        region_get_feasible_branches(&is_left_feasible, &is_right_feasible, region, D);
+        if (is_left_feasible && is_right_feasible) {
+            break;
+        }
+        N = replace_by_child(N, is_left_feasible ? binary_tree_node_get_left_child(N) : binary_tree_node_get_right_child(N), n_removed);
+        D = binary_tree_node_get_data(N);
+    }
+
+    *hash = hash_data(HASH_OFFSET, D);
+    if (D->type == DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        region_enter_left(region, &saved, D);
+        L = simplify_node(binary_tree_node_get_left_child(N), region, &left_hash, n_removed);
+        region_leave(region, saved, D);
+
+        region_enter_right(region, &saved, D);
+        R = simplify_node(binary_tree_node_get_right_child(N), region, &right_hash, n_removed);
+        region_leave(region, saved, D);
+
+        if (left_hash == right_hash && subtrees_are_equal(L, R)) {
+            N = replace_by_child(N, L, n_removed);
+            *hash = left_hash;
+        }
+        else {
+            *hash = hash_bytes(*hash, &left_hash, sizeof(unsigned long long));
+            *hash = hash_bytes(*hash, &right_hash, sizeof(unsigned long long));
+        }
+    }
+
+    return N;
+}
+
+
+
+/**
+ * Computes the structural hash of a subtree restricted to a region.
+ *
+ * Matches the hash #simplify_node would compute, without modifying the
+ * subtree; children are considered identical when their hashes are.
+ *
+ * @param[in] N Root of subtree
+ * @param[in,out] region Region of feature space reaching the root,
+ *                restored on return
+ * @return Hash
+ */
+static unsigned long long hash_node(DecisionTreeNode N, Region *region) {
+    Data D = binary_tree_node_get_data(N);
+    SavedBounds saved;
+    unsigned long long hash, left_hash, right_hash;
+    unsigned int is_left_feasible, is_right_feasible;
+
+    /* Skips splits with an infeasible branch */
+    while (D->type == DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        region_get_feasible_branches(&is_left_feasible, &is_right_feasible, region, D);
+        if (is_left_feasible && is_right_feasible) {
+            break;
+        }
+        N = is_left_feasible ? binary_tree_node_get_left_child(N) : binary_tree_node_get_right_child(N);
+        D = binary_tree_node_get_data(N);
+    }
+
+    hash = hash_data(HASH_OFFSET, D);
+    if (D->type == DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        region_enter_left(region, &saved, D);
+        left_hash = hash_node(binary_tree_node_get_left_child(N), region);
+        region_leave(region, saved, D);
+
+        region_enter_right(region, &saved, D);
+        right_hash = hash_node(binary_tree_node_get_right_child(N), region);
+        region_leave(region, saved, D);
+
+        if (left_hash == right_hash) {
+            return left_hash;
+        }
+        hash = hash_bytes(hash, &left_hash, sizeof(unsigned long long));
+        hash = hash_bytes(hash, &right_hash, sizeof(unsigned long long));
+    }
+
+    return hash;
+}
+
+
+
+/**
+ * Updates a hash with every node of a subtree, in pre-order.
+ *
+ * @param[in] hash Hash
+ * @param[in] N Root of subtree
+ * @return Updated hash
+ */
+static unsigned long long hash_structure(unsigned long long hash, const DecisionTreeNode N) {
+    const Data D = binary_tree_node_get_data(N);
+
+    hash = hash_data(hash, D);
+    if (D->type == DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        hash = hash_structure(hash, binary_tree_node_get_left_child(N));
+        hash = hash_structure(hash, binary_tree_node_get_right_child(N));
+    }
+
+    return hash;
+}
+
+
+
 
 
 /***********************************************************************
@@ -182,7 +698,7 @@ void decision_tree_leaf_create(
 
     binary_tree_create(leaf);
     data_create(&D);
-    D->id = next_available_id++;
+    D->id = __sync_fetch_and_add(&next_available_id, 1);
     D->type = DECISION_TREE_LEAF;
     D->data.leaf.scores = scores;
     D->data.leaf.n_labels = n_labels;
@@ -247,7 +763,7 @@ void decision_tree_leaf_logarithmic_create(
 
     binary_tree_create(leaf);
     data_create(&D);
-    D->id = next_available_id++;
+    D->id = __sync_fetch_and_add(&next_available_id, 1);
     D->type = DECISION_TREE_LEAF_LOG;
     D->data.leaf_logarithmic.scores = scores;
     D->data.leaf_logarithmic.n_labels = n_labels;
@@ -304,10 +820,11 @@ void decision_tree_univariate_linear_split_create(
 
     binary_tree_create(N);
     data_create(&D);
-    D->id = next_available_id++;
+    D->id = __sync_fetch_and_add(&next_available_id, 1);
     D->type = DECISION_TREE_UNIVARIATE_LINEAR_SPLIT;
     D->data.univariate_linear_split.i = i;
-    D->data.univariate_linear_split.k = k;
+    D->data.univariate_linear_split.k = storage_round_down(k);
+    D->data.univariate_linear_split.k_up = storage_round_up(k);
     binary_tree_node_set_data(*N, D);
 }
 
@@ -355,6 +872,24 @@ double decision_tree_univariate_linear_split_get_threshold(const DecisionTreeNod
 
 
 
+double decision_tree_univariate_linear_split_get_upper_threshold(const DecisionTreeNode N) {
+    if (N == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    Data D = binary_tree_node_get_data(N);
+    if (D->type != DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+        fprintf(stderr, "[%s: %d] Node is not an univariate linear split.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return D->data.univariate_linear_split.k_up;
+
+}
+
+
+
 DecisionTreeNode decision_tree_univariate_linear_split_get_left_child(const DecisionTreeNode N) {
     return binary_tree_node_get_left_child(N);
 }
@@ -584,6 +1119,7 @@ void decision_tree_create(
     t->space_size = n;
     t->labels = labels;
     t->n_labels = n_labels;
+    t->leaves = NULL;
 
     *T = t;
 }
@@ -602,6 +1138,7 @@ void decision_tree_delete(DecisionTree *T) {
         free((*T)->labels[i]);
     }
     free((*T)->labels);
+    free((*T)->leaves);
     free(*T);
     *T = NULL;
 }
@@ -652,6 +1189,101 @@ unsigned int decision_tree_get_n_labels(const DecisionTree T) {
 
 
 
+unsigned int decision_tree_get_n_leaves(const DecisionTree T) {
+    unsigned int n_leaves = 0;
+
+    if (T == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    binary_tree_depth_first_pre_visit(T->root, leaf_counter_visitor, &n_leaves);
+    return n_leaves;
+}
+
+
+
+DecisionTreeNode *decision_tree_get_leaves_as_array(const DecisionTree T) {
+    DecisionTreeNode *next;
+
+    if (T == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (T->leaves == NULL) {
+        T->leaves = (DecisionTreeNode *) malloc(decision_tree_get_n_leaves(T) * sizeof(DecisionTreeNode));
+        if (T->leaves == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+            abort();
+        }
+        next = T->leaves;
+        binary_tree_depth_first_pre_visit(T->root, leaf_collector_visitor, &next);
+    }
+
+    return T->leaves;
+}
+
+
+
+unsigned int decision_tree_optimize(
+    DecisionTree T,
+    const double *lower,
+    const double *upper
+) {
+    unsigned int n_removed = 0;
+    unsigned long long hash;
+    Region region;
+
+    if (T == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    region_create(&region, T->space_size, lower, upper);
+    T->root = simplify_node(T->root, &region, &hash, &n_removed);
+    free(T->leaves);
+    T->leaves = NULL;
+    region_delete(&region);
+
+    return n_removed;
+}
+
+
+
+unsigned long long decision_tree_hash(
+    const DecisionTree T,
+    const double *lower,
+    const double *upper
+) {
+    unsigned long long hash;
+    Region region;
+
+    if (T == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    region_create(&region, T->space_size, lower, upper);
+    hash = hash_node(T->root, &region);
+    region_delete(&region);
+
+    return hash;
+}
+
+
+
+unsigned long long decision_tree_hash_structure(const DecisionTree T, const unsigned long long hash) {
+    if (T == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return hash_structure(hash, T->root);
+}
+
+
+
 void decision_tree_compute_decision_function(
     double *scores,
     const DecisionTree T,
@@ -662,7 +1294,6 @@ void decision_tree_compute_decision_function(
         abort();
     }
 
-    unsigned int i;
     DecisionTreeNode N = T->root;
     Data D = binary_tree_node_get_data(N);
     while (D->type != DECISION_TREE_LEAF && D->type != DECISION_TREE_LEAF_LOG) {
@@ -682,22 +1313,47 @@ void decision_tree_compute_decision_function(
         D = binary_tree_node_get_data(N);
     }
 
-    switch (D->type) {
-    case DECISION_TREE_LEAF:
-        for (i = 0; i < T->n_labels; ++i) {
-            scores[i] = (double) D->data.leaf.scores[i] / (double) D->data.leaf.n_samples;
-        }
-        break;
+    leaf_decision_function(scores, T, D);
+}
 
-    case DECISION_TREE_LEAF_LOG:
-        for (i = 0; i < T->n_labels; ++i) {
-            scores[i] = D->data.leaf_logarithmic.scores[i];
+
+
+void decision_tree_compute_decision_function_block(
+    double *scores,
+    DecisionTreeNode *nodes,
+    const DecisionTree T,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+) {
+    unsigned int s, is_moving = 1;
+
+    if (scores == NULL || nodes == NULL || T == NULL || columns == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    /* Moves every sample one level down per pass, so that the same nodes
+     * are visited by consecutive samples */
+    for (s = 0; s < n; ++s) {
+        nodes[s] = T->root;
+    }
+    while (is_moving) {
+        is_moving = 0;
+        for (s = 0; s < n; ++s) {
+            const Data D = binary_tree_node_get_data(nodes[s]);
+            if (D->type == DECISION_TREE_UNIVARIATE_LINEAR_SPLIT) {
+                nodes[s] = columns[D->data.univariate_linear_split.i][first + s * step] <= D->data.univariate_linear_split.k
+                         ? binary_tree_node_get_left_child(nodes[s])
+                         : binary_tree_node_get_right_child(nodes[s]);
+                is_moving = 1;
+            }
         }
-        break;
+    }
 
-    case DECISION_TREE_UNIVARIATE_LINEAR_SPLIT:
-        /* Impossible */
-        break;
+    for (s = 0; s < n; ++s) {
+        leaf_decision_function(scores + s * T->n_labels, T, binary_tree_node_get_data(nodes[s]));
     }
 }
 
@@ -741,6 +1397,50 @@ void decision_tree_classify(
 
 
 
+void decision_tree_classify_block(
+    Set *labels,
+    const DecisionTree T,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+) {
+    const unsigned int n_labels = T->n_labels;
+    unsigned int i, s;
+    double max,
+           *scores = (double *) malloc(n * n_labels * sizeof(double));
+    DecisionTreeNode *nodes = (DecisionTreeNode *) malloc(n * sizeof(DecisionTreeNode));
+
+    if (n > 0 && (scores == NULL || nodes == NULL)) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    decision_tree_compute_decision_function_block(scores, nodes, T, columns, first, step, n);
+    for (s = 0; s < n; ++s) {
+        const double *sample_scores = scores + s * n_labels;
+
+        set_clear(labels[s]);
+        max = sample_scores[0];
+        for (i = 1; i < n_labels; ++i) {
+            if (sample_scores[i] > max) {
+                max = sample_scores[i];
+            }
+        }
+
+        for (i = 0; i < n_labels; ++i) {
+            if (sample_scores[i] == max) {
+                set_add_element(labels[s], T->labels[i]);
+            }
+        }
+    }
+
+    free(scores);
+    free(nodes);
+}
+
+
+
 void decision_tree_print(const DecisionTree T, FILE *stream) {
     if (T == NULL) {
         fprintf(stream, "NULL decision tree.\n");
@@ -13,6 +13,7 @@
 
 #include <stdio.h>
 
+#include "type.h"
 #include "set.h"
 #include "binary_tree.h"
 
@@ -42,6 +43,8 @@ struct decision_tree {
     unsigned int space_size;  /**< Size of the feature space. */
     char **labels;            /**< Array of labels. */
     unsigned int n_labels;    /**< Number of labels. */
+    DecisionTreeNode *leaves; /**< Leaves in depth-first pre-order, NULL if
+                                   not computed yet. */
 };
 
 
@@ -72,7 +75,8 @@ struct leaf_logarithmic {
 /** Structure of an univariate linear split. */
 struct univariate_linear_split {
     unsigned int i;  /**< Index of dimension. */
-    double k;        /**< Threshold. */
+    Storage k;       /**< Threshold, rounded downwards. */
+    Storage k_up;    /**< Threshold, rounded upwards. */
 };
     
 
@@ -186,6 +190,9 @@ double *decision_tree_leaf_logarithmic_get_scores(const DecisionTreeNode leaf);
 /**
  * Creates an univariate linear split node in the form \f$x_i \leq k\f$.
  *
+ * Threshold is stored rounded towards \f$-\infty\f$, which leaves the
+ * outcome of the split unchanged for every stored feature value.
+ *
  * @param[out] N Pointer to univariate linear split node to create
  * @param[in] i Index of dimension
  * @param[in] k Threshold
@@ -219,7 +226,10 @@ unsigned int decision_tree_univariate_linear_split_get_index(const DecisionTreeN
 
 
 /**
- * Returns threshold of an univariate linear split.
+ * Returns threshold of an univariate linear split, rounded downwards.
+ *
+ * A stored value goes left if and only if it is not greater than this
+ * threshold.
  *
  * @param[in] N Univariate linear split node
  * @return Threshold of univariate linear split
@@ -227,6 +237,20 @@ unsigned int decision_tree_univariate_linear_split_get_index(const DecisionTreeN
 double decision_tree_univariate_linear_split_get_threshold(const DecisionTreeNode N);
 
 
+/**
+ * Returns threshold of an univariate linear split, rounded upwards.
+ *
+ * Equals #decision_tree_univariate_linear_split_get_threshold unless the
+ * original threshold cannot be stored exactly, in which case it lies
+ * strictly between the two. A region can reach the left child only if
+ * its lowerbound is not greater than this threshold.
+ *
+ * @param[in] N Univariate linear split node
+ * @return Upper threshold of univariate linear split
+ */
+double decision_tree_univariate_linear_split_get_upper_threshold(const DecisionTreeNode N);
+
+
 /**
  * Returns left child of an univariate linear split node.
  *
@@ -451,6 +475,85 @@ char **decision_tree_get_labels_as_array(const DecisionTree T);
 unsigned int decision_tree_get_n_labels(const DecisionTree T);
 
 
+/**
+ * Returns number of leaves in a decision tree.
+ *
+ * @param[in] T Decision tree
+ * @return Number of leaves
+ */
+unsigned int decision_tree_get_n_leaves(const DecisionTree T);
+
+
+/**
+ * Returns leaves of a decision tree, in depth-first pre-order.
+ *
+ * Position of a leaf in the array is its leaf index, as used by code
+ * generated by #forest_c_create.
+ *
+ * @param[in] T Decision tree
+ * @return Array of leaves
+ */
+DecisionTreeNode *decision_tree_get_leaves_as_array(const DecisionTree T);
+
+
+
+/**
+ * Simplifies a decision tree, without changing its decision function.
+ *
+ * Splits sending every sample reaching them the same way are replaced by
+ * the child which is actually reached, and splits whose children are
+ * identical subtrees are replaced by one of them. When bounds are given,
+ * only samples within them are considered, so that the decision function
+ * may change outside them.
+ *
+ * @param[in,out] T Decision tree
+ * @param[in] lower Lower bound of each feature, NULL if unbounded
+ * @param[in] upper Upper bound of each feature, NULL if unbounded
+ * @return Number of removed nodes
+ */
+unsigned int decision_tree_optimize(
+    DecisionTree T,
+    const double *lower,
+    const double *upper
+);
+
+
+/**
+ * Computes a structural hash of a decision tree restricted to a region.
+ *
+ * The hash ignores branches which no sample of the region can take, and
+ * splits whose children have the same hash, thus it is the hash of the
+ * tree #decision_tree_optimize would give for the same bounds. Trees
+ * having the same hash on a region compute the same decision function on
+ * it, up to hash collisions.
+ *
+ * @param[in] T Decision tree
+ * @param[in] lower Lower bound of each feature, NULL if unbounded
+ * @param[in] upper Upper bound of each feature, NULL if unbounded
+ * @return Hash
+ */
+unsigned long long decision_tree_hash(
+    const DecisionTree T,
+    const double *lower,
+    const double *upper
+);
+
+
+
+/**
+ * Updates a hash with the exact structure of a decision tree.
+ *
+ * Unlike #decision_tree_hash, every node is hashed in pre-order, thus
+ * trees having the same hash have the same leaves in the same positions,
+ * up to hash collisions.
+ *
+ * @param[in] T Decision tree
+ * @param[in] hash Hash to update
+ * @return Updated hash
+ */
+unsigned long long decision_tree_hash_structure(const DecisionTree T, const unsigned long long hash);
+
+
 
 /**
  * Computes decision function on a sample.
@@ -466,6 +569,33 @@ void decision_tree_compute_decision_function(
 );
 
 
+/**
+ * Computes decision function on a block of samples stored in column-major
+ * layout.
+ *
+ * Sample s of the block, from 0 to n - 1, has feature j in
+ * columns[j][first + s * step]; its scores are written starting from
+ * scores[s * n_labels].
+ *
+ * @param[out] scores Array of scores, for each sample
+ * @param[out] nodes Array of n nodes, used as working memory
+ * @param[in] T Decision tree
+ * @param[in] columns Feature columns
+ * @param[in] first Position of first sample in columns
+ * @param[in] step Distance between positions of consecutive samples
+ * @param[in] n Number of samples
+ */
+void decision_tree_compute_decision_function_block(
+    double *scores,
+    DecisionTreeNode *nodes,
+    const DecisionTree T,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+);
+
+
 /**
  * Classifies a sample.
  *
@@ -480,6 +610,28 @@ void decision_tree_classify(
 );
 
 
+/**
+ * Classifies a block of samples stored in column-major layout.
+ *
+ * Gives the same labels as #decision_tree_classify on each sample.
+ *
+ * @param[out] labels Array of n #Set of labels, one for each sample
+ * @param[in] T Decision tree
+ * @param[in] columns Feature columns
+ * @param[in] first Position of first sample in columns
+ * @param[in] step Distance between positions of consecutive samples
+ * @param[in] n Number of samples
+ */
+void decision_tree_classify_block(
+    Set *labels,
+    const DecisionTree T,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+);
+
+
 
 /**
  * Prints a decision tree.
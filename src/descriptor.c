@@ -0,0 +1,37 @@
+/**
+ * Implements helpers to transfer buffers through file descriptors.
+ *
+ * @file descriptor.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "descriptor.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+unsigned int descriptor_write_all(const int fd, const void *buffer, size_t size) {
+    const char *position = (const char *) buffer;
+
+    while (size > 0) {
+        const ssize_t n = write(fd, position, size);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return 0;
+        }
+        position += n;
+        size -= n;
+    }
+
+    return 1;
+}
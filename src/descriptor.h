@@ -0,0 +1,26 @@
+/**
+ * Defines helpers to transfer buffers through file descriptors.
+ *
+ * @file descriptor.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef DESCRIPTOR_H
+#define DESCRIPTOR_H
+
+#include <stddef.h>
+
+
+
+/**
+ * Writes a whole buffer to a file descriptor.
+ *
+ * Partial and interrupted writes are resumed until the buffer is written.
+ *
+ * @param[in] fd File descriptor
+ * @param[in] buffer Buffer
+ * @param[in] size Size of buffer
+ * @return 1 if buffer was written, 0 in case of error
+ */
+unsigned int descriptor_write_all(const int fd, const void *buffer, size_t size);
+
+#endif
@@ -9,6 +9,7 @@
  */
 
 #include "forest.h"
+#include "hash.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -19,6 +20,13 @@ struct forest {
     ForestVotingScheme voting_scheme;  /**< Voting scheme. */
     DecisionTree *trees;       /**< Aray of trees. */
     unsigned int n_trees;      /**< Maximum number of trees in the forest. */
+    unsigned int max_n_leaves; /**< Maximum number of leaves in a tree,
+                                    0 if not computed yet. */
+    ForestDecisionFunction decision_function;  /**< Native decision function,
+                                                    NULL if not available. */
+    ForestReachableLeaves reachable_leaves;    /**< Native computation of
+                                                    reachable leaves, NULL if
+                                                    not available. */
 };
 
 
@@ -189,6 +197,9 @@ void forest_create(
     }
     f->n_trees = n_trees;
     f->voting_scheme = voting_scheme;
+    f->max_n_leaves = 0;
+    f->decision_function = NULL;
+    f->reachable_leaves = NULL;
 
     *F = f;
 }
@@ -269,6 +280,28 @@ unsigned int forest_get_n_trees(const Forest F) {
 
 
 
+unsigned int forest_get_max_n_leaves(const Forest F) {
+    unsigned int i;
+
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (F->max_n_leaves == 0) {
+        for (i = 0; i < F->n_trees; ++i) {
+            const unsigned int n_leaves = decision_tree_get_n_leaves(F->trees[i]);
+            if (n_leaves > F->max_n_leaves) {
+                F->max_n_leaves = n_leaves;
+            }
+        }
+    }
+
+    return F->max_n_leaves;
+}
+
+
+
 DecisionTree *forest_get_trees_as_array(const Forest F) {
     if (F == NULL) {
         fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
@@ -294,6 +327,95 @@ void forest_set_voting_scheme(
 
 
 
+void forest_set_decision_function(
+    Forest F,
+    const ForestDecisionFunction decision_function
+) {
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    F->decision_function = decision_function;
+}
+
+
+
+void forest_set_reachable_leaves(
+    Forest F,
+    const ForestReachableLeaves reachable_leaves
+) {
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    F->reachable_leaves = reachable_leaves;
+}
+
+
+
+ForestReachableLeaves forest_get_reachable_leaves(const Forest F) {
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return F->reachable_leaves;
+}
+
+
+
+unsigned long long forest_hash_structure(const Forest F) {
+    unsigned long long hash = HASH_OFFSET;
+    char **labels;
+    unsigned int i;
+
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    labels = forest_get_labels_as_array(F);
+    for (i = 0; i < forest_get_n_labels(F); ++i) {
+        hash = hash_bytes(hash, labels[i], strlen(labels[i]) + 1);
+    }
+    for (i = 0; i < F->n_trees; ++i) {
+        hash = decision_tree_hash_structure(F->trees[i], hash);
+    }
+
+    return hash;
+}
+
+
+
+unsigned int forest_optimize(
+    Forest F,
+    const double *lower,
+    const double *upper
+) {
+    unsigned int i, n_removed = 0;
+
+    if (F == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (F->decision_function != NULL || F->reachable_leaves != NULL) {
+        fprintf(stderr, "[%s: %d] Cannot optimize a forest with native functions.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < F->n_trees; ++i) {
+        n_removed += decision_tree_optimize(F->trees[i], lower, upper);
+    }
+    F->max_n_leaves = 0;
+
+    return n_removed;
+}
+
+
+
 void forest_compute_decision_function(
     double *scores,
     const Forest F,
@@ -304,6 +426,11 @@ void forest_compute_decision_function(
         abort();
     }
 
+    if (F->decision_function != NULL) {
+        F->decision_function(scores, x, F->voting_scheme);
+        return;
+    }
+
     switch (F->voting_scheme) {
         case FOREST_VOTING_MAX:
             decision_function_max(scores, F, x);
@@ -354,6 +481,105 @@ void forest_classify(
 
 
 
+void forest_classify_block(
+    Set *labels,
+    const Forest F,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+) {
+    const unsigned int n_labels = forest_get_n_labels(F),
+                       space_size = forest_get_feature_space_size(F);
+    char ** const labels_array = forest_get_labels_as_array(F);
+    unsigned int i, j, s, t;
+    double max,
+           *scores = (double *) calloc(n * n_labels, sizeof(double)),
+           *tree_scores = (double *) malloc(n * n_labels * sizeof(double)),
+           *x = (double *) malloc(space_size * sizeof(double));
+    DecisionTreeNode *nodes = (DecisionTreeNode *) malloc(n * sizeof(DecisionTreeNode));
+
+    if (x == NULL || (n > 0 && (scores == NULL || tree_scores == NULL || nodes == NULL))) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    /* Native decision function works on rows */
+    if (F->decision_function != NULL) {
+        for (s = 0; s < n; ++s) {
+            for (j = 0; j < space_size; ++j) {
+                x[j] = columns[j][first + s * step];
+            }
+            forest_classify(labels[s], F, x);
+        }
+    }
+
+    /* Visits each tree once for the whole block, accumulating scores in the
+     * same order as forest_compute_decision_function */
+    else {
+        for (t = 0; t < F->n_trees; ++t) {
+            decision_tree_compute_decision_function_block(tree_scores, nodes, F->trees[t], columns, first, step, n);
+            for (s = 0; s < n; ++s) {
+                double * const sample_scores = scores + s * n_labels;
+                const double * const sample_tree_scores = tree_scores + s * n_labels;
+
+                switch (F->voting_scheme) {
+                case FOREST_VOTING_MAX:
+                    max = sample_tree_scores[0];
+                    for (j = 1; j < n_labels; ++j) {
+                        if (sample_tree_scores[j] > max) {
+                            max = sample_tree_scores[j];
+                        }
+                    }
+                    for (j = 0; j < n_labels; ++j) {
+                        if (sample_tree_scores[j] == max) {
+                            sample_scores[j] += 1.0;
+                        }
+                    }
+                    break;
+
+                case FOREST_VOTING_AVERAGE:
+                    for (j = 0; j < n_labels; ++j) {
+                        sample_scores[j] += sample_tree_scores[j] / (double) F->n_trees;
+                    }
+                    break;
+
+                case FOREST_VOTING_SOFTARGMAX:
+                    for (j = 0; j < n_labels; ++j) {
+                        sample_scores[j] += sample_tree_scores[j];
+                    }
+                    break;
+                }
+            }
+        }
+
+        for (s = 0; s < n; ++s) {
+            const double * const sample_scores = scores + s * n_labels;
+
+            set_clear(labels[s]);
+            max = sample_scores[0];
+            for (i = 1; i < n_labels; ++i) {
+                if (sample_scores[i] > max) {
+                    max = sample_scores[i];
+                }
+            }
+
+            for (i = 0; i < n_labels; ++i) {
+                if (sample_scores[i] == max) {
+                    set_add_element(labels[s], labels_array[i]);
+                }
+            }
+        }
+    }
+
+    free(scores);
+    free(tree_scores);
+    free(x);
+    free(nodes);
+}
+
+
+
 void forest_print(const Forest F, FILE *stream) {
     if (F == NULL) {
         fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
@@ -33,6 +33,33 @@ typedef enum {
 } ForestVotingScheme;
 
 
+/**
+ * Type of a native decision function.
+ *
+ * Computes scores of a sample using given voting scheme, as
+ * #forest_compute_decision_function does.
+ */
+typedef void (*ForestDecisionFunction)(
+    double *scores,
+    const double *x,
+    const int voting_scheme
+);
+
+
+/**
+ * Type of a native computation of reachable leaves.
+ *
+ * Writes indices of leaves of a tree reachable from a box, as given by
+ * #decision_tree_get_leaves_as_array, and returns their number. Bounds
+ * of the box are interleaved: \f$l_0, u_0, l_1, u_1, \ldots\f$.
+ */
+typedef unsigned int (*ForestReachableLeaves)(
+    unsigned int *leaves,
+    const unsigned int tree,
+    const double *bounds
+);
+
+
 
 /**
  * Creates a forest.
@@ -107,6 +134,16 @@ ForestVotingScheme forest_get_voting_scheme(const Forest F);
 unsigned int forest_get_n_trees(const Forest F);
 
 
+/**
+ * Returns maximum number of leaves of a tree in the forest.
+ *
+ * @param[in] F Forest
+ * @return Maximum number of leaves in a tree
+ * @note Value is computed on first call and cached.
+ */
+unsigned int forest_get_max_n_leaves(const Forest F);
+
+
 /**
  * Returns tree in a forest as an array.
  *
@@ -129,6 +166,79 @@ void forest_set_voting_scheme(
 );
 
 
+/**
+ * Sets a native decision function.
+ *
+ * Native decision function replaces tree interpretation in concrete
+ * classification, it must compute the very same scores.
+ *
+ * @param[in,out] F Forest
+ * @param[in] decision_function Native decision function, NULL to
+ *            interpret trees
+ * @see #forest_c_create to generate a native decision function
+ */
+void forest_set_decision_function(
+    Forest F,
+    const ForestDecisionFunction decision_function
+);
+
+
+/**
+ * Sets a native computation of reachable leaves.
+ *
+ * @param[in,out] F Forest
+ * @param[in] reachable_leaves Native computation of reachable leaves,
+ *            NULL to interpret trees
+ */
+void forest_set_reachable_leaves(
+    Forest F,
+    const ForestReachableLeaves reachable_leaves
+);
+
+
+/**
+ * Returns native computation of reachable leaves.
+ *
+ * @param[in] F Forest
+ * @return Native computation of reachable leaves, NULL if not available
+ */
+ForestReachableLeaves forest_get_reachable_leaves(const Forest F);
+
+
+/**
+ * Computes the hash of the labels and exact structure of a forest.
+ *
+ * Native functions and decision diagrams generated from a forest refer
+ * to its labels and leaves by position, thus they can be used only with
+ * forests having the same structure hash.
+ *
+ * @param[in] F Forest
+ * @return Hash of forest
+ * @see #decision_tree_hash_structure
+ */
+unsigned long long forest_hash_structure(const Forest F);
+
+
+/**
+ * Simplifies every tree of a forest, without changing its decision
+ * function.
+ *
+ * Must be called before any native function is set, since those refer to
+ * the original leaves.
+ *
+ * @param[in,out] F Forest
+ * @param[in] lower Lower bound of each feature, NULL if unbounded
+ * @param[in] upper Upper bound of each feature, NULL if unbounded
+ * @return Number of removed nodes
+ * @see #decision_tree_optimize for details on simplification and bounds
+ */
+unsigned int forest_optimize(
+    Forest F,
+    const double *lower,
+    const double *upper
+);
+
+
 /**
  * Computes probabilities of classes of a sample.
  *
@@ -159,6 +269,32 @@ void forest_classify(
 );
 
 
+/**
+ * Classifies a block of samples stored in column-major layout.
+ *
+ * Sample s of the block, from 0 to n - 1, has feature j in
+ * columns[j][first + s * step]. Each tree is visited once for the whole
+ * block; labels are the same as those given by #forest_classify on each
+ * sample.
+ *
+ * @param[out] labels Array of n #Set of labels, one for each sample
+ * @param[in] F Forest
+ * @param[in] columns Feature columns
+ * @param[in] first Position of first sample in columns
+ * @param[in] step Distance between positions of consecutive samples
+ * @param[in] n Number of samples
+ */
+void forest_classify_block(
+    Set *labels,
+    const Forest F,
+    const Storage * const *columns,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n
+);
+
+
+
 /**
  * Prints a forest.
  *
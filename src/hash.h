@@ -0,0 +1,48 @@
+/**
+ * Defines FNV-1a hashes of sequences of bytes.
+ *
+ * Every hash written to files or compared across runs, such as hashes of
+ * forests, of samples and of analysis settings, is computed with these
+ * functions, so that they all agree on the same algorithm.
+ *
+ * @file hash.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+
+
+/** Offset basis of FNV-1a hashes, used to start a new hash. */
+#define HASH_OFFSET 14695981039346656037ULL
+
+/** Prime of FNV-1a hashes. */
+#define HASH_PRIME 1099511628211ULL
+
+
+
+/**
+ * Updates a hash with a sequence of bytes.
+ *
+ * @param[in] hash Hash, #HASH_OFFSET to start a new one
+ * @param[in] bytes Bytes
+ * @param[in] size Number of bytes
+ * @return Updated hash
+ */
+static inline unsigned long long hash_bytes(
+    unsigned long long hash,
+    const void *bytes,
+    const size_t size
+) {
+    const unsigned char *b = (const unsigned char *) bytes;
+    size_t i;
+
+    for (i = 0; i < size; ++i) {
+        hash = (hash ^ b[i]) * HASH_PRIME;
+    }
+
+    return hash;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * Implements a histogram of non-negative values.
+ *
+ * Bucket 0 holds values up to #HISTOGRAM_MIN_VALUE, bucket i > 0 holds
+ * values up to \f$HISTOGRAM\_MIN\_VALUE \cdot 2^{i / HISTOGRAM\_SUB\_BUCKETS}\f$,
+ * and the last bucket also holds larger values.
+ *
+ * @file histogram.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#include "histogram.h"
+
+#include <math.h>
+
+
+
+void histogram_init(Histogram *H) {
+    unsigned int i;
+
+    H->n_values = 0;
+    H->sum = 0.0;
+    H->min = 0.0;
+    H->max = 0.0;
+    for (i = 0; i < HISTOGRAM_N_BUCKETS; ++i) {
+        H->counts[i] = 0;
+    }
+}
+
+
+
+void histogram_add(Histogram *H, const double value) {
+    const double v = value > 0.0 ? value : 0.0;
+    unsigned int i = 0;
+
+    if (v > HISTOGRAM_MIN_VALUE) {
+        const double position = ceil(log2(v / HISTOGRAM_MIN_VALUE) * HISTOGRAM_SUB_BUCKETS);
+        i = position < HISTOGRAM_N_BUCKETS - 1 ? (unsigned int) position : HISTOGRAM_N_BUCKETS - 1;
+    }
+
+    ++H->counts[i];
+    H->min = H->n_values == 0 || v < H->min ? v : H->min;
+    H->max = H->n_values == 0 || v > H->max ? v : H->max;
+    H->sum += v;
+    ++H->n_values;
+}
+
+
+
+void histogram_merge(Histogram *H, const Histogram *G) {
+    unsigned int i;
+
+    if (G->n_values == 0) {
+        return;
+    }
+
+    for (i = 0; i < HISTOGRAM_N_BUCKETS; ++i) {
+        H->counts[i] += G->counts[i];
+    }
+    H->min = H->n_values == 0 || G->min < H->min ? G->min : H->min;
+    H->max = H->n_values == 0 || G->max > H->max ? G->max : H->max;
+    H->sum += G->sum;
+    H->n_values += G->n_values;
+}
+
+
+
+double histogram_get_bucket_upper_bound(const unsigned int i) {
+    return HISTOGRAM_MIN_VALUE * exp2((double) i / HISTOGRAM_SUB_BUCKETS);
+}
+
+
+
+double histogram_get_percentile(const Histogram *H, const double p) {
+    const double rank = ceil(p / 100.0 * H->n_values);
+    unsigned long long seen = 0;
+    unsigned int i;
+
+    if (H->n_values == 0) {
+        return 0.0;
+    }
+
+    for (i = 0; i < HISTOGRAM_N_BUCKETS - 1; ++i) {
+        seen += H->counts[i];
+        if (seen > 0 && seen >= rank) {
+            break;
+        }
+    }
+
+    return fmin(fmax(histogram_get_bucket_upper_bound(i), H->min), H->max);
+}
@@ -0,0 +1,90 @@
+/**
+ * Defines a histogram of non-negative values, such as latencies.
+ *
+ * Buckets grow geometrically, each doubling of the value being split into
+ * #HISTOGRAM_SUB_BUCKETS buckets, thus memory is constant and the
+ * relative error of percentiles is bounded by about 9%. Count, sum,
+ * minimum and maximum are kept exactly.
+ *
+ * @file histogram.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+
+/** Upper bound of the first bucket. */
+#define HISTOGRAM_MIN_VALUE 1e-6
+
+/** Number of buckets per doubling of the value. */
+#define HISTOGRAM_SUB_BUCKETS 8
+
+/** Number of buckets, covering values up to about 12 days. */
+#define HISTOGRAM_N_BUCKETS (40 * HISTOGRAM_SUB_BUCKETS + 1)
+
+
+/** Structure of a histogram. */
+struct histogram {
+    unsigned long long n_values;  /**< Number of values. */
+    double sum;                   /**< Sum of values. */
+    double min;                   /**< Minimum value, 0 if empty. */
+    double max;                   /**< Maximum value, 0 if empty. */
+    unsigned long long counts[HISTOGRAM_N_BUCKETS];
+                                  /**< Number of values in each bucket. */
+};
+
+
+/** Type of a histogram. */
+typedef struct histogram Histogram;
+
+
+
+/**
+ * Initializes an empty histogram.
+ *
+ * @param[out] H Histogram
+ */
+void histogram_init(Histogram *H);
+
+
+/**
+ * Adds a value to a histogram.
+ *
+ * @param[in,out] H Histogram
+ * @param[in] value Value, negative values count as 0
+ */
+void histogram_add(Histogram *H, const double value);
+
+
+/**
+ * Adds values of a histogram to another one.
+ *
+ * @param[in,out] H Histogram
+ * @param[in] G Histogram to add
+ */
+void histogram_merge(Histogram *H, const Histogram *G);
+
+
+
+/**
+ * Returns upper bound of a bucket.
+ *
+ * @param[in] i Index of bucket
+ * @return Upper bound of bucket, values in it are less than or equal to it
+ */
+double histogram_get_bucket_upper_bound(const unsigned int i);
+
+
+/**
+ * Returns a percentile of the values of a histogram.
+ *
+ * The result is the upper bound of the bucket holding the percentile,
+ * clamped between minimum and maximum value.
+ *
+ * @param[in] H Histogram
+ * @param[in] p Percentile, between 0 and 100
+ * @return Percentile, 0 if histogram is empty
+ */
+double histogram_get_percentile(const Histogram *H, const double p);
+
+#endif
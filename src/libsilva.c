@@ -0,0 +1,330 @@
+/**
+ * Embeddable silva library.
+ *
+ * @file libsilva.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "libsilva.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "classifier.h"
+#include "data_mappers/classifier_silva.h"
+#include "abstract_interpreters/abstract_classifier.h"
+
+
+
+/***********************************************************************
+ * Data structures.
+ **********************************************************************/
+
+/** Structure of a model. */
+struct silva_model {
+    Classifier classifier;                   /**< Concrete classifier. */
+    AbstractClassifier abstract_classifier;  /**< Abstract classifier. */
+    Tier tier;                               /**< Feature tiers (none). */
+    char **labels;                           /**< Array of labels. */
+    unsigned int space_size;                 /**< Size of feature space. */
+    unsigned int n_labels;                   /**< Number of labels. */
+};
+
+
+/** Structure of an analysis context. */
+struct silva_context {
+    SilvaModel model;          /**< Analysed model. */
+    double *sample;            /**< Copy of current sample. */
+    Set labels;                /**< Concrete labels of current sample. */
+    StabilityStatus status;    /**< Status of current analysis. */
+    Cascade cascade;           /**< Cascade configuration. */
+    SilvaStats stats;          /**< Statistics. */
+};
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+int silva_model_load(SilvaModel *M, const char *path) {
+    SilvaModel m;
+    FILE *stream;
+    AbstractDomain domain;
+
+    stream = fopen(path, "r");
+    if (stream == NULL) {
+        return -1;
+    }
+
+    m = (SilvaModel) malloc(sizeof(struct silva_model));
+    if (m == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    classifier_silva_read(&m->classifier, stream);
+    fclose(stream);
+
+    /* Computes lazily cached data before contexts share the forest */
+    if (classifier_get_type(m->classifier) == CLASSIFIER_FOREST) {
+        forest_get_max_n_leaves(classifier_get_forest(m->classifier));
+    }
+
+    domain.type = DOMAIN_HYPERRECTANGLE;
+    m->tier.size = 0;
+    m->tier.tiers = NULL;
+    abstract_classifier_create(&m->abstract_classifier, m->classifier, domain, &m->tier);
+
+    m->labels = classifier_get_labels_as_array(m->classifier);
+    m->space_size = classifier_get_feature_space_size(m->classifier);
+    m->n_labels = classifier_get_n_labels(m->classifier);
+
+    *M = m;
+    return 0;
+}
+
+
+
+void silva_model_delete(SilvaModel *M) {
+    abstract_classifier_delete(&(*M)->abstract_classifier);
+    tier_delete(&(*M)->tier);
+    classifier_delete(&(*M)->classifier);
+    free(*M);
+    *M = NULL;
+}
+
+
+
+void silva_model_set_voting_scheme(SilvaModel M, const SilvaVotingScheme voting_scheme) {
+    if (M == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (classifier_get_type(M->classifier) != CLASSIFIER_FOREST) {
+        return;
+    }
+
+    switch (voting_scheme) {
+    case SILVA_VOTING_MAX:
+        forest_set_voting_scheme(classifier_get_forest(M->classifier), FOREST_VOTING_MAX);
+        break;
+    case SILVA_VOTING_AVERAGE:
+        forest_set_voting_scheme(classifier_get_forest(M->classifier), FOREST_VOTING_AVERAGE);
+        break;
+    case SILVA_VOTING_SOFTARGMAX:
+        forest_set_voting_scheme(classifier_get_forest(M->classifier), FOREST_VOTING_SOFTARGMAX);
+        break;
+    }
+}
+
+
+
+unsigned int silva_model_get_feature_space_size(const SilvaModel M) {
+    return M->space_size;
+}
+
+
+
+unsigned int silva_model_get_n_labels(const SilvaModel M) {
+    return M->n_labels;
+}
+
+
+
+const char *silva_model_get_label(const SilvaModel M, const unsigned int i) {
+    if (i >= M->n_labels) {
+        fprintf(stderr, "[%s: %d] Index out of bounds.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return M->labels[i];
+}
+
+
+
+void silva_context_create(SilvaContext *C, const SilvaModel M) {
+    SilvaContext c;
+
+    if (M == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    c = (SilvaContext) malloc(sizeof(struct silva_context));
+    if (c == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    c->model = M;
+    c->sample = (double *) malloc(M->space_size * sizeof(double));
+    c->status.sample_b = (double *) malloc(M->space_size * sizeof(double));
+    if (c->sample == NULL || c->status.sample_b == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    hyperrectangle_create(&c->status.region, M->space_size);
+    set_create(&c->labels, set_equality_string);
+    c->status.timeout = SILVA_DEFAULT_TIMEOUT;
+    c->status.cascade = NULL;
+    c->status.profiler = NULL;
+    c->status.trace = NULL;
+    c->status.memory_limit = 0;
+    cascade_init(&c->cascade, 0, SILVA_DEFAULT_CASCADE_SAMPLES, SILVA_DEFAULT_CASCADE_BUDGET);
+    silva_context_reset_stats(c);
+
+    *C = c;
+}
+
+
+
+void silva_context_delete(SilvaContext *C) {
+    hyperrectangle_delete(&(*C)->status.region);
+    set_delete(&(*C)->labels);
+    free((*C)->status.sample_b);
+    free((*C)->sample);
+    free(*C);
+    *C = NULL;
+}
+
+
+
+void silva_context_set_timeout(SilvaContext C, const unsigned int timeout) {
+    C->status.timeout = timeout;
+}
+
+
+
+void silva_context_set_memory_limit(SilvaContext C, const unsigned int memory_limit) {
+    C->status.memory_limit = (size_t) memory_limit << 20;
+}
+
+
+
+void silva_context_set_cascade(
+    SilvaContext C,
+    const unsigned int enabled,
+    const unsigned int n_attack_samples,
+    const unsigned int budget
+) {
+    cascade_init(&C->cascade, enabled, n_attack_samples, budget);
+    C->status.cascade = enabled ? &C->cascade : NULL;
+}
+
+
+
+void silva_verify(
+    SilvaContext C,
+    SilvaResult *result,
+    const double *sample,
+    const double magnitude,
+    unsigned char *labels,
+    double *counterexample
+) {
+    const SilvaModel M = C->model;
+    const Perturbation perturbation = {PERTURBATION_L_INF, {{magnitude}}};
+    const AdversarialRegion region = {C->sample, M->space_size, perturbation};
+    struct timespec start, end;
+    unsigned int i;
+
+    if (result == NULL || sample == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+
+    /* Runs analysis */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memcpy(C->sample, sample, M->space_size * sizeof(double));
+    stability_status_set_sample(&C->status, C->sample, C->labels);
+    classifier_classify(C->labels, M->classifier, C->sample);
+    abstract_classifier_is_stable(&C->status, M->abstract_classifier, region);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+
+    /* Fills result */
+    switch (C->status.result) {
+    case STABILITY_TRUE:
+        result->verdict = SILVA_STABLE;
+        ++C->stats.n_stable;
+        break;
+    case STABILITY_FALSE:
+        result->verdict = SILVA_UNSTABLE;
+        ++C->stats.n_unstable;
+        break;
+    default:
+        result->verdict = SILVA_UNKNOWN;
+        ++C->stats.n_unknown;
+        break;
+    }
+
+    result->label = -1;
+    for (i = 0; i < M->n_labels; ++i) {
+        const unsigned int is_concrete = set_has_element(C->labels, M->labels[i]);
+        if (labels != NULL) {
+            labels[i] = is_concrete;
+        }
+        if (is_concrete && set_is_singleton(C->labels)) {
+            result->label = (int) i;
+        }
+    }
+
+    if (counterexample != NULL && C->status.result == STABILITY_FALSE) {
+        for (i = 0; i < M->space_size; ++i) {
+            counterexample[2 * i] = C->status.region->intervals[i].l;
+            counterexample[2 * i + 1] = C->status.region->intervals[i].u;
+        }
+    }
+
+    result->time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    ++C->stats.n_samples;
+    C->stats.time += result->time;
+}
+
+
+
+void silva_verify_batch(
+    SilvaContext C,
+    SilvaResult *results,
+    const double *samples,
+    const unsigned int n_samples,
+    const double magnitude,
+    unsigned char *labels,
+    double *counterexamples
+) {
+    const unsigned int space_size = C->model->space_size,
+                       n_labels = C->model->n_labels;
+    unsigned int i;
+
+    for (i = 0; i < n_samples; ++i) {
+        silva_verify(
+            C,
+            results + i,
+            samples + i * space_size,
+            magnitude,
+            labels != NULL ? labels + i * n_labels : NULL,
+            counterexamples != NULL ? counterexamples + 2 * i * space_size : NULL
+        );
+    }
+}
+
+
+
+void silva_context_get_stats(const SilvaContext C, SilvaStats *stats) {
+    *stats = C->stats;
+}
+
+
+
+void silva_context_reset_stats(SilvaContext C) {
+    C->stats.n_samples = 0;
+    C->stats.n_stable = 0;
+    C->stats.n_unstable = 0;
+    C->stats.n_unknown = 0;
+    C->stats.time = 0.0;
+}
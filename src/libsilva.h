@@ -0,0 +1,285 @@
+/**
+ * Embeddable silva library.
+ *
+ * Verifies stability of decision trees and forests in-process. A model
+ * is loaded once and may then be shared, read-only, by any number of
+ * analysis contexts; each context owns every buffer it needs, so that
+ * distinct contexts can be used concurrently from distinct threads.
+ *
+ * Typical usage:
+ * @code
+ * SilvaModel model;
+ * SilvaContext context;
+ * SilvaResult result;
+ *
+ * silva_model_load(&model, "my_classifier.silva");
+ * silva_context_create(&context, model);
+ * silva_verify(context, &result, sample, 0.05, NULL, NULL);
+ * silva_context_delete(&context);
+ * silva_model_delete(&model);
+ * @endcode
+ *
+ * @file libsilva.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef LIBSILVA_H
+#define LIBSILVA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** Default maximum analysis time per sample, in seconds. */
+#define SILVA_DEFAULT_TIMEOUT 1
+
+/** Default number of random points tried by the cascade attack stage. */
+#define SILVA_DEFAULT_CASCADE_SAMPLES 16
+
+/** Default refinement budget of the cascade bounded search stage. */
+#define SILVA_DEFAULT_CASCADE_BUDGET 64
+
+
+/** Type of a model. */
+typedef struct silva_model *SilvaModel;
+
+/** Type of an analysis context. */
+typedef struct silva_context *SilvaContext;
+
+
+/** Voting schemes of forests. */
+typedef enum {
+    SILVA_VOTING_MAX,        /**< Labels getting more votes. */
+    SILVA_VOTING_AVERAGE,    /**< Labels with maximal average probability. */
+    SILVA_VOTING_SOFTARGMAX  /**< Labels with maximal softargmax score. */
+} SilvaVotingScheme;
+
+
+/** Verdicts of an analysis. */
+typedef enum {
+    SILVA_STABLE,    /**< Every point in the region gets the labels of the
+                          sample. */
+    SILVA_UNSTABLE,  /**< Some point in the region gets different labels. */
+    SILVA_UNKNOWN    /**< Analysis was inconclusive. */
+} SilvaVerdict;
+
+
+/** Result of the analysis of a sample. */
+typedef struct {
+    SilvaVerdict verdict;  /**< Verdict. */
+    int label;             /**< Index of the concrete label of the sample,
+                                -1 if several labels tie. */
+    double time;           /**< Analysis time, in seconds. */
+} SilvaResult;
+
+
+/** Statistics of an analysis context. */
+typedef struct {
+    unsigned int n_samples;   /**< Number of analysed samples. */
+    unsigned int n_stable;    /**< Number of stable samples. */
+    unsigned int n_unstable;  /**< Number of unstable samples. */
+    unsigned int n_unknown;   /**< Number of inconclusive analyses. */
+    double time;              /**< Total analysis time, in seconds. */
+} SilvaStats;
+
+
+
+/***********************************************************************
+ * Models.
+ **********************************************************************/
+
+/**
+ * Loads a model from a file in silva format.
+ *
+ * @param[out] M Pointer to model to create
+ * @param[in] path Path to model file
+ * @return 0 in case of success, -1 if file cannot be opened
+ * @warning #silva_model_delete should be called to ensure proper memory
+ *          deallocation.
+ * @note As the rest of silva, aborts on malformed files.
+ */
+int silva_model_load(SilvaModel *M, const char *path);
+
+
+/**
+ * Deletes a model.
+ *
+ * @param[out] M Pointer to model to delete
+ * @warning Every context using the model must be deleted before.
+ */
+void silva_model_delete(SilvaModel *M);
+
+
+/**
+ * Sets voting scheme of a forest model.
+ *
+ * @param[in,out] M Model
+ * @param[in] voting_scheme Voting scheme
+ * @warning Must not be called while contexts use the model.
+ * @note Has no effect on decision trees.
+ */
+void silva_model_set_voting_scheme(SilvaModel M, const SilvaVotingScheme voting_scheme);
+
+
+/**
+ * Returns size of the feature space of a model.
+ *
+ * @param[in] M Model
+ * @return Number of features
+ */
+unsigned int silva_model_get_feature_space_size(const SilvaModel M);
+
+
+/**
+ * Returns number of labels of a model.
+ *
+ * @param[in] M Model
+ * @return Number of labels
+ */
+unsigned int silva_model_get_n_labels(const SilvaModel M);
+
+
+/**
+ * Returns name of a label.
+ *
+ * @param[in] M Model
+ * @param[in] i Index of label
+ * @return Name of label
+ */
+const char *silva_model_get_label(const SilvaModel M, const unsigned int i);
+
+
+
+/***********************************************************************
+ * Analysis contexts.
+ **********************************************************************/
+
+/**
+ * Creates an analysis context.
+ *
+ * Default context has a timeout of #SILVA_DEFAULT_TIMEOUT seconds, no
+ * memory limit and no cascade.
+ *
+ * @param[out] C Pointer to context to create
+ * @param[in] M Model to analyse
+ * @warning #silva_context_delete should be called to ensure proper memory
+ *          deallocation.
+ */
+void silva_context_create(SilvaContext *C, const SilvaModel M);
+
+
+/**
+ * Deletes an analysis context.
+ *
+ * @param[out] C Pointer to context to delete
+ */
+void silva_context_delete(SilvaContext *C);
+
+
+/**
+ * Sets maximum analysis time per sample.
+ *
+ * @param[in,out] C Context
+ * @param[in] timeout Timeout, in seconds
+ */
+void silva_context_set_timeout(SilvaContext C, const unsigned int timeout);
+
+
+/**
+ * Sets maximum memory held by the search of each sample, which is
+ * otherwise inconclusive.
+ *
+ * @param[in,out] C Context
+ * @param[in] memory_limit Memory limit, in megabytes, 0 for no limit
+ */
+void silva_context_set_memory_limit(SilvaContext C, const unsigned int memory_limit);
+
+
+/**
+ * Enables or disables the staged analysis cascade.
+ *
+ * @param[in,out] C Context
+ * @param[in] enabled 1 to enable cascade, 0 to disable it
+ * @param[in] n_attack_samples Number of random points tried by the attack
+ * @param[in] budget Refinement budget of the bounded search
+ * @note Attack draws random points with rand().
+ */
+void silva_context_set_cascade(
+    SilvaContext C,
+    const unsigned int enabled,
+    const unsigned int n_attack_samples,
+    const unsigned int budget
+);
+
+
+/**
+ * Verifies stability of a sample under an \f$L_\infty\f$ perturbation.
+ *
+ * @param[in,out] C Context
+ * @param[out] result Result
+ * @param[in] sample Sample, having one value per feature
+ * @param[in] magnitude Radius of the \f$L_\infty\f$ ball
+ * @param[out] labels If not NULL, one flag per label, set to 1 for each
+ *             concrete label of the sample
+ * @param[out] counterexample If not NULL and the sample is unstable,
+ *             receives bounds of an adversarial box, interleaved as
+ *             \f$l_0, u_0, l_1, u_1, \ldots\f$
+ */
+void silva_verify(
+    SilvaContext C,
+    SilvaResult *result,
+    const double *sample,
+    const double magnitude,
+    unsigned char *labels,
+    double *counterexample
+);
+
+
+/**
+ * Verifies stability of a batch of samples.
+ *
+ * Samples, labels and counterexamples are stored row-major, one row per
+ * sample, with the sizes of #silva_verify.
+ *
+ * @param[in,out] C Context
+ * @param[out] results Array of n_samples results
+ * @param[in] samples Samples
+ * @param[in] n_samples Number of samples
+ * @param[in] magnitude Radius of the \f$L_\infty\f$ ball
+ * @param[out] labels Concrete labels, or NULL
+ * @param[out] counterexamples Counterexamples, or NULL
+ */
+void silva_verify_batch(
+    SilvaContext C,
+    SilvaResult *results,
+    const double *samples,
+    const unsigned int n_samples,
+    const double magnitude,
+    unsigned char *labels,
+    double *counterexamples
+);
+
+
+/**
+ * Reads statistics of a context.
+ *
+ * @param[in] C Context
+ * @param[out] stats Statistics of every sample verified since creation or
+ *             last reset
+ */
+void silva_context_get_stats(const SilvaContext C, SilvaStats *stats);
+
+
+/**
+ * Resets statistics of a context.
+ *
+ * @param[in,out] C Context
+ */
+void silva_context_reset_stats(SilvaContext C);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -152,6 +152,17 @@ unsigned int list_get_size(const List L) {
 
 
 
+size_t list_get_memory_size(const List L) {
+    if (L == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return sizeof(struct list) + L->capacity * sizeof(void *);
+}
+
+
+
 void *list_get_at(const List L, const unsigned int i) {
     if (L == NULL) {
         fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
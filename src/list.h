@@ -80,6 +80,15 @@ unsigned int list_is_empty(const List L);
 unsigned int list_get_size(const List L);
 
 
+/**
+ * Returns memory held by a list, element buffer included.
+ *
+ * @param[in] L List
+ * @return Size of list (bytes)
+ */
+size_t list_get_memory_size(const List L);
+
+
 /**
  * Returns element at given position.
  *
@@ -12,6 +12,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "option.h"
+#include "libsilva.h"
+
 
 /** Minimum number of characters to print */
 #define MIN_PRINT_LENGTH 8
@@ -22,12 +25,11 @@
 /** Default value for voting scheme */
 #define VOTING_SCHEME FOREST_VOTING_MAX
 
-/** Default timeout (per sample) */
-#define SAMPLE_TIMEOUT 1
-
 /** Default random seed */
 #define SEED 42
 
+/** Maximum number of tokens in the value of a jobs file option */
+#define MAX_VALUE_TOKENS 32
 
 
 /***********************************************************************
@@ -152,6 +154,7 @@ static void read_tiers(
     unsigned int j, size;
     (void) argc;
     sscanf(argv[*i], "%u", &size);
+    tier_delete(&options->tier);
     tier_create(&options->tier, size);
     for (j = 0; j < size; ++j) {
         sscanf(argv[*i + 1 + j], "%u", options->tier.tiers + j);
@@ -160,6 +163,121 @@ static void read_tiers(
 }
 
 
+/**
+ * Reads shard, as K/N.
+ *
+ * @param[out] options Options
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @param[in,out] i Pointer to current position in the argument vector
+ */
+static void read_shard(
+    Options *options,
+    const int argc,
+    const char *argv[],
+    int *i
+) {
+    (void) argc;
+
+    if (sscanf(argv[*i], "%u/%u", &options->shard_index, &options->n_shards) != 2
+        || options->n_shards == 0
+        || options->shard_index >= options->n_shards) {
+        fprintf(stderr, "[%s: %d] Unsupported shard.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Reads shard layout.
+ *
+ * @param[out] options Options
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @param[in,out] i Pointer to current position in the argument vector
+ */
+static void read_shard_layout(
+    Options *options,
+    const int argc,
+    const char *argv[],
+    int *i
+) {
+    (void) argc;
+
+    if (strcmp(argv[*i], "stride") == 0) {
+        options->shard_layout = SHARD_STRIDE;
+    }
+    else if (strcmp(argv[*i], "range") == 0) {
+        options->shard_layout = SHARD_RANGE;
+    }
+    else {
+        fprintf(stderr, "[%s: %d] Unsupported shard layout.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Reads schedule of samples.
+ *
+ * @param[out] options Options
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @param[in,out] i Pointer to current position in the argument vector
+ */
+static void read_schedule(
+    Options *options,
+    const int argc,
+    const char *argv[],
+    int *i
+) {
+    (void) argc;
+
+    if (strcmp(argv[*i], "dataset") == 0) {
+        options->schedule = SCHEDULE_DATASET;
+    }
+    else if (strcmp(argv[*i], "hardest-first") == 0) {
+        options->schedule = SCHEDULE_HARDEST_FIRST;
+    }
+    else {
+        fprintf(stderr, "[%s: %d] Unsupported schedule.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Reads layout of dataset features.
+ *
+ * @param[out] options Options
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @param[in,out] i Pointer to current position in the argument vector
+ */
+static void read_data_layout(
+    Options *options,
+    const int argc,
+    const char *argv[],
+    int *i
+) {
+    (void) argc;
+
+    if (strcmp(argv[*i], "rows") == 0) {
+        options->data_layout = DATA_LAYOUT_ROWS;
+    }
+    else if (strcmp(argv[*i], "columns") == 0) {
+        options->data_layout = DATA_LAYOUT_COLUMNS;
+    }
+    else {
+        fprintf(stderr, "[%s: %d] Unsupported data layout.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
 /***********************************************************************
  * Public functions.
  **********************************************************************/
@@ -174,23 +292,73 @@ void options_delete(Options *options) {
 void options_read(Options *options, const int argc, const char *argv[]) {
     int i;
 
-    options->classifier_path = (char *) argv[1];
-    options->dataset_path = (char *) argv[2];
+    if (strcmp(argv[1], "--jobs-file") == 0) {
+        options->jobs_path = (char *) argv[2];
+        options->classifier_path = NULL;
+        options->dataset_path = NULL;
+    }
+    else {
+        options->jobs_path = NULL;
+        options->classifier_path = (char *) argv[1];
+        options->dataset_path = (char *) argv[2];
+    }
     options->counterexamples_path = NULL;
+    options->compiled_model_path = NULL;
+    options->diagram_path = NULL;
+    options->record_path = NULL;
+    options->trace_path = NULL;
+    options->summary_json_path = NULL;
+    options->trace = NULL;
+    options->progress_path = NULL;
+    options->progress_interval = 0.0;
     options->max_print_length = MAX_PRINT_LENGTH;
     options->voting_scheme = VOTING_SCHEME;
     options->perturbation.type = PERTURBATION_L_INF;
     options->perturbation.data.l_inf.magnitude = 0.0;
     options->tier.size = 0;
-    options->sample_timeout = SAMPLE_TIMEOUT;
+    options->tier.tiers = NULL;
+    options->sample_timeout = SILVA_DEFAULT_TIMEOUT;
+    options->sample_memory_limit = 0;
     options->abstract_domain.type = DOMAIN_HYPERRECTANGLE;
     options->seed = SEED;
+    cascade_init(&options->cascade, 0, SILVA_DEFAULT_CASCADE_SAMPLES, SILVA_DEFAULT_CASCADE_BUDGET);
+    profiler_init(&options->profiler, 0);
+    options->shard_index = 0;
+    options->n_shards = 1;
+    options->shard_layout = SHARD_STRIDE;
+    options->n_processes = 1;
+    options->schedule = SCHEDULE_HARDEST_FIRST;
+    options->data_layout = DATA_LAYOUT_ROWS;
+    options->optimize = 0;
+    options->has_input_bounds = 0;
+    options->input_lower = 0.0;
+    options->input_upper = 0.0;
 
     for (i = 3; i < argc; ++i) {
         if (strcmp(argv[i], "--counterexamples") == 0 && i + 1 < argc) {
             ++i;
             options->counterexamples_path = (char *) argv[i];
         }
+        else if (strcmp(argv[i], "--compiled-model") == 0 && i + 1 < argc) {
+            ++i;
+            options->compiled_model_path = (char *) argv[i];
+        }
+        else if (strcmp(argv[i], "--diagram") == 0 && i + 1 < argc) {
+            ++i;
+            options->diagram_path = (char *) argv[i];
+        }
+        else if (strcmp(argv[i], "--summary-json") == 0 && i + 1 < argc) {
+            ++i;
+            options->summary_json_path = (char *) argv[i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            ++i;
+            options->trace_path = (char *) argv[i];
+        }
+        else if (strcmp(argv[i], "--incremental") == 0 && i + 1 < argc) {
+            ++i;
+            options->record_path = (char *) argv[i];
+        }
         else if (strcmp(argv[i], "--max-print-length") == 0 && i + 1 < argc) {
             ++i;
             sscanf(argv[i], "%u", &options->max_print_length);
@@ -218,10 +386,68 @@ void options_read(Options *options, const int argc, const char *argv[]) {
             ++i;
             sscanf(argv[i], "%u", &options->sample_timeout);
         }
+        else if (strcmp(argv[i], "--sample-memory-limit") == 0 && i + 1 < argc) {
+            ++i;
+            sscanf(argv[i], "%u", &options->sample_memory_limit);
+        }
         else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
             ++i;
             sscanf(argv[i], "%u", &options->seed);
         }
+        else if (strcmp(argv[i], "--cascade") == 0) {
+            options->cascade.enabled = 1;
+        }
+        else if (strcmp(argv[i], "--cascade-samples") == 0 && i + 1 < argc) {
+            ++i;
+            sscanf(argv[i], "%u", &options->cascade.n_attack_samples);
+        }
+        else if (strcmp(argv[i], "--cascade-budget") == 0 && i + 1 < argc) {
+            ++i;
+            sscanf(argv[i], "%u", &options->cascade.budget);
+        }
+        else if (strcmp(argv[i], "--progress-interval") == 0 && i + 1 < argc) {
+            ++i;
+            sscanf(argv[i], "%lf", &options->progress_interval);
+        }
+        else if (strcmp(argv[i], "--progress-file") == 0 && i + 1 < argc) {
+            ++i;
+            options->progress_path = (char *) argv[i];
+        }
+        else if (strcmp(argv[i], "--profile") == 0) {
+            options->profiler.enabled = 1;
+        }
+        else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            ++i;
+            read_shard(options, argc, argv, &i);
+        }
+        else if (strcmp(argv[i], "--shard-layout") == 0 && i + 1 < argc) {
+            ++i;
+            read_shard_layout(options, argc, argv, &i);
+        }
+        else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc) {
+            ++i;
+            sscanf(argv[i], "%u", &options->n_processes);
+            if (options->n_processes == 0) {
+                options->n_processes = 1;
+            }
+        }
+        else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc) {
+            ++i;
+            read_schedule(options, argc, argv, &i);
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            ++i;
+            read_data_layout(options, argc, argv, &i);
+        }
+        else if (strcmp(argv[i], "--optimize") == 0) {
+            options->optimize = 1;
+        }
+        else if (strcmp(argv[i], "--input-bounds") == 0 && i + 2 < argc) {
+            options->has_input_bounds = 1;
+            sscanf(argv[i + 1], "%lf", &options->input_lower);
+            sscanf(argv[i + 2], "%lf", &options->input_upper);
+            i += 2;
+        }
     }
 
     srand(options->seed);
@@ -229,27 +455,128 @@ void options_read(Options *options, const int argc, const char *argv[]) {
 
 
 
+void options_set(Options *options, const char *name, const char *value) {
+    char buffer[OPTION_VALUE_SIZE];
+    const char *tokens[MAX_VALUE_TOKENS];
+    int n_tokens = 0, i = 0;
+
+    /* Splits value into tokens, as if read from command-line */
+    strncpy(buffer, value, OPTION_VALUE_SIZE - 1);
+    buffer[OPTION_VALUE_SIZE - 1] = '\0';
+    tokens[n_tokens] = strtok(buffer, " \t");
+    while (tokens[n_tokens] != NULL && n_tokens + 1 < MAX_VALUE_TOKENS) {
+        ++n_tokens;
+        tokens[n_tokens] = strtok(NULL, " \t");
+    }
+    if (n_tokens == 0) {
+        fprintf(stderr, "[%s: %d] Missing value of option %s.\n", __FILE__, __LINE__, name);
+        abort();
+    }
+
+    if (strcmp(name, "classifier") == 0) {
+        options->classifier_path = (char *) value;
+    }
+    else if (strcmp(name, "dataset") == 0) {
+        options->dataset_path = (char *) value;
+    }
+    else if (strcmp(name, "counterexamples") == 0) {
+        options->counterexamples_path = (char *) value;
+    }
+    else if (strcmp(name, "voting") == 0) {
+        read_voting_scheme(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "abstraction") == 0) {
+        read_abstraction(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "perturbation") == 0) {
+        read_perturbation(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "tiers") == 0) {
+        read_tiers(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "sample-timeout") == 0) {
+        sscanf(tokens[0], "%u", &options->sample_timeout);
+    }
+    else if (strcmp(name, "sample-memory-limit") == 0) {
+        sscanf(tokens[0], "%u", &options->sample_memory_limit);
+    }
+    else if (strcmp(name, "cascade") == 0) {
+        options->cascade.enabled = strcmp(tokens[0], "true") == 0;
+    }
+    else if (strcmp(name, "cascade-samples") == 0) {
+        sscanf(tokens[0], "%u", &options->cascade.n_attack_samples);
+    }
+    else if (strcmp(name, "cascade-budget") == 0) {
+        sscanf(tokens[0], "%u", &options->cascade.budget);
+    }
+    else if (strcmp(name, "shard") == 0) {
+        read_shard(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "shard-layout") == 0) {
+        read_shard_layout(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "processes") == 0) {
+        sscanf(tokens[0], "%u", &options->n_processes);
+        if (options->n_processes == 0) {
+            options->n_processes = 1;
+        }
+    }
+    else if (strcmp(name, "schedule") == 0) {
+        read_schedule(options, n_tokens, tokens, &i);
+    }
+    else if (strcmp(name, "layout") == 0) {
+        read_data_layout(options, n_tokens, tokens, &i);
+    }
+    else {
+        fprintf(stderr, "[%s: %d] Unsupported option %s.\n", __FILE__, __LINE__, name);
+        abort();
+    }
+}
+
+
+
 void display_help(const int argc, const char *argv[]) {
     (void) argc;
     (void) argv;
 
     printf("Usage: %s <classifier> <dataset> [options]\n", argv[0]);
+    printf("       %s --jobs-file <path> [options]\n", argv[0]);
     printf("Verifies robustness of a decision tree or forest classifier on a dataset.\n\n");
 
     printf("Mandatory arguments:\n");
     printf("\t%-16s Path to classifier file, in silva format\n", "classifier");
     printf("\t%-16s Path to dataset file (CSV or binary)\n", "dataset");
+    printf("\t%-16s Path to jobs file, replacing classifier and dataset\n", "--jobs-file");
     printf("\n");
 
     printf("Optional arguments:\n");
     printf("\t%-32s Maximum number of characters to print for long strings, -1 to disable limit (deafult: %u)\n", "--max-print-length VALUE", MAX_PRINT_LENGTH);
     printf("\t%-32s Path to counterexamples file (default: null, no file will be generated)\n", "--counterexamples <path>");
+    printf("\t%-32s Shared object generated by silva-compile, used for concrete classification (default: null, trees are interpreted)\n", "--compiled-model <path>");
+    printf("\t%-32s Decision diagram generated by silva-compile --diagram, used to check stability (default: null, search is used)\n", "--diagram <path>");
+    printf("\t%-32s Record of previous run, reused for samples not affected by changed trees and rewritten (default: null, every sample is analysed)\n", "--incremental <path>");
     printf("\t%-32s Voting scheme to use for forests (default: max)\n", "--voting {max | average | softargmax}");
     printf("\t%-32s Abstract domain to use (default: hyperrectangle)\n", "--abstraction {interval | hyperrectangle}");
     printf("\t%-32s Perturbation to analyse, followed by perturbation-specific options (default: l_inf 0)\n", "--perturbation {l_inf, from-file} [DATA]");
     printf("\t%-32s Tier list of features\n", "--tiers N VALUE...");
-    printf("\t%-32s Maximum allowed execution time for each sample analysis, in seconds (default: %u)\n", "--sample-timeout VALUE", SAMPLE_TIMEOUT);
-    printf("\t%-32s Seed to use for random number generation, reserved for future use (default: %u)\n", "--seed VALUE", SEED);
+    printf("\t%-32s Maximum allowed execution time for each sample analysis, in seconds (default: %u)\n", "--sample-timeout VALUE", SILVA_DEFAULT_TIMEOUT);
+    printf("\t%-32s Maximum memory held by the search of each sample, in megabytes; exceeding it gives NO-INFO (default: 0, no limit)\n", "--sample-memory-limit VALUE");
+    printf("\t%-32s Seed to use for random number generation (default: %u)\n", "--seed VALUE", SEED);
+    printf("\t%-32s Analyses each sample with a cascade: concrete attack, interval check, bounded search, full search; the attack breaks near ties the search keeps\n", "--cascade");
+    printf("\t%-32s Number of random points tried by the cascade attack stage (default: %u)\n", "--cascade-samples VALUE", SILVA_DEFAULT_CASCADE_SAMPLES);
+    printf("\t%-32s Maximum number of refinements of the cascade bounded search stage (default: %u)\n", "--cascade-budget VALUE", SILVA_DEFAULT_CASCADE_BUDGET);
+    printf("\t%-32s Prints wall and CPU time spent in each phase of the run after the summary\n", "--profile");
+    printf("\t%-32s Prints a progress snapshot every VALUE seconds, and on SIGUSR1 (default: 0, on SIGUSR1 only)\n", "--progress-interval VALUE");
+    printf("\t%-32s Appends progress snapshots to a file (default: null, standard error)\n", "--progress-file <path>");
+    printf("\t%-32s Writes summary, latency percentiles and histogram by verdict, and throughput as JSON (default: null, no file)\n", "--summary-json <path>");
+    printf("\t%-32s Records events of the search of each sample in Chrome trace JSON format (default: null, no trace)\n", "--trace <path>");
+    printf("\t%-32s Analyses only shard K of N (K from 0 to N - 1) of the dataset, merge outputs with silva-merge (default: 0/1)\n", "--shard K/N");
+    printf("\t%-32s Rows of each shard: every N-th row, or a contiguous range (default: stride)\n", "--shard-layout {stride | range}");
+    printf("\t%-32s Number of worker processes analysing samples, sharing classifier and dataset (default: 1)\n", "--processes VALUE");
+    printf("\t%-32s Order in which worker processes take samples; output keeps dataset order (default: hardest-first)\n", "--schedule {dataset | hardest-first}");
+    printf("\t%-32s Layout of dataset features; columns classifies samples by blocks (default: rows)\n", "--layout {rows | columns}");
+    printf("\t%-32s Simplifies classifiers when loaded, removing infeasible branches and splits with identical children\n", "--optimize");
+    printf("\t%-32s Declares that every feature of samples and perturbations lies in [MIN, MAX], used by --optimize\n", "--input-bounds MIN MAX");
     printf("\n");
 
     printf("Perturbation-specific options:\n");
@@ -259,6 +586,15 @@ void display_help(const int argc, const char *argv[]) {
     printf("\t\tfile_name\tPath to perturbation file\n");
     printf("\n");
 
+    printf("Jobs file:\n");
+    printf("\tOne \"name: value\" pair per line. Each \"job: name\" line starts a new job, which\n");
+    printf("\tinherits command-line options and pairs preceding the first job. Supported names are\n");
+    printf("\tclassifier, dataset, counterexamples, voting, abstraction, perturbation, tiers,\n");
+    printf("\tsample-timeout, sample-memory-limit, cascade (true or false), cascade-samples,\n");
+    printf("\tcascade-budget, shard, shard-layout, processes, schedule and layout, with the same\n");
+    printf("\tvalues as the corresponding command-line options.\n");
+    printf("\n");
+
     printf("Examples:\n");
     printf("Analyses classifier \"my_classifier.silva\" using \"my_dataset.csv\", adversarial region is generated by an L_inf ball with radius 64, analysis is performed using intervals:\n");
     printf("\tsilva my_classifier.silva my_dataset.csv --abstraction interval --perturbation l_inf 64\n");
@@ -268,9 +604,15 @@ void display_help(const int argc, const char *argv[]) {
 
 void options_print(const Options options, FILE *stream) {
     fprintf(stream, "Program options:\n");
-    fprintf(stream, "\tclassifier path: %s\n", options.classifier_path);
-    fprintf(stream, "\tdataset path: %s\n", options.dataset_path);
+    fprintf(stream, "\tjobs path: %s\n", options.jobs_path != NULL ? options.jobs_path : "none");
+    fprintf(stream, "\tclassifier path: %s\n", options.classifier_path != NULL ? options.classifier_path : "none");
+    fprintf(stream, "\tdataset path: %s\n", options.dataset_path != NULL ? options.dataset_path : "none");
     fprintf(stream, "\tcounterexamples path: %s\n", options.dataset_path != NULL ? options.dataset_path : "none");
+    fprintf(stream, "\tcompiled model path: %s\n", options.compiled_model_path != NULL ? options.compiled_model_path : "none");
+    fprintf(stream, "\tdiagram path: %s\n", options.diagram_path != NULL ? options.diagram_path : "none");
+    fprintf(stream, "\trecord path: %s\n", options.record_path != NULL ? options.record_path : "none");
+    fprintf(stream, "\ttrace path: %s\n", options.trace_path != NULL ? options.trace_path : "none");
+    fprintf(stream, "\tsummary JSON path: %s\n", options.summary_json_path != NULL ? options.summary_json_path : "none");
     fprintf(stream, "\tvoting scheme: %s\n", options.voting_scheme == FOREST_VOTING_MAX ? "max" : "average");
     fprintf(stream, "\tperturbation: ");
     perturbation_print(options.perturbation, stream);
@@ -283,8 +625,24 @@ void options_print(const Options options, FILE *stream) {
         fprintf(stream, "none\n");
     }
     fprintf(stream, "\tsample timeout: %u\n", options.sample_timeout);
+    fprintf(stream, "\tsample memory limit: %u\n", options.sample_memory_limit);
     fprintf(stream, "\tabstraction: ");
     abstract_domain_print(options.abstract_domain, stream);
     fprintf(stream, "\n");
     fprintf(stream, "\tseed: %u\n", options.seed);
+    fprintf(stream, "\tcascade: %s\n", options.cascade.enabled ? "enabled" : "disabled");
+    fprintf(stream, "\tprofile: %s\n", options.profiler.enabled ? "enabled" : "disabled");
+    fprintf(stream, "\tprogress interval: %g\n", options.progress_interval);
+    fprintf(stream, "\tprogress path: %s\n", options.progress_path != NULL ? options.progress_path : "stderr");
+    fprintf(stream, "\tshard: %u/%u (%s)\n", options.shard_index, options.n_shards, options.shard_layout == SHARD_STRIDE ? "stride" : "range");
+    fprintf(stream, "\tprocesses: %u\n", options.n_processes);
+    fprintf(stream, "\tschedule: %s\n", options.schedule == SCHEDULE_DATASET ? "dataset" : "hardest-first");
+    fprintf(stream, "\tlayout: %s\n", options.data_layout == DATA_LAYOUT_ROWS ? "rows" : "columns");
+    fprintf(stream, "\toptimize: %s\n", options.optimize ? "enabled" : "disabled");
+    if (options.has_input_bounds) {
+        fprintf(stream, "\tinput bounds: [%g, %g]\n", options.input_lower, options.input_upper);
+    }
+    else {
+        fprintf(stream, "\tinput bounds: none\n");
+    }
 }
@@ -15,6 +15,32 @@
 #include "perturbation.h"
 #include "tier.h"
 #include "abstract_domains/abstract_domain.h"
+#include "abstract_interpreters/cascade.h"
+#include "profiler.h"
+#include "trace.h"
+
+
+/** Layouts of dataset shards. */
+typedef enum {
+    SHARD_STRIDE,  /**< Shard K of N gets rows i such that i mod N = K. */
+    SHARD_RANGE    /**< Shard K of N gets the K-th of N contiguous ranges. */
+} ShardLayout;
+
+
+/** Layouts of dataset features during analysis. */
+typedef enum {
+    DATA_LAYOUT_ROWS,    /**< Row-major layout only. */
+    DATA_LAYOUT_COLUMNS  /**< Column-major copy is kept as well, and samples
+                              are classified by blocks. */
+} DataLayout;
+
+
+/** Orders in which worker processes take samples. */
+typedef enum {
+    SCHEDULE_DATASET,       /**< Samples are taken in dataset order. */
+    SCHEDULE_HARDEST_FIRST  /**< Samples are taken by decreasing estimated
+                                 difficulty. */
+} Schedule;
 
 
 /** Type of program options. */
@@ -23,9 +49,30 @@ typedef struct options Options;
 
 /** Structure of program options. */
 struct options {
+    char *jobs_path;                   /**< Path to jobs file, NULL for a
+                                            single run. */
     char *classifier_path;             /**< Path to classifier file. */
     char *dataset_path;                /**< Path to dataset file. */
     char *counterexamples_path;        /**< Path to counterexample file. */
+    char *compiled_model_path;         /**< Path to compiled model, NULL to
+                                            interpret trees. */
+    char *diagram_path;                /**< Path to decision diagram, NULL to
+                                            search. */
+    char *record_path;                 /**< Path to record of previous and
+                                            current run, NULL to analyse
+                                            every sample from scratch. */
+    char *trace_path;                  /**< Path to trace file, NULL to
+                                            disable tracing. */
+    char *summary_json_path;           /**< Path to machine-readable
+                                            summary, NULL to omit it. */
+    Trace trace;                       /**< Trace of the search, NULL if
+                                            disabled. */
+    char *progress_path;               /**< Path to file receiving progress
+                                            snapshots, NULL for standard
+                                            error. */
+    double progress_interval;          /**< Time between progress snapshots
+                                            (seconds), 0 to print them only
+                                            on SIGUSR1. */
     unsigned int max_print_length;     /**< Maximum number of characters to show
                                             for classifier and dataset paths. */
     ForestVotingScheme voting_scheme;  /**< Forest voting scheme. */
@@ -34,8 +81,28 @@ struct options {
     Tier tier;                         /**< Tier list of features. */
     unsigned int sample_timeout;       /**< Maximum allowed execution time for
                                             one sample analysis (seconds). */
+    unsigned int sample_memory_limit;  /**< Maximum memory held by the search
+                                            of one sample (megabytes), 0 for
+                                            no limit. */
     unsigned int seed;                 /**< Seed to use for random number
                                             generator. */
+    Cascade cascade;                   /**< Staged analysis cascade. */
+    Profiler profiler;                 /**< Profiler of phases of the run. */
+    unsigned int shard_index;          /**< Index of analysed shard. */
+    unsigned int n_shards;             /**< Number of shards. */
+    ShardLayout shard_layout;          /**< Layout of shards. */
+    unsigned int n_processes;          /**< Number of worker processes, 1 to
+                                            analyse samples in-process. */
+    Schedule schedule;                 /**< Order in which worker processes
+                                            take samples. */
+    DataLayout data_layout;            /**< Layout of dataset features. */
+    unsigned int optimize;             /**< Whether classifiers are simplified
+                                            when loaded. */
+    unsigned int has_input_bounds;     /**< Whether every feature of every
+                                            input is declared to lie within
+                                            bounds. */
+    double input_lower;                /**< Declared lower bound of features. */
+    double input_upper;                /**< Declared upper bound of features. */
 };
 
 
@@ -52,6 +119,18 @@ void options_delete(Options *options);
 void options_read(Options *options, const int argc, const char *argv[]);
 
 
+/**
+ * Sets an option from a name/value pair, as read from a jobs file.
+ *
+ * Names are those of command-line options, without leading dashes.
+ *
+ * @param[in,out] options Program options
+ * @param[in] name Name of option
+ * @param[in] value Value of option, which must outlive options
+ */
+void options_set(Options *options, const char *name, const char *value);
+
+
 /**
  * Prints a help message.
  *
@@ -47,6 +47,12 @@ unsigned int priority_queue_get_size(const PriorityQueue P) {
 
 
 
+size_t priority_queue_get_memory_size(const PriorityQueue P) {
+    return sizeof(struct priority_queue) + binary_heap_get_memory_size(P->heap);
+}
+
+
+
 double priority_queue_get_max_priority(const PriorityQueue P) {
     return binary_heap_get_next_key(P->heap);
 }
@@ -55,6 +55,15 @@ unsigned int priority_queue_is_empty(const PriorityQueue P);
 unsigned int priority_queue_get_size(const PriorityQueue P);
 
 
+/**
+ * Returns memory held by a priority queue, heap included.
+ *
+ * @param[in] P Priority queue
+ * @return Size of the priority queue (bytes)
+ */
+size_t priority_queue_get_memory_size(const PriorityQueue P);
+
+
 /**
  * Returns priority of element with highest priority.
  *
@@ -0,0 +1,224 @@
+/**
+ * Implements a hierarchical profiler.
+ *
+ * Wall time is read from the monotonic clock, CPU time from the clock of
+ * the calling thread, so that measures are not affected by other threads
+ * or processes.
+ *
+ * @file profiler.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "profiler.h"
+#include "stopwatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Finds a scope, adding it if missing.
+ *
+ * @param[in,out] P Profiler
+ * @param[in] parent Index of parent scope, PROFILER_MAX_SCOPES for
+ *            top-level scopes
+ * @param[in] name Name of scope
+ * @return Index of scope
+ */
+static unsigned int find_scope(Profiler *P, const unsigned int parent, const char *name) {
+    unsigned int i;
+
+    for (i = 0; i < P->n_scopes; ++i) {
+        if (P->scopes[i].parent == parent && strcmp(P->scopes[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    if (P->n_scopes == PROFILER_MAX_SCOPES) {
+        fprintf(stderr, "[%s: %d] Too many profiler scopes.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    strncpy(P->scopes[i].name, name, PROFILER_NAME_SIZE - 1);
+    P->scopes[i].name[PROFILER_NAME_SIZE - 1] = '\0';
+    P->scopes[i].parent = parent;
+    P->scopes[i].n_calls = 0;
+    P->scopes[i].wall_time = 0.0;
+    P->scopes[i].cpu_time = 0.0;
+    ++P->n_scopes;
+
+    return i;
+}
+
+
+
+/**
+ * Finds a counter, adding it if missing.
+ *
+ * @param[in,out] P Profiler
+ * @param[in] name Name of counter
+ * @return Index of counter
+ */
+static unsigned int find_counter(Profiler *P, const char *name) {
+    unsigned int i;
+
+    for (i = 0; i < P->n_counters; ++i) {
+        if (strcmp(P->counters[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    if (P->n_counters == PROFILER_MAX_COUNTERS) {
+        fprintf(stderr, "[%s: %d] Too many profiler counters.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    strncpy(P->counters[i].name, name, PROFILER_NAME_SIZE - 1);
+    P->counters[i].name[PROFILER_NAME_SIZE - 1] = '\0';
+    P->counters[i].value = 0;
+    ++P->n_counters;
+
+    return i;
+}
+
+
+
+/**
+ * Prints a scope and, recursively, its children.
+ *
+ * @param[in] P Profiler
+ * @param[in] i Index of scope
+ * @param[in] level Nesting level of scope
+ * @param[in,out] stream Stream
+ */
+static void print_scope(const Profiler *P, const unsigned int i, const unsigned int level, FILE *stream) {
+    const struct profiler_scope *scope = P->scopes + i;
+    unsigned int j;
+
+    fprintf(
+        stream,
+        "[PROFILE] %*s%-*s %12llu %12g %12g\n",
+        2 * level, "",
+        (int) (PROFILER_NAME_SIZE + 2 * (PROFILER_MAX_DEPTH - 1) - 2 * level), scope->name,
+        scope->n_calls,
+        scope->wall_time,
+        scope->cpu_time
+    );
+
+    for (j = i + 1; j < P->n_scopes; ++j) {
+        if (P->scopes[j].parent == i) {
+            print_scope(P, j, level + 1, stream);
+        }
+    }
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+void profiler_init(Profiler *P, const unsigned int enabled) {
+    P->enabled = enabled;
+    P->n_scopes = 0;
+    P->n_counters = 0;
+    P->depth = 0;
+}
+
+
+
+void profiler_enter(Profiler *P, const char *name) {
+    if (!P->enabled) {
+        return;
+    }
+
+    if (P->depth == PROFILER_MAX_DEPTH) {
+        fprintf(stderr, "[%s: %d] Too many nested profiler scopes.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    P->open[P->depth] = find_scope(P, P->depth > 0 ? P->open[P->depth - 1] : PROFILER_MAX_SCOPES, name);
+    P->start_wall[P->depth] = stopwatch_read_clock(STOPWATCH_CLOCK_WALL);
+    P->start_cpu[P->depth] = stopwatch_read_clock(STOPWATCH_CLOCK_CPU);
+    ++P->depth;
+}
+
+
+
+void profiler_exit(Profiler *P) {
+    struct profiler_scope *scope;
+
+    if (!P->enabled) {
+        return;
+    }
+
+    if (P->depth == 0) {
+        fprintf(stderr, "[%s: %d] No profiler scope to exit.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    --P->depth;
+    scope = P->scopes + P->open[P->depth];
+    scope->cpu_time += stopwatch_read_clock(STOPWATCH_CLOCK_CPU) - P->start_cpu[P->depth];
+    scope->wall_time += stopwatch_read_clock(STOPWATCH_CLOCK_WALL) - P->start_wall[P->depth];
+    ++scope->n_calls;
+}
+
+
+
+void profiler_count(Profiler *P, const char *name, const unsigned long long value) {
+    if (!P->enabled) {
+        return;
+    }
+
+    P->counters[find_counter(P, name)].value += value;
+}
+
+
+
+void profiler_merge(Profiler *P, const Profiler *Q) {
+    const unsigned int current = P->depth > 0 ? P->open[P->depth - 1] : PROFILER_MAX_SCOPES;
+    unsigned int map[PROFILER_MAX_SCOPES], i;
+
+    /* Parents come before their children, thus are already mapped */
+    for (i = 0; i < Q->n_scopes; ++i) {
+        const struct profiler_scope *scope = Q->scopes + i;
+        const unsigned int parent = scope->parent == PROFILER_MAX_SCOPES ? current : map[scope->parent];
+
+        map[i] = find_scope(P, parent, scope->name);
+        P->scopes[map[i]].n_calls += scope->n_calls;
+        P->scopes[map[i]].wall_time += scope->wall_time;
+        P->scopes[map[i]].cpu_time += scope->cpu_time;
+    }
+
+    for (i = 0; i < Q->n_counters; ++i) {
+        P->counters[find_counter(P, Q->counters[i].name)].value += Q->counters[i].value;
+    }
+}
+
+
+
+void profiler_print(const Profiler *P, FILE *stream) {
+    const int name_size = PROFILER_NAME_SIZE + 2 * (PROFILER_MAX_DEPTH - 1);
+    unsigned int i;
+
+    fprintf(stream, "[PROFILE] %-*s %12s %12s %12s\n", name_size, "Scope", "Calls", "Wall (s)", "CPU (s)");
+    for (i = 0; i < P->n_scopes; ++i) {
+        if (P->scopes[i].parent == PROFILER_MAX_SCOPES) {
+            print_scope(P, i, 0, stream);
+        }
+    }
+
+    if (P->n_counters > 0) {
+        fprintf(stream, "[PROFILE] %-*s %12s\n", name_size, "Counter", "Value");
+    }
+    for (i = 0; i < P->n_counters; ++i) {
+        fprintf(stream, "[PROFILE] %-*s %12llu\n", name_size, P->counters[i].name, P->counters[i].value);
+    }
+}
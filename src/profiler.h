@@ -0,0 +1,144 @@
+/**
+ * Defines a hierarchical profiler.
+ *
+ * A profiler measures nested named scopes, recording number of calls,
+ * wall time and CPU time of the calling thread spent in each of them,
+ * and a few named counters. Scopes entered under different parents are
+ * measured separately. Storage is fixed, so that a profiler can be
+ * copied or sent to another process as it is.
+ *
+ * @file profiler.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdio.h>
+
+
+/** Maximum number of distinct scopes. */
+#define PROFILER_MAX_SCOPES 32
+
+/** Maximum nesting depth of scopes. */
+#define PROFILER_MAX_DEPTH 8
+
+/** Maximum number of counters. */
+#define PROFILER_MAX_COUNTERS 8
+
+/** Maximum length of names, terminator included. */
+#define PROFILER_NAME_SIZE 24
+
+
+/** Structure of a scope. */
+struct profiler_scope {
+    char name[PROFILER_NAME_SIZE];  /**< Name of scope. */
+    unsigned int parent;            /**< Index of parent scope,
+                                         PROFILER_MAX_SCOPES for top-level
+                                         scopes. */
+    unsigned long long n_calls;     /**< Number of times scope was entered. */
+    double wall_time;               /**< Wall time, in seconds. */
+    double cpu_time;                /**< CPU time of the calling thread, in
+                                         seconds. */
+};
+
+
+/** Structure of a counter. */
+struct profiler_counter {
+    char name[PROFILER_NAME_SIZE];  /**< Name of counter. */
+    unsigned long long value;       /**< Value of counter. */
+};
+
+
+/** Structure of a profiler. */
+struct profiler {
+    unsigned int enabled;           /**< 1 if profiler is enabled, 0
+                                         otherwise. */
+    unsigned int n_scopes;          /**< Number of scopes. */
+    struct profiler_scope scopes[PROFILER_MAX_SCOPES];
+                                    /**< Scopes, parents before children. */
+    unsigned int n_counters;        /**< Number of counters. */
+    struct profiler_counter counters[PROFILER_MAX_COUNTERS];
+                                    /**< Counters. */
+    unsigned int depth;             /**< Number of open scopes. */
+    unsigned int open[PROFILER_MAX_DEPTH];
+                                    /**< Index of each open scope. */
+    double start_wall[PROFILER_MAX_DEPTH];
+                                    /**< Wall time when each open scope was
+                                         entered. */
+    double start_cpu[PROFILER_MAX_DEPTH];
+                                    /**< CPU time when each open scope was
+                                         entered. */
+};
+
+
+/** Type of a profiler. */
+typedef struct profiler Profiler;
+
+
+
+/**
+ * Initializes a profiler, with no scopes and counters.
+ *
+ * @param[out] P Profiler
+ * @param[in] enabled 1 to enable profiler, 0 otherwise
+ */
+void profiler_init(Profiler *P, const unsigned int enabled);
+
+
+
+/**
+ * Enters a scope, nested in the current one.
+ *
+ * Does nothing if profiler is disabled.
+ *
+ * @param[in,out] P Profiler
+ * @param[in] name Name of scope
+ */
+void profiler_enter(Profiler *P, const char *name);
+
+
+/**
+ * Exits current scope.
+ *
+ * Does nothing if profiler is disabled.
+ *
+ * @param[in,out] P Profiler
+ */
+void profiler_exit(Profiler *P);
+
+
+/**
+ * Adds a value to a counter.
+ *
+ * Does nothing if profiler is disabled.
+ *
+ * @param[in,out] P Profiler
+ * @param[in] name Name of counter
+ * @param[in] value Value to add
+ */
+void profiler_count(Profiler *P, const char *name, const unsigned long long value);
+
+
+
+/**
+ * Adds scopes and counters of a profiler to another one.
+ *
+ * Top-level scopes of the added profiler are nested in the current scope.
+ * Scopes are matched by name and parent, those missing are added.
+ *
+ * @param[in,out] P Profiler
+ * @param[in] Q Profiler to add
+ */
+void profiler_merge(Profiler *P, const Profiler *Q);
+
+
+/**
+ * Prints calls, wall time and CPU time of each scope, children under
+ * their parent, followed by counters.
+ *
+ * @param[in] P Profiler
+ * @param[in,out] stream Stream
+ */
+void profiler_print(const Profiler *P, FILE *stream);
+
+#endif
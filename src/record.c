@@ -0,0 +1,283 @@
+/**
+ * Implements the record of an analysis.
+ *
+ * Records are stored as a text header, "silva-record VERSION", followed
+ * by binary data: settings hash, number of samples, number of trees, size
+ * of the feature space and hash of each tree, then one entry per sample.
+ * Each entry starts with a presence byte and, if present, holds sample
+ * hash, result and tree hashes, followed by witness and counterexample
+ * region when the sample is unstable.
+ *
+ * @file record.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#include "record.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Version of the record format. */
+#define RECORD_VERSION 1
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Allocates memory, aborting on failure.
+ *
+ * @param[in] size Number of bytes
+ * @return Allocated memory
+ */
+static void *allocate(const size_t size) {
+    void *p = malloc(size);
+
+    if (p == NULL && size > 0) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return p;
+}
+
+
+
+/**
+ * Deallocates memory of an entry.
+ *
+ * @param[in,out] E Entry
+ */
+static void entry_clear(RecordEntry *E) {
+    free(E->tree_hashes);
+    free(E->witness);
+    free(E->counterexample);
+    E->is_present = 0;
+    E->tree_hashes = NULL;
+    E->witness = NULL;
+    E->counterexample = NULL;
+}
+
+
+
+/**
+ * Reads binary data, aborting on failure.
+ *
+ * @param[out] data Data
+ * @param[in] size Size of an element
+ * @param[in] n Number of elements
+ * @param[in,out] stream Stream
+ */
+static void read_data(void *data, const size_t size, const size_t n, FILE *stream) {
+    if (fread(data, size, n, stream) != n) {
+        fprintf(stderr, "[%s: %d] Cannot parse record.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Writes binary data, aborting on failure.
+ *
+ * @param[in] data Data
+ * @param[in] size Size of an element
+ * @param[in] n Number of elements
+ * @param[in,out] stream Stream
+ */
+static void write_data(const void *data, const size_t size, const size_t n, FILE *stream) {
+    if (fwrite(data, size, n, stream) != n) {
+        fprintf(stderr, "[%s: %d] Cannot write record.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+void record_create(
+    Record *R,
+    const unsigned long long settings_hash,
+    const unsigned int n_samples,
+    const unsigned int n_trees,
+    const unsigned int space_size
+) {
+    Record r = (Record) allocate(sizeof(struct record));
+    unsigned int i;
+
+    r->settings_hash = settings_hash;
+    r->n_samples = n_samples;
+    r->n_trees = n_trees;
+    r->space_size = space_size;
+    r->tree_hashes = (unsigned long long *) allocate(n_trees * sizeof(unsigned long long));
+    r->entries = (RecordEntry *) allocate(n_samples * sizeof(RecordEntry));
+    memset(r->tree_hashes, 0, n_trees * sizeof(unsigned long long));
+    for (i = 0; i < n_samples; ++i) {
+        r->entries[i].is_present = 0;
+        r->entries[i].tree_hashes = NULL;
+        r->entries[i].witness = NULL;
+        r->entries[i].counterexample = NULL;
+    }
+
+    *R = r;
+}
+
+
+
+void record_delete(Record *R) {
+    unsigned int i;
+
+    if (R == NULL || *R == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < (*R)->n_samples; ++i) {
+        entry_clear((*R)->entries + i);
+    }
+    free((*R)->entries);
+    free((*R)->tree_hashes);
+    free(*R);
+    *R = NULL;
+}
+
+
+
+RecordEntry *record_add_entry(
+    Record R,
+    const unsigned int i,
+    const unsigned long long sample_hash
+) {
+    RecordEntry *E;
+
+    if (R == NULL || i >= R->n_samples) {
+        fprintf(stderr, "[%s: %d] Invalid record entry.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    E = R->entries + i;
+    entry_clear(E);
+    E->is_present = 1;
+    E->sample_hash = sample_hash;
+    E->result = STABILITY_DONT_KNOW;
+    E->tree_hashes = (unsigned long long *) allocate(R->n_trees * sizeof(unsigned long long));
+
+    return E;
+}
+
+
+
+void record_entry_set_result(
+    const Record R,
+    RecordEntry *E,
+    const StabilityResult result,
+    const double *witness,
+    const double *counterexample
+) {
+    free(E->witness);
+    free(E->counterexample);
+    E->witness = NULL;
+    E->counterexample = NULL;
+    E->result = result;
+
+    if (result == STABILITY_FALSE) {
+        E->witness = (double *) allocate(R->space_size * sizeof(double));
+        E->counterexample = (double *) allocate(2 * R->space_size * sizeof(double));
+        memcpy(E->witness, witness, R->space_size * sizeof(double));
+        memcpy(E->counterexample, counterexample, 2 * R->space_size * sizeof(double));
+    }
+}
+
+
+
+void record_read(Record *R, FILE *stream) {
+    unsigned int version, n_samples, n_trees, space_size, i;
+    unsigned long long settings_hash;
+    unsigned char is_present;
+    int result;
+    Record r;
+
+    if (!stream) {
+        fprintf(stderr, "[%s: %d] Cannot read file.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    if (fscanf(stream, "silva-record %u", &version) != 1 || fgetc(stream) != '\n'
+        || version != RECORD_VERSION) {
+        fprintf(stderr, "[%s: %d] Cannot parse record.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    read_data(&settings_hash, sizeof(unsigned long long), 1, stream);
+    read_data(&n_samples, sizeof(unsigned int), 1, stream);
+    read_data(&n_trees, sizeof(unsigned int), 1, stream);
+    read_data(&space_size, sizeof(unsigned int), 1, stream);
+    record_create(&r, settings_hash, n_samples, n_trees, space_size);
+    read_data(r->tree_hashes, sizeof(unsigned long long), n_trees, stream);
+
+    for (i = 0; i < n_samples; ++i) {
+        RecordEntry *E;
+        unsigned long long sample_hash;
+
+        read_data(&is_present, sizeof(unsigned char), 1, stream);
+        if (!is_present) {
+            continue;
+        }
+
+        read_data(&sample_hash, sizeof(unsigned long long), 1, stream);
+        E = record_add_entry(r, i, sample_hash);
+        read_data(&result, sizeof(int), 1, stream);
+        E->result = (StabilityResult) result;
+        read_data(E->tree_hashes, sizeof(unsigned long long), n_trees, stream);
+        if (E->result == STABILITY_FALSE) {
+            E->witness = (double *) allocate(space_size * sizeof(double));
+            E->counterexample = (double *) allocate(2 * space_size * sizeof(double));
+            read_data(E->witness, sizeof(double), space_size, stream);
+            read_data(E->counterexample, sizeof(double), 2 * space_size, stream);
+        }
+    }
+
+    *R = r;
+}
+
+
+
+void record_write(const Record R, FILE *stream) {
+    unsigned int i;
+
+    if (R == NULL || !stream) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(stream, "silva-record %u\n", RECORD_VERSION);
+    write_data(&R->settings_hash, sizeof(unsigned long long), 1, stream);
+    write_data(&R->n_samples, sizeof(unsigned int), 1, stream);
+    write_data(&R->n_trees, sizeof(unsigned int), 1, stream);
+    write_data(&R->space_size, sizeof(unsigned int), 1, stream);
+    write_data(R->tree_hashes, sizeof(unsigned long long), R->n_trees, stream);
+
+    for (i = 0; i < R->n_samples; ++i) {
+        const RecordEntry *E = R->entries + i;
+        const unsigned char is_present = E->is_present;
+        const int result = E->result;
+
+        write_data(&is_present, sizeof(unsigned char), 1, stream);
+        if (!is_present) {
+            continue;
+        }
+
+        write_data(&E->sample_hash, sizeof(unsigned long long), 1, stream);
+        write_data(&result, sizeof(int), 1, stream);
+        write_data(E->tree_hashes, sizeof(unsigned long long), R->n_trees, stream);
+        if (E->result == STABILITY_FALSE) {
+            write_data(E->witness, sizeof(double), R->space_size, stream);
+            write_data(E->counterexample, sizeof(double), 2 * R->space_size, stream);
+        }
+    }
+}
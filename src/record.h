@@ -0,0 +1,142 @@
+/**
+ * Defines the record of an analysis.
+ *
+ * A record keeps, for each analysed sample, the artefacts needed to tell
+ * whether its result still holds after the classifier changes: result,
+ * counterexample and a hash of each tree restricted to the adversarial
+ * region of the sample.
+ *
+ * @file record.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "abstract_interpreters/stability_status.h"
+
+
+/** Structure of the recorded analysis of a sample. */
+struct record_entry {
+    unsigned int is_present;           /**< 1 if the sample was analysed. */
+    unsigned long long sample_hash;    /**< Hash of features of the sample. */
+    StabilityResult result;            /**< Result of the analysis. */
+    unsigned long long *tree_hashes;   /**< Hash of each tree restricted to
+                                            the adversarial region. */
+    double *witness;                   /**< Point classified differently
+                                            from the sample, NULL unless
+                                            unstable. */
+    double *counterexample;            /**< Lower and upper bound of each
+                                            feature of the counterexample
+                                            region, NULL unless unstable. */
+};
+
+/** Type of the recorded analysis of a sample. */
+typedef struct record_entry RecordEntry;
+
+
+/** Structure of the record of an analysis. */
+struct record {
+    unsigned long long settings_hash;  /**< Hash of settings affecting
+                                            results. */
+    unsigned int n_samples;            /**< Number of samples. */
+    unsigned int n_trees;              /**< Number of trees. */
+    unsigned int space_size;           /**< Size of the feature space. */
+    unsigned long long *tree_hashes;   /**< Hash of each whole tree. */
+    RecordEntry *entries;              /**< Entry of each sample. */
+};
+
+/** Type of the record of an analysis. */
+typedef struct record *Record;
+
+
+
+/**
+ * Creates an empty record.
+ *
+ * @param[out] R Pointer to record
+ * @param[in] settings_hash Hash of settings affecting results
+ * @param[in] n_samples Number of samples
+ * @param[in] n_trees Number of trees
+ * @param[in] space_size Size of the feature space
+ * @warning #record_delete should be called to ensure proper memory
+ *          deallocation.
+ */
+void record_create(
+    Record *R,
+    const unsigned long long settings_hash,
+    const unsigned int n_samples,
+    const unsigned int n_trees,
+    const unsigned int space_size
+);
+
+
+/**
+ * Deletes a record.
+ *
+ * @param[in,out] R Pointer to record
+ */
+void record_delete(Record *R);
+
+
+
+/**
+ * Marks a sample as analysed, allocating its tree hashes.
+ *
+ * @param[in,out] R Record
+ * @param[in] i Index of sample
+ * @param[in] sample_hash Hash of features of the sample
+ * @return Entry of the sample
+ */
+RecordEntry *record_add_entry(
+    Record R,
+    const unsigned int i,
+    const unsigned long long sample_hash
+);
+
+
+/**
+ * Sets the result of an entry.
+ *
+ * @param[in,out] R Record
+ * @param[in,out] E Entry
+ * @param[in] result Result of the analysis
+ * @param[in] witness Point classified differently from the sample, used
+ *            only if result is #STABILITY_FALSE
+ * @param[in] counterexample Lower and upper bound of each feature of the
+ *            counterexample region, used only if result is
+ *            #STABILITY_FALSE
+ */
+void record_entry_set_result(
+    const Record R,
+    RecordEntry *E,
+    const StabilityResult result,
+    const double *witness,
+    const double *counterexample
+);
+
+
+
+
+/**
+ * Reads a record.
+ *
+ * @param[out] R Pointer to record
+ * @param[in,out] stream Stream
+ * @warning #record_delete should be called to ensure proper memory
+ *          deallocation.
+ */
+void record_read(Record *R, FILE *stream);
+
+
+/**
+ * Writes a record.
+ *
+ * @param[in] R Record
+ * @param[in,out] stream Stream
+ */
+void record_write(const Record R, FILE *stream);
+
+#endif
@@ -6,8 +6,6 @@
  */
 #include "best_first.h"
 
-#include "../priority_queue.h"
-
 
 void best_first_search(
     Node *goal,
@@ -18,11 +16,26 @@ void best_first_search(
     Context context
 ) {
     PriorityQueue Q;
-    List adjacent_nodes;
 
     priority_queue_create(&Q);
-    list_create(&adjacent_nodes);
     priority_queue_push(Q, root, 0.0);
+    best_first_search_resume(goal, Q, is_goal, compute_adjacent_nodes, compute_priority, context);
+    priority_queue_delete(&Q);
+}
+
+
+
+void best_first_search_resume(
+    Node *goal,
+    PriorityQueue Q,
+    const NodePredicate is_goal,
+    const NodeAdjacencyFunction compute_adjacent_nodes,
+    const NodePriorityFunction compute_priority,
+    Context context
+) {
+    List adjacent_nodes;
+
+    list_create(&adjacent_nodes);
 
     while (!priority_queue_is_empty(Q)) {
         const Node x = priority_queue_pop(Q);
@@ -39,6 +52,5 @@ void best_first_search(
         }
     }
 
-    priority_queue_delete(&Q);
     list_delete(&adjacent_nodes);
 }
@@ -8,6 +8,7 @@
 #define BEST_FIRST_H
 
 #include "search_algorithms.h"
+#include "../priority_queue.h"
 
 /**
  * Performs a best-first search.
@@ -29,4 +30,29 @@ void best_first_search(
     Context context
 );
 
+
+/**
+ * Performs a best-first search starting from a given frontier.
+ *
+ * Search stops as soon as a goal node is found or frontier is empty.
+ * Goal node is removed from the frontier, every other node is left in it,
+ * so that search can be resumed later by calling this function again.
+ *
+ * @param[out] goal Goal node, if any
+ * @param[in,out] Q Frontier, as #PriorityQueue of nodes
+ * @param[in] is_goal Tells whether a node is a goal node
+ * @param[in] compute_adjacent_nodes Returns #List of next nodes to visit
+ * @param[in] compute_priority Returns estimated priority of a node
+ * @param[in,out] context Additional data to be passed to is_goal,
+ *                        compute_next_nodes and compute_priority
+ */
+void best_first_search_resume(
+    Node *goal,
+    PriorityQueue Q,
+    const NodePredicate is_goal,
+    const NodeAdjacencyFunction compute_adjacent_nodes,
+    const NodePriorityFunction compute_priority,
+    Context context
+);
+
 #endif
@@ -205,6 +205,12 @@ unsigned int set_get_cardinality(const Set S) {
 
 
 
+size_t set_get_memory_size(const Set S) {
+    return S != NULL ? sizeof(struct set) + S->capacity * sizeof(void *) : 0;
+}
+
+
+
 void *set_get_elements_as_array(const Set S) {
     return S != NULL ? S->elements : NULL;
 }
@@ -158,6 +158,15 @@ unsigned int set_exists(const Set S, const SetProperty P, void *data);
 unsigned int set_get_cardinality(const Set S);
 
 
+/**
+ * Returns memory held by a set, element buffer included.
+ *
+ * @param[in] S Set
+ * @return Size of set (bytes), 0 if set is NULL
+ */
+size_t set_get_memory_size(const Set S);
+
+
 /**
  * Returns elements in a set as an array.
  *
@@ -6,40 +6,231 @@
  * @file silva.c
  * @author Marco Zanella <marco.zanella.1991@gmail.com>
  */
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
 
 #include "options.h"
+#include "configuration.h"
 #include "data_mappers/classifier_silva.h"
 #include "dataset.h"
+#include "compiled_forest.h"
+#include "decision_diagram.h"
 #include "abstract_interpreters/abstract_classifier.h"
+#include "abstract_interpreters/classifier_hyperrectangle.h"
+#include "record.h"
+#include "hash.h"
 #include "stopwatch.h"
+#include "descriptor.h"
+#include "histogram.h"
 
 
 /** Minimum space to print labels. */
 #define LABELS_MIN_SIZE 16
 
+/** Number of samples classified together using column-major layout. */
+#define SAMPLE_BLOCK_SIZE 256
+
+/** Number of verdicts. */
+#define N_VERDICTS 5
+
+
+
+/** Verdict on a sample, combining correctness and stability. */
+typedef enum {
+    VERDICT_ROBUST,      /**< Correct and stable. */
+    VERDICT_FRAGILE,     /**< Correct and unstable. */
+    VERDICT_VULNERABLE,  /**< Wrong and stable. */
+    VERDICT_BROKEN,      /**< Wrong and unstable. */
+    VERDICT_NO_INFO      /**< Analysis was inconclusive. */
+} Verdict;
+
+
+/** Structure of the progress of an analysis. */
+struct progress {
+    FILE *stream;            /**< Stream of snapshots. */
+    double interval;         /**< Time between periodic snapshots
+                                  (seconds), 0 to disable them. */
+    double start_time;       /**< Start time of the analysis (seconds). */
+    double last_time;        /**< Time of last snapshot (seconds). */
+    unsigned int n_samples;  /**< Number of samples to analyse. */
+};
+
+/** Type of the progress of an analysis. */
+typedef struct progress Progress;
+
+
+/** Names of verdicts. */
+static const char * const VERDICT_NAMES[N_VERDICTS] = {
+    "ROBUST", "FRAGILE", "VULNERABLE", "BROKEN", "NO-INFO"
+};
+
+
+/** Structure of the summary of an analysis. */
+struct summary {
+    unsigned int size;        /**< Number of samples. */
+    double time;              /**< Analysis time (seconds). */
+    unsigned int n_correct;   /**< Number of correctly classified samples. */
+    unsigned int n_stable;    /**< Number of stable samples. */
+    unsigned int n_unstable;  /**< Number of unstable samples. */
+    unsigned int n_robust;    /**< Number of correct and stable samples. */
+    unsigned int n_fragile;   /**< Number of correct and unstable samples. */
+    double wall_time;         /**< Wall time of the whole analysis
+                                   (seconds). */
+    Histogram latency[N_VERDICTS];
+                              /**< Analysis time of samples, by verdict. */
+};
+
+/** Type of the summary of an analysis. */
+typedef struct summary Summary;
+
+
+/** Structure of a job of a jobs file. */
+struct job {
+    const char *name;  /**< Name of the job. */
+    Options options;   /**< Options of the job. */
+};
+
+/** Type of a job of a jobs file. */
+typedef struct job Job;
+
+
+/** Structure of the state of an incremental analysis. */
+struct incremental {
+    Record previous_record;      /**< Record of previous run, NULL if
+                                      missing or not matching. */
+    Record record;               /**< Record of current run. */
+    DecisionTree *trees;         /**< Trees of the classifier. */
+    unsigned char *is_changed;   /**< 1 for each tree differing from the
+                                      previous run. */
+    Hyperrectangle region;       /**< Adversarial region of current sample. */
+    double *lower;               /**< Lower bounds of adversarial region. */
+    double *upper;               /**< Upper bounds of adversarial region. */
+    double *counterexample;      /**< Bounds of counterexample region. */
+    Set witness_labels;          /**< Labels of recorded witness. */
+    unsigned int n_reused;       /**< Number of samples whose result was
+                                      reused. */
+    unsigned int n_witnessed;    /**< Number of samples found unstable by
+                                      their recorded witness. */
+};
+
+/** Type of the state of an incremental analysis. */
+typedef struct incremental Incremental;
+
+
+/** Structure of the analysis of a dataset. */
+struct analysis {
+    Classifier classifier;                   /**< Classifier. */
+    AbstractClassifier abstract_classifier;  /**< Abstract classifier. */
+    Dataset dataset;                         /**< Dataset. */
+    Options *options;                        /**< Options. */
+    double *sample;                          /**< Current sample. */
+    char **expected_labels;                  /**< Label of the classifier
+                                                  matching each label of the
+                                                  dataset, NULL if missing. */
+    Set concrete_labels;                     /**< Labels of current sample. */
+    Set block_labels;                        /**< Labels of current sample,
+                                                  computed with its block,
+                                                  NULL to classify it. */
+    double block_time;                       /**< Time to classify the block
+                                                  of current sample, per
+                                                  sample (seconds). */
+    StabilityStatus status;                  /**< Status of current analysis. */
+    Stopwatch stopwatch;                     /**< Stopwatch. */
+    Profiler *profiler;                      /**< Profiler of phases. */
+    Incremental *incremental;                /**< State of incremental
+                                                  analysis, NULL if
+                                                  disabled. */
+    DecisionDiagram diagram;                 /**< Decision diagram, NULL to
+                                                  search. */
+    Hyperrectangle region;                   /**< Adversarial region of
+                                                  current sample, used with
+                                                  decision diagrams. */
+    Progress *progress;                      /**< Progress of the analysis. */
+};
+
+/** Type of the analysis of a dataset. */
+typedef struct analysis Analysis;
+
+
+/** Structure of the outcome of the analysis of a sample. */
+struct outcome {
+    unsigned int is_correct;   /**< 1 if sample is correctly classified. */
+    unsigned int is_stable;    /**< 1 if sample is stable. */
+    unsigned int is_unstable;  /**< 1 if sample is unstable. */
+    double time;               /**< Analysis time (seconds). */
+    size_t memory;             /**< Peak memory held by the search
+                                    (bytes). */
+};
+
+/** Type of the outcome of the analysis of a sample. */
+typedef struct outcome Outcome;
+
+
+/**
+ * Structure of the header of a message sent by a worker process, followed
+ * by result and counterexample lines or, when position is UINT_MAX, by
+ * the cascade statistics and profiler of the worker.
+ */
+struct message {
+    unsigned int position;       /**< Position of sample in its shard. */
+    Outcome outcome;             /**< Outcome of the analysis. */
+    size_t line_size;            /**< Size of result line. */
+    size_t counterexample_size;  /**< Size of counterexample line. */
+};
+
+/** Type of the header of a message sent by a worker process. */
+typedef struct message Message;
+
+
+/** Structure of the estimated difficulty of a sample. */
+struct estimate {
+    unsigned int position;  /**< Position of sample in its shard. */
+    double difficulty;      /**< Estimated difficulty. */
+};
+
+/** Type of the estimated difficulty of a sample. */
+typedef struct estimate Estimate;
+
+
+
+/** Set by SIGUSR1 to request a snapshot of progress. */
+static volatile sig_atomic_t is_snapshot_requested = 0;
+
+/** Signal which requested to stop the analysis, 0 if none. */
+static volatile sig_atomic_t stop_signal = 0;
+
 
 
 /**
  * Prints a set of labels.
  *
  * @param[in] labels Set of classes
+ * @param[in,out] stream Stream
  */
-static void print_labels(const Set labels) {
+static void print_labels(const Set labels, FILE *stream) {
     const unsigned int n_labels = set_get_cardinality(labels);
     unsigned int i;
     char **labels_array = set_get_elements_as_array(labels);
 
     for (i = 2 * n_labels - 1; i < LABELS_MIN_SIZE; ++i) {
-        printf(" ");
+        fprintf(stream, " ");
     }
     for (i = 0; i < n_labels; ++i) {
-        printf("%s", labels_array[i]);
+        fprintf(stream, "%s", labels_array[i]);
         if (i + 1 < n_labels) {
-            printf(",");
+            fprintf(stream, ",");
         }
     }
 }
@@ -51,8 +242,9 @@ static void print_labels(const Set labels) {
  *
  * @param[in] string String to print
  * @param[in] options Options
+ * @param[in,out] stream Stream
  */
-static void print_string(const char *string, const Options options) {
+static void print_string(const char *string, const Options options, FILE *stream) {
     const unsigned int length = strlen(string),
                        max_length = options.max_print_length - 3,
                        offset = length <= max_length
@@ -60,198 +252,2143 @@ static void print_string(const char *string, const Options options) {
                               : length - max_length;
 
     if (offset != 0) {
-        printf("...");
+        fprintf(stream, "...");
     }
-    printf("%s", string + offset);
+    fprintf(stream, "%s", string + offset);
 }
 
 
 
 /**
- * Main.
- * 
- * @param[in] argc ARGument Counter
- * @param[in] argv ARGument Vector
- * @return EXIT_SUCCESS in case of success, EXIT_FAILURE otherwise
+ * Prints heading of per-sample results.
+ *
+ * @param[in] options Options
  */
-int main(const int argc, const char **argv) {
-    unsigned int i;
-    Options options;
-    FILE *classifier_file, *dataset_file, *counterexamples_file = NULL;
-    Dataset dataset;
-    Classifier classifier;
-    AbstractClassifier abstract_classifier;
-    Set concrete_labels, abstract_labels;
-    StabilityStatus status;
-    Stopwatch stopwatch;
-    double sample_time, previous_cumulative_time = 0.0;
+static void print_heading(const Options options) {
+    printf("%-*s %-*s %8s %8s %*s %10s %10s %11s\n",
+        options.max_print_length, "Classifier",
+        options.max_print_length, "Dataset", 
+        "ID",
+        "Label",
+        LABELS_MIN_SIZE, "Concrete",
+        "Result",
+        "Time (s)",
+        "Memory (KB)"
+    );
+}
 
-    unsigned int n_correct = 0,
-                 n_stable = 0,
-                 n_unstable = 0,
-                 n_robust = 0,
-                 n_fragile = 0;
 
 
-    /* Parses command-line arguments */
-    if (argc < 3) {
-        display_help(argc, argv);
-        exit(EXIT_FAILURE);
+/**
+ * Prints heading of summary.
+ *
+ * @param[in] job_column_size Size of job column, 0 to omit it
+ */
+static void print_summary_heading(const unsigned int job_column_size) {
+    printf("[SUMMARY] ");
+    if (job_column_size > 0) {
+        printf("%-*s ", job_column_size, "Job");
     }
-    options_read(&options, argc, argv);
+    printf(
+        "%10s %10s %10s %10s %10s %10s %10s %10s %10s %12s %10s\n",
+        "Size", "Time (s)", "Correct", "Wrong", "Stable", "Unstable",
+        "No info", "Robust", "Fragile", "Vulnerable", "Broken"
+    );
+}
 
 
-    /* Reads dataset */
-    dataset_file = fopen(options.dataset_path, "r");
-    dataset = dataset_read(dataset_file);
-    fclose(dataset_file);
+
+/**
+ * Prints a row of summary.
+ *
+ * @param[in] summary Summary
+ * @param[in] job_name Name of job, NULL to omit it
+ * @param[in] job_column_size Size of job column
+ */
+static void print_summary(
+    const Summary summary,
+    const char *job_name,
+    const unsigned int job_column_size
+) {
+    printf("[SUMMARY] ");
+    if (job_name != NULL) {
+        printf("%-*s ", job_column_size, job_name);
+    }
+    printf(
+        "%10u %10g %10u %10u %10u %10u %10u %10u %10u %12u %10u\n",
+        summary.size,
+        summary.time,
+        summary.n_correct,
+        summary.size - summary.n_correct,
+        summary.n_stable,
+        summary.n_unstable,
+        summary.size - summary.n_stable - summary.n_unstable,
+        summary.n_robust,
+        summary.n_fragile,
+        summary.n_stable - summary.n_robust,
+        summary.n_unstable - summary.n_fragile
+    );
+}
 
 
-    /* Reads classifier */
-    classifier_file = fopen(options.classifier_path, "r");
-    classifier_silva_read(&classifier, classifier_file);
-    fclose(classifier_file);
-    if (classifier_get_type(classifier) == CLASSIFIER_FOREST) {
-        forest_set_voting_scheme(classifier_get_forest(classifier), options.voting_scheme);
+
+/**
+ * Computes latency of all samples of a summary.
+ *
+ * @param[out] latency Latency of all samples
+ * @param[in] summary Summary
+ */
+static void summary_get_latency(Histogram *latency, const Summary *summary) {
+    unsigned int i;
+
+    histogram_init(latency);
+    for (i = 0; i < N_VERDICTS; ++i) {
+        histogram_merge(latency, summary->latency + i);
     }
+}
 
 
-    /* Creates abstract classifier */
-    abstract_classifier_create(&abstract_classifier, classifier, options.abstract_domain, &options.tier);
 
+/**
+ * Prints heading of latency table.
+ *
+ * @param[in] job_column_size Size of job column, 0 to omit it
+ */
+static void print_latency_heading(const unsigned int job_column_size) {
+    printf("[LATENCY] ");
+    if (job_column_size > 0) {
+        printf("%-*s ", job_column_size, "Job");
+    }
+    printf(
+        "%10s %10s %10s %10s %10s %10s %10s %10s\n",
+        "Verdict", "Size", "Time (s)", "Mean (s)", "p50 (s)", "p90 (s)", "p99 (s)", "Max (s)"
+    );
+}
 
-    /* Prepares auxiliary data structures */
-    set_create(&concrete_labels, set_equality_string);
-    set_create(&abstract_labels, set_equality_string);
-    status.sample_b = malloc(classifier_get_feature_space_size(classifier) * sizeof(double));
-    hyperrectangle_create(&status.region, classifier_get_feature_space_size(classifier));
-    status.labels_a = concrete_labels;
-    status.timeout = options.sample_timeout;
-    stopwatch_create(&stopwatch);
 
 
-    /* Opens counterexamples file, if necessary */
-    if (options.counterexamples_path != NULL) {
-        counterexamples_file = fopen(options.counterexamples_path, "w");
+/**
+ * Prints a row of latency table.
+ *
+ * @param[in] latency Latency of samples
+ * @param[in] verdict Name of verdict of samples
+ * @param[in] job_name Name of job, NULL to omit it
+ * @param[in] job_column_size Size of job column
+ */
+static void print_latency_row(
+    const Histogram *latency,
+    const char *verdict,
+    const char *job_name,
+    const unsigned int job_column_size
+) {
+    printf("[LATENCY] ");
+    if (job_name != NULL) {
+        printf("%-*s ", job_column_size, job_name);
     }
+    printf(
+        "%10s %10llu %10g %10g %10g %10g %10g %10g\n",
+        verdict,
+        latency->n_values,
+        latency->sum,
+        latency->n_values > 0 ? latency->sum / latency->n_values : 0.0,
+        histogram_get_percentile(latency, 50.0),
+        histogram_get_percentile(latency, 90.0),
+        histogram_get_percentile(latency, 99.0),
+        latency->max
+    );
+}
 
 
-    /* Prints heading */
-    printf("%-*s %-*s %8s %8s %*s %10s %10s\n",
-        options.max_print_length, "Classifier",
-        options.max_print_length, "Dataset", 
-        "ID",
-        "Label",
-        LABELS_MIN_SIZE, "Concrete",
-        "Result",
-        "Time (s)"
+
+/**
+ * Prints latency of all samples of a summary and of samples of each
+ * verdict.
+ *
+ * @param[in] summary Summary
+ * @param[in] job_name Name of job, NULL to omit it
+ * @param[in] job_column_size Size of job column
+ */
+static void print_latency(
+    const Summary *summary,
+    const char *job_name,
+    const unsigned int job_column_size
+) {
+    Histogram latency;
+    unsigned int i;
+
+    summary_get_latency(&latency, summary);
+    print_latency_row(&latency, "ALL", job_name, job_column_size);
+    for (i = 0; i < N_VERDICTS; ++i) {
+        if (summary->latency[i].n_values > 0) {
+            print_latency_row(summary->latency + i, VERDICT_NAMES[i], job_name, job_column_size);
+        }
+    }
+}
+
+
+
+/**
+ * Prints heading of throughput table.
+ *
+ * @param[in] job_column_size Size of job column, 0 to omit it
+ */
+static void print_throughput_heading(const unsigned int job_column_size) {
+    printf("[THROUGHPUT] ");
+    if (job_column_size > 0) {
+        printf("%-*s ", job_column_size, "Job");
+    }
+    printf("%10s %10s %12s\n", "Size", "Wall (s)", "Samples/s");
+}
+
+
+
+/**
+ * Prints a row of throughput table.
+ *
+ * Wall time covers the whole analysis, thus throughput accounts for
+ * worker processes running in parallel. In the combined row of a jobs
+ * file, it covers all jobs, including the time spent between them.
+ *
+ * @param[in] summary Summary
+ * @param[in] job_name Name of job, NULL to omit it
+ * @param[in] job_column_size Size of job column
+ */
+static void print_throughput(
+    const Summary *summary,
+    const char *job_name,
+    const unsigned int job_column_size
+) {
+    printf("[THROUGHPUT] ");
+    if (job_name != NULL) {
+        printf("%-*s ", job_column_size, job_name);
+    }
+    printf(
+        "%10u %10g %12g\n",
+        summary->size,
+        summary->wall_time,
+        summary->wall_time > 0.0 ? summary->size / summary->wall_time : 0.0
     );
+}
 
 
 
-    /* Analyses each sample */
-    stopwatch_start(stopwatch);
-    for (i = 0; i < dataset_get_size(dataset); ++i) {
-        const double *sample = dataset_get_row(dataset, i);
-        const char *label = dataset_get_label(dataset, i);
-        const AdversarialRegion adversarial_region = {
-            sample,
-            classifier_get_feature_space_size(classifier),
-            options.perturbation
-        };
-        stability_status_set_sample(&status, (double *) sample, concrete_labels);
-
-        classifier_classify(concrete_labels, classifier, sample);
-        abstract_classifier_is_stable(
-            &status,
-            abstract_classifier,
-            adversarial_region
-        );
+/**
+ * Writes a string as a JSON string.
+ *
+ * @param[in] string String, NULL to write null
+ * @param[in,out] stream Stream
+ */
+static void write_json_string(const char *string, FILE *stream) {
+    if (string == NULL) {
+        fprintf(stream, "null");
+        return;
+    }
+
+    fputc('"', stream);
+    for (; *string != '\0'; ++string) {
+        if (*string == '"' || *string == '\\') {
+            fputc('\\', stream);
+        }
+        if ((unsigned char) *string >= 0x20) {
+            fputc(*string, stream);
+        }
+    }
+    fputc('"', stream);
+}
 
-        /* Computes statistics */
-        const unsigned int is_correct = set_is_singleton(concrete_labels)
-                                     && set_has_element(concrete_labels, label),
-                           is_stable = status.result == STABILITY_TRUE,
-                           is_unstable = status.result == STABILITY_FALSE;
-
-        n_correct    += is_correct;
-        n_stable     += is_stable;
-        n_unstable   += is_unstable;
-        n_robust     += is_correct && is_stable;
-        n_fragile    += is_correct && is_unstable;
-
-
-        /* Displays result */
-        stopwatch_pause(stopwatch);
-        sample_time = stopwatch_get_elapsed_time_seconds(stopwatch) - previous_cumulative_time;
-        previous_cumulative_time = stopwatch_get_elapsed_time_seconds(stopwatch);
-        print_string(options.classifier_path, options);
-        printf(" ");
-        print_string(options.dataset_path, options);
-        printf(" ");
-        printf("%8u %8s ", i, label);
-        print_labels(concrete_labels);
-        printf(" %10s",
-            is_stable
-            ? is_correct ? "ROBUST" : "VULNERABLE"
-            : is_unstable
-              ? is_correct ? "FRAGILE" : "BROKEN"
-              : "NO-INFO"
-        );
-        printf(" %10g\n", sample_time);
 
 
-        /* Exports counterexample, if necessary */
-        if (counterexamples_file != NULL && is_unstable) {
-            fprintf(counterexamples_file, "%d: ", i);
-            hyperrectangle_dump(status.region, counterexamples_file);
+/**
+ * Writes latency of samples as a JSON object.
+ *
+ * Buckets are written as pairs of upper bound and number of samples,
+ * omitting empty ones.
+ *
+ * @param[in] latency Latency of samples
+ * @param[in] verdict Name of verdict of samples
+ * @param[in,out] stream Stream
+ */
+static void write_latency_json(const Histogram *latency, const char *verdict, FILE *stream) {
+    unsigned int i, is_first = 1;
+
+    fprintf(
+        stream,
+        "{\"verdict\": \"%s\", \"size\": %llu, \"time\": %.17g, \"mean\": %.17g, "
+        "\"min\": %.17g, \"p50\": %.17g, \"p90\": %.17g, \"p99\": %.17g, \"max\": %.17g, \"buckets\": [",
+        verdict,
+        latency->n_values,
+        latency->sum,
+        latency->n_values > 0 ? latency->sum / latency->n_values : 0.0,
+        latency->min,
+        histogram_get_percentile(latency, 50.0),
+        histogram_get_percentile(latency, 90.0),
+        histogram_get_percentile(latency, 99.0),
+        latency->max
+    );
+    for (i = 0; i < HISTOGRAM_N_BUCKETS; ++i) {
+        if (latency->counts[i] > 0) {
+            fprintf(stream, "%s[%.17g, %llu]", is_first ? "" : ", ", histogram_get_bucket_upper_bound(i), latency->counts[i]);
+            is_first = 0;
         }
+    }
+    fprintf(stream, "]}");
+}
+
+
+
+/**
+ * Writes a summary as a JSON object.
+ *
+ * @param[in] summary Summary
+ * @param[in] job_name Name of job, NULL for a single analysis
+ * @param[in,out] stream Stream
+ */
+static void write_summary_json(const Summary *summary, const char *job_name, FILE *stream) {
+    Histogram latency;
+    unsigned int i;
+
+    fprintf(stream, "  {\"job\": ");
+    write_json_string(job_name, stream);
+    fprintf(
+        stream,
+        ", \"size\": %u, \"time\": %.17g, \"wall_time\": %.17g, \"throughput\": %.17g, "
+        "\"correct\": %u, \"stable\": %u, \"unstable\": %u, \"robust\": %u, \"fragile\": %u,\n",
+        summary->size,
+        summary->time,
+        summary->wall_time,
+        summary->wall_time > 0.0 ? summary->size / summary->wall_time : 0.0,
+        summary->n_correct,
+        summary->n_stable,
+        summary->n_unstable,
+        summary->n_robust,
+        summary->n_fragile
+    );
+
+    summary_get_latency(&latency, summary);
+    fprintf(stream, "   \"latency\": [\n    ");
+    write_latency_json(&latency, "ALL", stream);
+    for (i = 0; i < N_VERDICTS; ++i) {
+        fprintf(stream, ",\n    ");
+        write_latency_json(summary->latency + i, VERDICT_NAMES[i], stream);
+    }
+    fprintf(stream, "\n  ]}");
+}
 
 
-        /* Resumes stopwatch */
-        stopwatch_start(stopwatch);
+
+/**
+ * Writes summaries as a JSON array, one object per job followed by the
+ * combined one.
+ *
+ * @param[in] path Path to output file
+ * @param[in] summaries Summary of each job
+ * @param[in] jobs Jobs, NULL for a single analysis
+ * @param[in] n_jobs Number of jobs
+ * @param[in] total Combined summary
+ */
+static void write_summaries_json(
+    const char *path,
+    const Summary *summaries,
+    const Job *jobs,
+    const unsigned int n_jobs,
+    const Summary *total
+) {
+    FILE *stream = fopen(path, "w");
+    unsigned int i;
+
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot write file %s.\n", __FILE__, __LINE__, path);
+        abort();
     }
-    stopwatch_stop(stopwatch);
 
+    fprintf(stream, "[\n");
+    for (i = 0; i < n_jobs; ++i) {
+        write_summary_json(summaries + i, jobs[i].name, stream);
+        fprintf(stream, ",\n");
+    }
+    write_summary_json(total, jobs != NULL ? "ALL" : NULL, stream);
+    fprintf(stream, "\n]\n");
+    fclose(stream);
+}
 
-    /* Displays summary */
-    printf(
-        "[SUMMARY] %10s %10s %10s %10s %10s %10s %10s %10s %10s %12s %10s\n",
-        "Size", "Time (s)", "Correct", "Wrong", "Stable", "Unstable",
-        "No info", "Robust", "Fragile", "Vulnerable", "Broken"
+
+
+/**
+ * Prints how many samples an incremental analysis decided from the
+ * record of the previous run.
+ *
+ * @param[in] incremental State of incremental analysis
+ * @param[in] summary Summary
+ */
+static void print_incremental_summary(const Incremental incremental, const Summary summary) {
+    unsigned int t, n_changed = 0;
+
+    for (t = 0; t < incremental.record->n_trees; ++t) {
+        n_changed += incremental.is_changed[t];
+    }
+    printf("[INCREMENTAL] %10s %10s %10s %10s %10s\n",
+        "Trees", "Changed", "Reused", "Witnessed", "Analysed"
     );
-    printf(
-        "[SUMMARY] %10u %10g %10u %10u %10u %10u %10u %10u %10u %12u %10u\n",
-        dataset_get_size(dataset),
-        stopwatch_get_elapsed_time_seconds(stopwatch),
-        n_correct,
-        dataset_get_size(dataset) - n_correct,
-        n_stable,
-        n_unstable,
-        dataset_get_size(dataset) - n_stable - n_unstable,
-        n_robust,
-        n_fragile,
-        n_stable - n_robust,
-        n_unstable - n_fragile
+    printf("[INCREMENTAL] %10u %10u %10u %10u %10u\n",
+        incremental.record->n_trees,
+        n_changed,
+        incremental.n_reused,
+        incremental.n_witnessed,
+        summary.size - incremental.n_reused - incremental.n_witnessed
     );
+}
 
 
-    /* Closes counterexamples file, if necessary */
-    if (counterexamples_file != NULL) {
-        fclose(counterexamples_file);
+
+/**
+ * Computes a hash of the settings which affect results of an analysis.
+ *
+ * @param[in] classifier Classifier
+ * @param[in] options Options
+ * @return Hash of settings
+ */
+static unsigned long long settings_hash(const Classifier classifier, const Options *options) {
+    const Perturbation perturbation = options->perturbation;
+    unsigned long long hash = HASH_OFFSET;
+    unsigned int i;
+
+    hash = hash_bytes(hash, &perturbation.type, sizeof(perturbation.type));
+    switch (perturbation.type) {
+    case PERTURBATION_L_INF:
+        hash = hash_bytes(hash, &perturbation.data.l_inf.magnitude, sizeof(double));
+        break;
+    case PERTURBATION_L_INF_CLIP_ALL:
+        hash = hash_bytes(hash, &perturbation.data.l_inf_clip_all.magnitude, sizeof(double));
+        hash = hash_bytes(hash, &perturbation.data.l_inf_clip_all.min, sizeof(double));
+        hash = hash_bytes(hash, &perturbation.data.l_inf_clip_all.max, sizeof(double));
+        break;
+    case PERTURBATION_FROM_FILE:
+        break;
+    }
+    hash = hash_bytes(hash, &options->voting_scheme, sizeof(options->voting_scheme));
+    hash = hash_bytes(hash, &options->tier.size, sizeof(unsigned int));
+    hash = hash_bytes(hash, options->tier.tiers, options->tier.size * sizeof(unsigned int));
+    for (i = 0; i < classifier_get_n_labels(classifier); ++i) {
+        const char *label = classifier_get_labels_as_array(classifier)[i];
+        hash = hash_bytes(hash, label, strlen(label) + 1);
     }
 
+    return hash;
+}
 
-    /* Deallocates memory */
-    classifier_delete(&classifier);
-    dataset_delete(&dataset);
-    abstract_classifier_delete(&abstract_classifier);
-    set_delete(&concrete_labels);
-    set_delete(&abstract_labels);
-    free(status.sample_b);
-    hyperrectangle_delete(&status.region);
-    options_delete(&options);
-    stopwatch_delete(&stopwatch);
 
-    return EXIT_SUCCESS;
+
+/**
+ * Prepares an incremental analysis, reading the record of the previous
+ * run, if any.
+ *
+ * @param[out] incremental State of incremental analysis
+ * @param[in] classifier Classifier
+ * @param[in] dataset Dataset
+ * @param[in] options Options
+ */
+static void incremental_create(
+    Incremental *incremental,
+    const Classifier classifier,
+    const Dataset dataset,
+    const Options *options
+) {
+    const unsigned int space_size = classifier_get_feature_space_size(classifier),
+                       n_trees = classifier_get_type(classifier) == CLASSIFIER_FOREST
+                               ? forest_get_n_trees(classifier_get_forest(classifier))
+                               : 1;
+    const unsigned long long settings = settings_hash(classifier, options);
+    Record previous_record = NULL;
+    FILE *stream;
+    unsigned int t;
+
+    if (options->perturbation.type == PERTURBATION_FROM_FILE) {
+        fprintf(stderr, "[%s: %d] Incremental analysis does not support regions read from file.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    incremental->trees = (DecisionTree *) malloc(n_trees * sizeof(DecisionTree));
+    incremental->is_changed = (unsigned char *) malloc(n_trees * sizeof(unsigned char));
+    incremental->lower = (double *) malloc(space_size * sizeof(double));
+    incremental->upper = (double *) malloc(space_size * sizeof(double));
+    incremental->counterexample = (double *) malloc(2 * space_size * sizeof(double));
+    if (incremental->trees == NULL || incremental->is_changed == NULL || incremental->lower == NULL
+        || incremental->upper == NULL || incremental->counterexample == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (classifier_get_type(classifier) == CLASSIFIER_FOREST) {
+        memcpy(incremental->trees, forest_get_trees_as_array(classifier_get_forest(classifier)), n_trees * sizeof(DecisionTree));
+    }
+    else {
+        incremental->trees[0] = classifier_get_decision_tree(classifier);
+    }
+    hyperrectangle_create(&incremental->region, space_size);
+    set_create(&incremental->witness_labels, set_equality_string);
+    incremental->n_reused = 0;
+    incremental->n_witnessed = 0;
+
+
+    /* Reads previous record, ignoring it if it does not match this run */
+    stream = fopen(options->record_path, "rb");
+    if (stream != NULL) {
+        record_read(&previous_record, stream);
+        fclose(stream);
+        if (previous_record->settings_hash != settings
+            || previous_record->n_samples != dataset_get_size(dataset)
+            || previous_record->n_trees != n_trees
+            || previous_record->space_size != space_size) {
+            fprintf(stderr, "Record %s does not match current settings, classifier or dataset: analysing every sample.\n", options->record_path);
+            record_delete(&previous_record);
+        }
+    }
+    incremental->previous_record = previous_record;
+
+
+    /* Finds changed trees */
+    record_create(&incremental->record, settings, dataset_get_size(dataset), n_trees, space_size);
+    for (t = 0; t < n_trees; ++t) {
+        incremental->record->tree_hashes[t] = decision_tree_hash(incremental->trees[t], NULL, NULL);
+        incremental->is_changed[t] = previous_record == NULL
+                                  || previous_record->tree_hashes[t] != incremental->record->tree_hashes[t];
+    }
+}
+
+
+
+/**
+ * Writes the record of the current run and deletes the state of an
+ * incremental analysis.
+ *
+ * @param[in,out] incremental State of incremental analysis
+ * @param[in] options Options
+ */
+static void incremental_delete(Incremental *incremental, const Options *options) {
+    FILE *stream = fopen(options->record_path, "wb");
+
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot write record %s.\n", __FILE__, __LINE__, options->record_path);
+        abort();
+    }
+    record_write(incremental->record, stream);
+    fclose(stream);
+
+    if (incremental->previous_record != NULL) {
+        record_delete(&incremental->previous_record);
+    }
+    record_delete(&incremental->record);
+    hyperrectangle_delete(&incremental->region);
+    set_delete(&incremental->witness_labels);
+    free(incremental->trees);
+    free(incremental->is_changed);
+    free(incremental->lower);
+    free(incremental->upper);
+    free(incremental->counterexample);
+}
+
+
+
+/**
+ * Records a sample, hashing each tree restricted to its adversarial
+ * region.
+ *
+ * Hashes of trees which did not change are taken from the previous
+ * record, when it holds the same sample.
+ *
+ * @param[out] previous Entry of the sample in the previous record, NULL
+ *             if missing or holding a different sample
+ * @param[in,out] analysis Analysis
+ * @param[in] i Index of sample
+ * @return Entry of the sample in the current record, NULL if its region
+ *         cannot be hashed
+ */
+static RecordEntry *incremental_record_sample(
+    const RecordEntry **previous,
+    Analysis *analysis,
+    const unsigned int i
+) {
+    Incremental *incremental = analysis->incremental;
+    const unsigned int space_size = incremental->record->space_size;
+    const AdversarialRegion adversarial_region = {
+        analysis->sample,
+        space_size,
+        analysis->options->perturbation
+    };
+    const unsigned long long sample_hash = hash_bytes(
+        HASH_OFFSET,
+        dataset_get_row(analysis->dataset, i),
+        dataset_get_space_size(analysis->dataset) * sizeof(Storage)
+    );
+    RecordEntry *entry;
+    unsigned int j, t;
+
+    *previous = NULL;
+    classifier_hyperrectangle_get_region(incremental->region, adversarial_region);
+    for (j = 0; j < space_size; ++j) {
+        incremental->lower[j] = incremental->region->intervals[j].l;
+        incremental->upper[j] = incremental->region->intervals[j].u;
+        if (!(incremental->lower[j] <= incremental->upper[j])) {
+            return NULL;
+        }
+    }
+
+    if (incremental->previous_record != NULL
+        && incremental->previous_record->entries[i].is_present
+        && incremental->previous_record->entries[i].sample_hash == sample_hash) {
+        *previous = incremental->previous_record->entries + i;
+    }
+
+    entry = record_add_entry(incremental->record, i, sample_hash);
+    for (t = 0; t < incremental->record->n_trees; ++t) {
+        entry->tree_hashes[t] = *previous != NULL && !incremental->is_changed[t]
+                              ? (*previous)->tree_hashes[t]
+                              : decision_tree_hash(incremental->trees[t], incremental->lower, incremental->upper);
+    }
+
+    return entry;
+}
+
+
+
+/**
+ * Tries to decide a sample from its entry in the previous record.
+ *
+ * The previous result holds if no tree changed within the adversarial
+ * region; otherwise, a recorded witness which is still classified
+ * differently from the sample proves it unstable.
+ *
+ * @param[in,out] analysis Analysis
+ * @param[in] entry Entry of the sample in the current record
+ * @param[in] previous Entry of the sample in the previous record
+ * @return 1 if the sample was decided, 0 if it must be analysed
+ */
+static unsigned int incremental_reuse(
+    Analysis *analysis,
+    const RecordEntry *entry,
+    const RecordEntry *previous
+) {
+    Incremental *incremental = analysis->incremental;
+    StabilityStatus *status = &analysis->status;
+    const unsigned int space_size = incremental->record->space_size;
+    unsigned int j, t, is_affected = 0;
+
+    if (previous->result == STABILITY_DONT_KNOW) {
+        return 0;
+    }
+
+    for (t = 0; t < incremental->record->n_trees; ++t) {
+        is_affected |= entry->tree_hashes[t] != previous->tree_hashes[t];
+    }
+
+    /* Decision function is the same within the region: result holds */
+    if (!is_affected) {
+        status->result = previous->result;
+        if (previous->result == STABILITY_FALSE) {
+            memcpy(status->sample_b, previous->witness, space_size * sizeof(double));
+            for (j = 0; j < space_size; ++j) {
+                status->region->intervals[j].l = previous->counterexample[2 * j];
+                status->region->intervals[j].u = previous->counterexample[2 * j + 1];
+            }
+        }
+        ++incremental->n_reused;
+        return 1;
+    }
+
+    /* Witness still classified differently: sample is unstable. Ties are
+       left to the analysis, which compares sets of possible winners */
+    if (previous->result == STABILITY_FALSE && set_is_singleton(analysis->concrete_labels)) {
+        classifier_classify(incremental->witness_labels, analysis->classifier, previous->witness);
+        if (!set_is_equal(incremental->witness_labels, analysis->concrete_labels)) {
+            status->result = STABILITY_FALSE;
+            memcpy(status->sample_b, previous->witness, space_size * sizeof(double));
+            for (j = 0; j < space_size; ++j) {
+                status->region->intervals[j].l = previous->witness[j];
+                status->region->intervals[j].u = previous->witness[j];
+            }
+            ++incremental->n_witnessed;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * Stores the result of the analysis of a sample into the current record.
+ *
+ * @param[in,out] analysis Analysis
+ * @param[in,out] entry Entry of the sample in the current record
+ */
+static void incremental_set_result(Analysis *analysis, RecordEntry *entry) {
+    Incremental *incremental = analysis->incremental;
+    unsigned int j;
+
+    for (j = 0; j < incremental->record->space_size; ++j) {
+        incremental->counterexample[2 * j] = analysis->status.region->intervals[j].l;
+        incremental->counterexample[2 * j + 1] = analysis->status.region->intervals[j].u;
+    }
+    record_entry_set_result(
+        incremental->record,
+        entry,
+        analysis->status.result,
+        analysis->status.sample_b,
+        incremental->counterexample
+    );
+}
+
+
+
+/**
+ * Returns the verdict on a sample.
+ *
+ * @param[in] outcome Outcome of the analysis of the sample
+ * @return Verdict
+ */
+static Verdict outcome_get_verdict(const Outcome outcome) {
+    if (outcome.is_stable) {
+        return outcome.is_correct ? VERDICT_ROBUST : VERDICT_VULNERABLE;
+    }
+    if (outcome.is_unstable) {
+        return outcome.is_correct ? VERDICT_FRAGILE : VERDICT_BROKEN;
+    }
+
+    return VERDICT_NO_INFO;
+}
+
+
+
+/**
+ * Analyses a sample, printing its result.
+ *
+ * @param[out] outcome Outcome of the analysis
+ * @param[in,out] analysis Analysis
+ * @param[in] i Index of sample
+ * @param[in,out] stream Stream of results
+ * @param[in,out] counterexamples_stream Stream of counterexamples, or NULL
+ */
+static void analyse_sample(
+    Outcome *outcome,
+    Analysis *analysis,
+    const unsigned int i,
+    FILE *stream,
+    FILE *counterexamples_stream
+) {
+    const Options *options = analysis->options;
+    const Storage *row = dataset_get_row(analysis->dataset, i);
+    const char *label = dataset_get_label(analysis->dataset, i);
+    const AdversarialRegion adversarial_region = {
+        analysis->sample,
+        classifier_get_feature_space_size(analysis->classifier),
+        options->perturbation
+    };
+    RecordEntry *entry = NULL;
+    const RecordEntry *previous = NULL;
+    unsigned int j;
+
+    if (analysis->status.trace != NULL) {
+        trace_add(analysis->status.trace, TRACE_BEGIN, "sample", "index", i, NULL, 0.0);
+    }
+    stopwatch_reset(analysis->stopwatch);
+    stopwatch_start(analysis->stopwatch);
+    for (j = 0; j < dataset_get_space_size(analysis->dataset); ++j) {
+        analysis->sample[j] = row[j];
+    }
+    stability_status_set_sample(&analysis->status, analysis->sample, analysis->concrete_labels);
+
+    if (analysis->block_labels != NULL) {
+        set_copy(analysis->concrete_labels, analysis->block_labels);
+    }
+    else {
+        profiler_enter(analysis->profiler, "classification");
+        classifier_classify(analysis->concrete_labels, analysis->classifier, analysis->sample);
+        profiler_exit(analysis->profiler);
+    }
+    if (analysis->incremental != NULL) {
+        entry = incremental_record_sample(&previous, analysis, i);
+    }
+    analysis->status.peak_memory = 0;
+    if (previous == NULL || !incremental_reuse(analysis, entry, previous)) {
+        profiler_enter(analysis->profiler, "stability");
+        if (analysis->diagram != NULL) {
+            classifier_hyperrectangle_get_region(analysis->region, adversarial_region);
+            decision_diagram_is_stable(&analysis->status, analysis->diagram, analysis->region);
+        }
+        else {
+            abstract_classifier_is_stable(
+                &analysis->status,
+                analysis->abstract_classifier,
+                adversarial_region
+            );
+        }
+        profiler_exit(analysis->profiler);
+    }
+    if (entry != NULL) {
+        incremental_set_result(analysis, entry);
+    }
+    stopwatch_pause(analysis->stopwatch);
+    if (analysis->status.trace != NULL) {
+        trace_add(analysis->status.trace, TRACE_END, "sample", "result", analysis->status.result, NULL, 0.0);
+    }
+
+    /* Computes statistics */
+    outcome->is_correct = set_is_singleton(analysis->concrete_labels)
+                       && *(char **) set_get_elements_as_array(analysis->concrete_labels)
+                          == analysis->expected_labels[dataset_get_label_id(analysis->dataset, i)];
+    outcome->is_stable = analysis->status.result == STABILITY_TRUE;
+    outcome->is_unstable = analysis->status.result == STABILITY_FALSE;
+    outcome->time = stopwatch_get_elapsed_time_seconds(analysis->stopwatch)
+                  + (analysis->block_labels != NULL ? analysis->block_time : 0.0);
+    outcome->memory = analysis->status.peak_memory;
+
+
+    /* Displays result */
+    profiler_enter(analysis->profiler, "output");
+    print_string(options->classifier_path, *options, stream);
+    fprintf(stream, " ");
+    print_string(options->dataset_path, *options, stream);
+    fprintf(stream, " ");
+    fprintf(stream, "%8u %8s ", i, label);
+    print_labels(analysis->concrete_labels, stream);
+    fprintf(stream, " %10s", VERDICT_NAMES[outcome_get_verdict(*outcome)]);
+    fprintf(stream, " %10g", outcome->time);
+    fprintf(stream, " %11.1f\n", outcome->memory / 1024.0);
+
+
+    /* Exports counterexample, if necessary */
+    if (counterexamples_stream != NULL && outcome->is_unstable) {
+        fprintf(counterexamples_stream, "%d: ", i);
+        hyperrectangle_dump(analysis->status.region, counterexamples_stream);
+    }
+    profiler_exit(analysis->profiler);
+    profiler_count(analysis->profiler, "samples", 1);
+}
+
+
+
+/**
+ * Adds outcome of the analysis of a sample to a summary.
+ *
+ * @param[in,out] summary Summary
+ * @param[in] outcome Outcome
+ */
+static void summary_add_outcome(Summary *summary, const Outcome outcome) {
+    summary->size       += 1;
+    summary->time       += outcome.time;
+    summary->n_correct  += outcome.is_correct;
+    summary->n_stable   += outcome.is_stable;
+    summary->n_unstable += outcome.is_unstable;
+    summary->n_robust   += outcome.is_correct && outcome.is_stable;
+    summary->n_fragile  += outcome.is_correct && outcome.is_unstable;
+    histogram_add(summary->latency + outcome_get_verdict(outcome), outcome.time);
+}
+
+
+
+/**
+ * Initializes an empty summary.
+ *
+ * @param[out] summary Summary
+ */
+static void summary_init(Summary *summary) {
+    unsigned int i;
+
+    summary->size = 0;
+    summary->time = 0.0;
+    summary->n_correct = 0;
+    summary->n_stable = 0;
+    summary->n_unstable = 0;
+    summary->n_robust = 0;
+    summary->n_fragile = 0;
+    summary->wall_time = 0.0;
+    for (i = 0; i < N_VERDICTS; ++i) {
+        histogram_init(summary->latency + i);
+    }
+}
+
+
+
+/**
+ * Adds a summary to another one.
+ *
+ * @param[in,out] summary Summary
+ * @param[in] other Summary to add
+ */
+static void summary_add(Summary *summary, const Summary *other) {
+    unsigned int i;
+
+    summary->size       += other->size;
+    summary->time       += other->time;
+    summary->n_correct  += other->n_correct;
+    summary->n_stable   += other->n_stable;
+    summary->n_unstable += other->n_unstable;
+    summary->n_robust   += other->n_robust;
+    summary->n_fragile  += other->n_fragile;
+    summary->wall_time  += other->wall_time;
+    for (i = 0; i < N_VERDICTS; ++i) {
+        histogram_merge(summary->latency + i, other->latency + i);
+    }
+}
+
+
+
+/**
+ * Requests a snapshot of progress, on SIGUSR1.
+ *
+ * @param[in] signal Signal
+ */
+static void request_snapshot(int signal) {
+    (void) signal;
+    is_snapshot_requested = 1;
+}
+
+
+
+/**
+ * Requests to stop the analysis after the current sample, on SIGINT and
+ * SIGTERM.
+ *
+ * @param[in] signal Signal
+ */
+static void request_stop(int signal) {
+    stop_signal = signal;
+}
+
+
+
+/**
+ * Installs handlers of signals requesting snapshots and stops.
+ *
+ * @param[in] is_reset 1 to restore default handling of stop signals
+ *            once received, so that a second one terminates the process,
+ *            0 otherwise
+ */
+static void install_signal_handlers(const unsigned int is_reset) {
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(struct sigaction));
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    action.sa_handler = request_snapshot;
+    sigaction(SIGUSR1, &action, NULL);
+
+    action.sa_flags = SA_RESTART | (is_reset ? SA_RESETHAND : 0);
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+
+
+/**
+ * Prints a snapshot of progress.
+ *
+ * @param[in] progress Progress
+ * @param[in] summary Summary of samples analysed so far
+ */
+static void progress_print(const Progress *progress, const Summary *summary) {
+    const double elapsed = stopwatch_read_clock(STOPWATCH_CLOCK_WALL) - progress->start_time,
+                 rate = elapsed > 0.0 ? summary->size / elapsed : 0.0;
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(
+        progress->stream,
+        "[PROGRESS] %u/%u samples, %u robust, %u fragile, %u vulnerable, %u broken, %u no info, "
+        "%g samples/s, ETA %g s, peak memory %g MB\n",
+        summary->size,
+        progress->n_samples,
+        summary->n_robust,
+        summary->n_fragile,
+        summary->n_stable - summary->n_robust,
+        summary->n_unstable - summary->n_fragile,
+        summary->size - summary->n_stable - summary->n_unstable,
+        rate,
+        rate > 0.0 ? (progress->n_samples - summary->size) / rate : INFINITY,
+        usage.ru_maxrss / 1024.0
+    );
+    fflush(progress->stream);
+}
+
+
+
+/**
+ * Updates progress after a sample, printing a snapshot if requested or
+ * periodically due.
+ *
+ * @param[in,out] progress Progress
+ * @param[in] summary Summary of samples analysed so far
+ * @return 1 if analysis must stop, 0 otherwise
+ */
+static unsigned int progress_update(Progress *progress, const Summary *summary) {
+    if (is_snapshot_requested
+        || (progress->interval > 0.0 && stopwatch_read_clock(STOPWATCH_CLOCK_WALL) - progress->last_time >= progress->interval)) {
+        is_snapshot_requested = 0;
+        progress->last_time = stopwatch_read_clock(STOPWATCH_CLOCK_WALL);
+        progress_print(progress, summary);
+    }
+
+    return stop_signal != 0;
+}
+
+
+
+/**
+ * Writes a buffer to a file descriptor.
+ *
+ * @param[in] fd File descriptor
+ * @param[in] buffer Buffer
+ * @param[in] size Size of buffer
+ */
+static void write_all(const int fd, const void *buffer, size_t size) {
+    if (!descriptor_write_all(fd, buffer, size)) {
+        fprintf(stderr, "[%s: %d] Cannot write to pipe.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Reads a buffer from a file descriptor.
+ *
+ * @param[in] fd File descriptor
+ * @param[out] buffer Buffer
+ * @param[in] size Size of buffer
+ * @return 1 if buffer was read, 0 on end of file before any byte
+ */
+static unsigned int read_all(const int fd, void *buffer, size_t size) {
+    char *position = (char *) buffer;
+    const size_t total = size;
+
+    while (size > 0) {
+        const ssize_t n = read(fd, position, size);
+        if (n == 0 && size == total) {
+            return 0;
+        }
+        if (n <= 0) {
+            fprintf(stderr, "[%s: %d] Cannot read from pipe.\n", __FILE__, __LINE__);
+            abort();
+        }
+        position += n;
+        size -= n;
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * Compares estimates by decreasing difficulty, then by position.
+ *
+ * @param[in] a First estimate
+ * @param[in] b Second estimate
+ * @return Negative, zero or positive value if a comes before, together
+ *         with or after b
+ */
+static int compare_estimates(const void *a, const void *b) {
+    const Estimate *x = (const Estimate *) a, *y = (const Estimate *) b;
+
+    if (x->difficulty != y->difficulty) {
+        return x->difficulty > y->difficulty ? -1 : 1;
+    }
+    return (x->position > y->position) - (x->position < y->position);
+}
+
+
+
+/**
+ * Computes the order in which samples are analysed, according to the
+ * selected schedule.
+ *
+ * @param[out] order Positions of samples, in the order they are analysed
+ * @param[in,out] analysis Analysis
+ * @param[in] first Index of first sample
+ * @param[in] step Distance between indices of consecutive samples
+ * @param[in] n_positions Number of samples
+ */
+static void schedule_samples(
+    unsigned int *order,
+    Analysis *analysis,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n_positions
+) {
+    const AdversarialRegion adversarial_region = {
+        analysis->sample,
+        classifier_get_feature_space_size(analysis->classifier),
+        analysis->options->perturbation
+    };
+    Estimate *estimates;
+    unsigned int i, j;
+
+    if (analysis->options->schedule == SCHEDULE_DATASET || n_positions == 0) {
+        for (i = 0; i < n_positions; ++i) {
+            order[i] = i;
+        }
+        return;
+    }
+
+    estimates = (Estimate *) malloc(n_positions * sizeof(Estimate));
+    if (estimates == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < n_positions; ++i) {
+        const Storage *row = dataset_get_row(analysis->dataset, first + i * step);
+        for (j = 0; j < dataset_get_space_size(analysis->dataset); ++j) {
+            analysis->sample[j] = row[j];
+        }
+        estimates[i].position = i;
+        estimates[i].difficulty = abstract_classifier_estimate_difficulty(
+            analysis->abstract_classifier,
+            adversarial_region
+        );
+    }
+
+    qsort(estimates, n_positions, sizeof(Estimate), compare_estimates);
+    for (i = 0; i < n_positions; ++i) {
+        order[i] = estimates[i].position;
+    }
+    free(estimates);
+}
+
+
+
+/**
+ * Worker process: analyses samples whose position is taken from a shared
+ * counter, sending results to the parent process.
+ *
+ * @param[in,out] analysis Analysis
+ * @param[in,out] counter Shared counter of positions
+ * @param[in] order Positions of samples, in the order they are analysed
+ * @param[in] first Index of first sample
+ * @param[in] step Distance between indices of consecutive samples
+ * @param[in] n_positions Number of samples
+ * @param[in] fd Write end of pipe to parent
+ */
+static void worker(
+    Analysis *analysis,
+    unsigned int *counter,
+    const unsigned int *order,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n_positions,
+    const int fd
+) {
+    const unsigned int export_counterexamples = analysis->options->counterexamples_path != NULL;
+    Message message;
+    char *line, *counterexample;
+    FILE *stream, *counterexamples_stream;
+    unsigned int k;
+
+    /* Counts statistics of this worker only */
+    for (k = 0; k < CASCADE_N_STAGES; ++k) {
+        analysis->options->cascade.n_entered[k] = 0;
+        analysis->options->cascade.n_decided[k] = 0;
+        analysis->options->cascade.time[k] = 0.0;
+    }
+    profiler_init(analysis->profiler, analysis->profiler->enabled);
+    install_signal_handlers(0);
+
+    /* Stops fetching samples once requested, the parent waits for the
+       current one */
+    while (stop_signal == 0 && (k = __sync_fetch_and_add(counter, 1)) < n_positions) {
+        message.position = order[k];
+        stream = open_memstream(&line, &message.line_size);
+        counterexamples_stream = open_memstream(&counterexample, &message.counterexample_size);
+        if (stream == NULL || counterexamples_stream == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+            abort();
+        }
+
+        analyse_sample(
+            &message.outcome,
+            analysis,
+            first + message.position * step,
+            stream,
+            export_counterexamples ? counterexamples_stream : NULL
+        );
+        fclose(stream);
+        fclose(counterexamples_stream);
+
+        write_all(fd, &message, sizeof(Message));
+        write_all(fd, line, message.line_size);
+        write_all(fd, counterexample, message.counterexample_size);
+        free(line);
+        free(counterexample);
+    }
+
+    /* Sends cascade statistics */
+    message.position = UINT_MAX;
+    message.line_size = 0;
+    message.counterexample_size = 0;
+    write_all(fd, &message, sizeof(Message));
+    write_all(fd, &analysis->options->cascade, sizeof(Cascade));
+    write_all(fd, analysis->profiler, sizeof(Profiler));
+
+    /* Writes events of this worker, sharing the trace file */
+    if (analysis->status.trace != NULL) {
+        trace_flush(analysis->status.trace);
+    }
+}
+
+
+
+/**
+ * Analyses samples using worker processes, which share the classifier and
+ * dataset copy-on-write and take samples according to the selected
+ * schedule, then prints results in dataset order.
+ *
+ * @param[out] summary Summary of the analysis
+ * @param[in,out] analysis Analysis
+ * @param[in] first Index of first sample
+ * @param[in] step Distance between indices of consecutive samples
+ * @param[in] n_positions Number of samples
+ * @param[in,out] counterexamples_file Counterexamples file, or NULL
+ */
+static void analyse_with_processes(
+    Summary *summary,
+    Analysis *analysis,
+    const unsigned int first,
+    const unsigned int step,
+    const unsigned int n_positions,
+    FILE *counterexamples_file
+) {
+    const unsigned int n_processes = analysis->options->n_processes;
+    /* Polling wakes up for periodic snapshots even if no result comes */
+    const int timeout = analysis->progress->interval > 0.0
+                      ? (int) ceil(analysis->progress->interval * 1000.0)
+                      : -1;
+    unsigned int *counter, p, q, n_open = n_processes, next = 0, k, is_stop_sent = 0;
+    struct pollfd *pipes = (struct pollfd *) malloc(n_processes * sizeof(struct pollfd));
+    pid_t *pids = (pid_t *) malloc(n_processes * sizeof(pid_t));
+    char **lines = (char **) calloc(n_positions, sizeof(char *)),
+         **counterexamples = (char **) calloc(n_positions, sizeof(char *));
+    Outcome *outcomes = (Outcome *) malloc(n_positions * sizeof(Outcome));
+    unsigned int *order = (unsigned int *) malloc(n_positions * sizeof(unsigned int));
+    Message message;
+    Cascade cascade;
+    Profiler profiler;
+    Summary received;
+    int fds[2];
+
+    if (pipes == NULL || pids == NULL || (n_positions > 0 && (lines == NULL || counterexamples == NULL || outcomes == NULL || order == NULL))) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    counter = (unsigned int *) mmap(NULL, sizeof(unsigned int), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (counter == MAP_FAILED) {
+        fprintf(stderr, "[%s: %d] Cannot map shared memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    *counter = 0;
+    schedule_samples(order, analysis, first, step, n_positions);
+
+
+    /* Starts workers, flushing streams they would otherwise inherit */
+    fflush(stdout);
+    if (counterexamples_file != NULL) {
+        fflush(counterexamples_file);
+    }
+    /* Workers must not write events of this process again */
+    if (analysis->status.trace != NULL) {
+        trace_flush(analysis->status.trace);
+    }
+    for (p = 0; p < n_processes; ++p) {
+        if (pipe(fds) == -1 || (pids[p] = fork()) == -1) {
+            fprintf(stderr, "[%s: %d] Cannot start worker process.\n", __FILE__, __LINE__);
+            abort();
+        }
+        if (pids[p] == 0) {
+            close(fds[0]);
+            for (q = 0; q < p; ++q) {
+                close(pipes[q].fd);
+            }
+            worker(analysis, counter, order, first, step, n_positions, fds[1]);
+            close(fds[1]);
+            _exit(EXIT_SUCCESS);
+        }
+        close(fds[1]);
+        pipes[p].fd = fds[0];
+        pipes[p].events = POLLIN;
+    }
+
+
+    /* Collects results, printing them in order, progress counting them as
+       soon as received */
+    summary_init(&received);
+    while (n_open > 0) {
+        /* Workers stop after their current sample */
+        if (stop_signal != 0 && !is_stop_sent) {
+            for (p = 0; p < n_processes; ++p) {
+                kill(pids[p], SIGTERM);
+            }
+            is_stop_sent = 1;
+        }
+
+        if (poll(pipes, n_processes, timeout) == -1) {
+            if (errno != EINTR) {
+                fprintf(stderr, "[%s: %d] Cannot poll worker processes.\n", __FILE__, __LINE__);
+                abort();
+            }
+            /* Interrupted by a signal requesting a snapshot or a stop */
+            progress_update(analysis->progress, &received);
+            continue;
+        }
+
+        for (p = 0; p < n_processes; ++p) {
+            if (pipes[p].fd < 0 || pipes[p].revents == 0) {
+                continue;
+            }
+
+            if (!read_all(pipes[p].fd, &message, sizeof(Message))) {
+                close(pipes[p].fd);
+                pipes[p].fd = -1;
+                --n_open;
+                continue;
+            }
+
+            if (message.position == UINT_MAX) {
+                read_all(pipes[p].fd, &cascade, sizeof(Cascade));
+                for (k = 0; k < CASCADE_N_STAGES; ++k) {
+                    analysis->options->cascade.n_entered[k] += cascade.n_entered[k];
+                    analysis->options->cascade.n_decided[k] += cascade.n_decided[k];
+                    analysis->options->cascade.time[k] += cascade.time[k];
+                }
+                read_all(pipes[p].fd, &profiler, sizeof(Profiler));
+                profiler_merge(analysis->profiler, &profiler);
+                continue;
+            }
+
+            lines[message.position] = (char *) malloc(message.line_size + 1);
+            counterexamples[message.position] = (char *) malloc(message.counterexample_size + 1);
+            if (lines[message.position] == NULL || counterexamples[message.position] == NULL) {
+                fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+                abort();
+            }
+            read_all(pipes[p].fd, lines[message.position], message.line_size);
+            read_all(pipes[p].fd, counterexamples[message.position], message.counterexample_size);
+            lines[message.position][message.line_size] = '\0';
+            counterexamples[message.position][message.counterexample_size] = '\0';
+            outcomes[message.position] = message.outcome;
+            summary_add_outcome(&received, message.outcome);
+
+            for (; next < n_positions && lines[next] != NULL; ++next) {
+                fputs(lines[next], stdout);
+                if (counterexamples_file != NULL) {
+                    fputs(counterexamples[next], counterexamples_file);
+                }
+                summary_add_outcome(summary, outcomes[next]);
+                free(lines[next]);
+                free(counterexamples[next]);
+                lines[next] = counterexamples[next] = NULL;
+            }
+        }
+        progress_update(analysis->progress, &received);
+    }
+
+    for (p = 0; p < n_processes; ++p) {
+        int status;
+        waitpid(pids[p], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            fprintf(stderr, "[%s: %d] Worker process failed.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+    if (next < n_positions && stop_signal == 0) {
+        fprintf(stderr, "[%s: %d] Missing results from worker processes.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    /* Prints results following the first missing one, if stopped */
+    for (; next < n_positions; ++next) {
+        if (lines[next] != NULL) {
+            fputs(lines[next], stdout);
+            if (counterexamples_file != NULL) {
+                fputs(counterexamples[next], counterexamples_file);
+            }
+            summary_add_outcome(summary, outcomes[next]);
+            free(lines[next]);
+            free(counterexamples[next]);
+        }
+    }
+
+
+    /* Deallocates memory */
+    munmap(counter, sizeof(unsigned int));
+    free(pipes);
+    free(pids);
+    free(lines);
+    free(counterexamples);
+    free(outcomes);
+    free(order);
+}
+
+
+
+/**
+ * Analyses every sample of the selected shard of a dataset, printing one
+ * line per sample.
+ *
+ * @param[out] summary Summary of the analysis
+ * @param[in] classifier Classifier
+ * @param[in] abstract_classifier Abstract classifier
+ * @param[in] dataset Dataset
+ * @param[in,out] options Options
+ * @param[in,out] counterexamples_file Counterexamples file, or NULL
+ * @param[in,out] incremental State of incremental analysis, or NULL
+ * @param[in,out] diagram Decision diagram, or NULL to search
+ */
+static void analyse(
+    Summary *summary,
+    const Classifier classifier,
+    const AbstractClassifier abstract_classifier,
+    const Dataset dataset,
+    Options *options,
+    FILE *counterexamples_file,
+    Incremental *incremental,
+    DecisionDiagram diagram
+) {
+    const unsigned int size = dataset_get_size(dataset),
+                       first = options->shard_layout == SHARD_STRIDE
+                             ? options->shard_index
+                             : (unsigned int) ((unsigned long) options->shard_index * size / options->n_shards),
+                       last = options->shard_layout == SHARD_STRIDE
+                            ? size
+                            : (unsigned int) ((unsigned long) (options->shard_index + 1) * size / options->n_shards),
+                       step = options->shard_layout == SHARD_STRIDE ? options->n_shards : 1,
+                       n_positions = first < last ? (last - first + step - 1) / step : 0;
+    /* Regions read from file are read in order, and records are updated,
+       thus by this process only */
+    const unsigned int use_processes = options->n_processes > 1
+                                    && options->perturbation.type != PERTURBATION_FROM_FILE
+                                    && incremental == NULL,
+                       use_blocks = !use_processes && options->data_layout == DATA_LAYOUT_COLUMNS;
+    unsigned int i;
+    Analysis analysis;
+    Outcome outcome;
+    Set block_labels[SAMPLE_BLOCK_SIZE];
+    Stopwatch stopwatch;
+    Progress progress;
+
+
+    /* Prepares auxiliary data structures */
+    analysis.classifier = classifier;
+    analysis.abstract_classifier = abstract_classifier;
+    analysis.dataset = dataset;
+    analysis.options = options;
+    analysis.incremental = incremental;
+    analysis.diagram = diagram;
+    analysis.expected_labels = (char **) malloc(dataset_get_n_labels(dataset) * sizeof(char *));
+    for (i = 0; i < dataset_get_n_labels(dataset); ++i) {
+        const char *label = dataset_get_labels_as_array(dataset)[i];
+        unsigned int j;
+
+        analysis.expected_labels[i] = NULL;
+        for (j = 0; j < classifier_get_n_labels(classifier); ++j) {
+            if (strcmp(classifier_get_labels_as_array(classifier)[j], label) == 0) {
+                analysis.expected_labels[i] = classifier_get_labels_as_array(classifier)[j];
+            }
+        }
+    }
+    set_create(&analysis.concrete_labels, set_equality_string);
+    analysis.block_labels = NULL;
+    analysis.block_time = 0.0;
+    if (use_blocks) {
+        dataset_create_columns(dataset);
+        for (i = 0; i < SAMPLE_BLOCK_SIZE; ++i) {
+            set_create(block_labels + i, set_equality_string);
+        }
+    }
+    analysis.sample = malloc(dataset_get_space_size(dataset) * sizeof(double));
+    analysis.status.sample_b = malloc(classifier_get_feature_space_size(classifier) * sizeof(double));
+    hyperrectangle_create(&analysis.status.region, classifier_get_feature_space_size(classifier));
+    hyperrectangle_create(&analysis.region, classifier_get_feature_space_size(classifier));
+    analysis.status.labels_a = analysis.concrete_labels;
+    analysis.status.timeout = options->sample_timeout;
+    analysis.status.memory_limit = (size_t) options->sample_memory_limit << 20;
+    analysis.status.cascade = options->cascade.enabled ? &options->cascade : NULL;
+    analysis.status.profiler = options->profiler.enabled ? &options->profiler : NULL;
+    analysis.status.trace = options->trace;
+    analysis.profiler = &options->profiler;
+    stopwatch_create(&analysis.stopwatch);
+    progress.stream = stderr;
+    if (options->progress_path != NULL) {
+        progress.stream = fopen(options->progress_path, "a");
+        if (progress.stream == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot open progress file %s.\n", __FILE__, __LINE__, options->progress_path);
+            abort();
+        }
+    }
+    progress.interval = options->progress_interval;
+    progress.start_time = progress.last_time = stopwatch_read_clock(STOPWATCH_CLOCK_WALL);
+    progress.n_samples = n_positions;
+    analysis.progress = &progress;
+
+    summary_init(summary);
+    stopwatch_create(&stopwatch);
+
+
+    /* Analyses each sample */
+    profiler_enter(analysis.profiler, "analysis");
+    if (use_processes) {
+        analyse_with_processes(summary, &analysis, first, step, n_positions, counterexamples_file);
+    }
+    else if (use_blocks) {
+        for (i = 0; i < n_positions; ++i) {
+            const unsigned int k = i % SAMPLE_BLOCK_SIZE;
+
+            /* Classifies next block */
+            if (k == 0) {
+                const unsigned int n = n_positions - i < SAMPLE_BLOCK_SIZE ? n_positions - i : SAMPLE_BLOCK_SIZE;
+                profiler_enter(analysis.profiler, "classification");
+                stopwatch_reset(analysis.stopwatch);
+                stopwatch_start(analysis.stopwatch);
+                classifier_classify_block(
+                    block_labels,
+                    classifier,
+                    (const Storage * const *) dataset_get_columns_as_array(dataset),
+                    first + i * step,
+                    step,
+                    n
+                );
+                stopwatch_pause(analysis.stopwatch);
+                profiler_exit(analysis.profiler);
+                analysis.block_time = stopwatch_get_elapsed_time_seconds(analysis.stopwatch) / n;
+            }
+
+            analysis.block_labels = block_labels[k];
+            analyse_sample(&outcome, &analysis, first + i * step, stdout, counterexamples_file);
+            summary_add_outcome(summary, outcome);
+            if (progress_update(&progress, summary)) {
+                break;
+            }
+        }
+        analysis.block_labels = NULL;
+    }
+    else {
+        for (i = 0; i < n_positions; ++i) {
+            analyse_sample(&outcome, &analysis, first + i * step, stdout, counterexamples_file);
+            summary_add_outcome(summary, outcome);
+            if (progress_update(&progress, summary)) {
+                break;
+            }
+        }
+    }
+    profiler_exit(analysis.profiler);
+    stopwatch_pause(stopwatch);
+    summary->wall_time = stopwatch_get_elapsed_time_seconds(stopwatch);
+    stopwatch_delete(&stopwatch);
+
+
+    /* Deallocates memory */
+    if (use_blocks) {
+        for (i = 0; i < SAMPLE_BLOCK_SIZE; ++i) {
+            set_delete(block_labels + i);
+        }
+    }
+    free(analysis.expected_labels);
+    set_delete(&analysis.concrete_labels);
+    free(analysis.sample);
+    free(analysis.status.sample_b);
+    hyperrectangle_delete(&analysis.status.region);
+    hyperrectangle_delete(&analysis.region);
+    stopwatch_delete(&analysis.stopwatch);
+    if (progress.stream != stderr) {
+        fclose(progress.stream);
+    }
+}
+
+
+
+/**
+ * Simplifies a classifier, if requested by options.
+ *
+ * @param[in,out] classifier Classifier
+ * @param[in] options Options
+ */
+static void optimize_classifier(Classifier classifier, const Options *options) {
+    const unsigned int space_size = classifier_get_feature_space_size(classifier);
+    double *lower = NULL, *upper = NULL;
+    unsigned int i;
+
+    if (!options->optimize) {
+        return;
+    }
+
+    if (options->has_input_bounds) {
+        lower = (double *) malloc(space_size * sizeof(double));
+        upper = (double *) malloc(space_size * sizeof(double));
+        if (space_size > 0 && (lower == NULL || upper == NULL)) {
+            fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+            abort();
+        }
+        for (i = 0; i < space_size; ++i) {
+            lower[i] = options->input_lower;
+            upper[i] = options->input_upper;
+        }
+    }
+
+    classifier_optimize(classifier, lower, upper);
+
+    free(lower);
+    free(upper);
+}
+
+
+
+/**
+ * Loads the decision diagram of a classifier.
+ *
+ * @param[in] classifier Classifier, with voting scheme set
+ * @param[in] options Options
+ * @return Decision diagram
+ */
+static DecisionDiagram load_diagram(const Classifier classifier, const Options *options) {
+    DecisionDiagram diagram;
+    FILE *stream;
+    unsigned int i;
+
+    if (classifier_get_type(classifier) != CLASSIFIER_FOREST) {
+        fprintf(stderr, "[%s: %d] Decision diagrams are only supported for forests.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (options->perturbation.type == PERTURBATION_FROM_FILE) {
+        fprintf(stderr, "[%s: %d] Decision diagrams do not support regions read from file.\n", __FILE__, __LINE__);
+        abort();
+    }
+    for (i = 0; i < options->tier.size; ++i) {
+        if (options->tier.tiers[i] != 0) {
+            fprintf(stderr, "[%s: %d] Decision diagrams do not support tiers.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+
+    stream = fopen(options->diagram_path, "rb");
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot read decision diagram %s.\n", __FILE__, __LINE__, options->diagram_path);
+        abort();
+    }
+    decision_diagram_read(&diagram, stream);
+    fclose(stream);
+
+    if (!decision_diagram_matches(diagram, classifier_get_forest(classifier))) {
+        fprintf(stderr, "[%s: %d] Decision diagram %s was not compiled from this classifier with this voting scheme%s.\n", __FILE__, __LINE__, options->diagram_path, options->optimize ? ", or the classifier was changed by --optimize" : "");
+        abort();
+    }
+
+    return diagram;
+}
+
+
+
+/**
+ * Runs a single analysis, as given by command-line options.
+ *
+ * @param[in,out] options Options
+ */
+static void run_single(Options *options) {
+    FILE *classifier_file, *dataset_file, *counterexamples_file = NULL;
+    Dataset dataset;
+    Classifier classifier;
+    AbstractClassifier abstract_classifier;
+    CompiledForest compiled_forest = NULL;
+    DecisionDiagram diagram = NULL;
+    Summary summary;
+    Incremental incremental;
+
+
+    /* Reads dataset */
+    profiler_enter(&options->profiler, "dataset load");
+    dataset_file = fopen(options->dataset_path, "r");
+    dataset = dataset_read(dataset_file);
+    fclose(dataset_file);
+    profiler_exit(&options->profiler);
+
+
+    /* Reads classifier */
+    profiler_enter(&options->profiler, "model load");
+    classifier_file = fopen(options->classifier_path, "r");
+    classifier_silva_read(&classifier, classifier_file);
+    fclose(classifier_file);
+    optimize_classifier(classifier, options);
+    if (classifier_get_type(classifier) == CLASSIFIER_FOREST) {
+        forest_set_voting_scheme(classifier_get_forest(classifier), options->voting_scheme);
+    }
+
+
+    /* Loads compiled model, if necessary */
+    if (options->compiled_model_path != NULL) {
+        if (classifier_get_type(classifier) != CLASSIFIER_FOREST) {
+            fprintf(stderr, "[%s: %d] Compiled models are only supported for forests.\n", __FILE__, __LINE__);
+            abort();
+        }
+        if (options->optimize) {
+            fprintf(stderr, "[%s: %d] Compiled models refer to leaves of the original trees, and cannot be used with --optimize.\n", __FILE__, __LINE__);
+            abort();
+        }
+        compiled_forest_create(&compiled_forest, options->compiled_model_path);
+        compiled_forest_attach(compiled_forest, classifier_get_forest(classifier));
+    }
+
+
+    /* Loads decision diagram, if necessary */
+    if (options->diagram_path != NULL) {
+        diagram = load_diagram(classifier, options);
+    }
+
+
+    /* Creates abstract classifier */
+    abstract_classifier_create(&abstract_classifier, classifier, options->abstract_domain, &options->tier);
+    profiler_exit(&options->profiler);
+
+
+    /* Opens counterexamples file, if necessary */
+    if (options->counterexamples_path != NULL) {
+        counterexamples_file = fopen(options->counterexamples_path, "w");
+        if (counterexamples_file == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot write counterexamples file %s.\n", __FILE__, __LINE__, options->counterexamples_path);
+            abort();
+        }
+    }
+
+
+    /* Reads record of previous run, if necessary */
+    if (options->record_path != NULL) {
+        incremental_create(&incremental, classifier, dataset, options);
+    }
+
+
+    /* Analyses dataset */
+    print_heading(*options);
+    analyse(
+        &summary,
+        classifier,
+        abstract_classifier,
+        dataset,
+        options,
+        counterexamples_file,
+        options->record_path != NULL ? &incremental : NULL,
+        diagram
+    );
+
+
+    /* Displays summary */
+    print_summary_heading(0);
+    print_summary(summary, NULL, 0);
+    print_latency_heading(0);
+    print_latency(&summary, NULL, 0);
+    print_throughput_heading(0);
+    print_throughput(&summary, NULL, 0);
+    if (options->summary_json_path != NULL) {
+        write_summaries_json(options->summary_json_path, NULL, NULL, 0, &summary);
+    }
+    if (options->cascade.enabled) {
+        cascade_print_summary(options->cascade, stdout);
+    }
+    if (options->profiler.enabled) {
+        profiler_print(&options->profiler, stdout);
+    }
+
+
+    /* Writes record, if necessary */
+    if (options->record_path != NULL) {
+        print_incremental_summary(incremental, summary);
+        incremental_delete(&incremental, options);
+    }
+
+
+    /* Closes counterexamples file, if necessary */
+    if (counterexamples_file != NULL) {
+        fclose(counterexamples_file);
+    }
+
+
+    /* Deallocates memory */
+    classifier_delete(&classifier);
+    if (compiled_forest != NULL) {
+        compiled_forest_delete(&compiled_forest);
+    }
+    if (diagram != NULL) {
+        decision_diagram_delete(&diagram);
+    }
+    dataset_delete(&dataset);
+    abstract_classifier_delete(&abstract_classifier);
+}
+
+
+
+/**
+ * Copies a tier list.
+ *
+ * @param[out] copy Copy of tier list
+ * @param[in] tier Tier list to copy
+ */
+static void copy_tier(Tier *copy, const Tier tier) {
+    tier_create(copy, tier.size);
+    if (tier.size > 0) {
+        memcpy(copy->tiers, tier.tiers, tier.size * sizeof(unsigned int));
+    }
+}
+
+
+
+/**
+ * Reads jobs from a jobs file.
+ *
+ * Each job starts from default options, overridden by pairs preceding
+ * the first job and then by pairs of the job itself.
+ *
+ * @param[out] jobs Array of jobs, allocated by this function, each owning
+ *             its tier list
+ * @param[in] configuration Configuration read from jobs file
+ * @param[in] defaults Default options
+ * @return Number of jobs
+ */
+static unsigned int read_jobs(
+    Job **jobs,
+    const Configuration configuration,
+    const Options defaults
+) {
+    Options common = defaults;
+    unsigned int i, n_jobs = 0;
+    Job *job = NULL;
+
+    copy_tier(&common.tier, defaults.tier);
+
+    *jobs = (Job *) malloc(configuration.size * sizeof(Job));
+    if (*jobs == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < configuration.size; ++i) {
+        const Option *option = configuration.options + i;
+
+        if (strcmp(option->name, "job") == 0) {
+            job = *jobs + n_jobs;
+            job->name = option->value;
+            job->options = common;
+            copy_tier(&job->options.tier, common.tier);
+            ++n_jobs;
+        }
+        else {
+            options_set(job != NULL ? &job->options : &common, option->name, option->value);
+        }
+    }
+    tier_delete(&common.tier);
+
+    for (i = 0; i < n_jobs; ++i) {
+        if ((*jobs)[i].options.classifier_path == NULL
+            || (*jobs)[i].options.dataset_path == NULL) {
+            fprintf(stderr, "[%s: %d] Job %s lacks classifier or dataset.\n", __FILE__, __LINE__, (*jobs)[i].name);
+            abort();
+        }
+    }
+
+    return n_jobs;
+}
+
+
+
+/**
+ * Finds index of a path in an array of paths, appending it if missing.
+ *
+ * @param[in,out] paths Array of paths
+ * @param[in,out] n_paths Number of paths
+ * @param[in] path Path to find
+ * @return Index of path
+ */
+static unsigned int find_path(const char **paths, unsigned int *n_paths, const char *path) {
+    unsigned int i;
+
+    for (i = 0; i < *n_paths; ++i) {
+        if (strcmp(paths[i], path) == 0) {
+            return i;
+        }
+    }
+
+    paths[*n_paths] = path;
+    return (*n_paths)++;
+}
+
+
+
+/**
+ * Runs every job of a jobs file, loading each distinct classifier and
+ * dataset once.
+ *
+ * @param[in,out] options Default options
+ */
+static void run_jobs(Options *options) {
+    FILE *stream, **counterexamples_files, **job_counterexamples_files;
+    Configuration configuration;
+    Job *jobs;
+    Summary *summaries, total;
+    Stopwatch stopwatch;
+    Classifier *classifiers;
+    Dataset *datasets;
+    const char **classifier_paths, **dataset_paths, **counterexamples_paths;
+    unsigned int *classifier_index, *dataset_index,
+                 i, n_jobs, n_run, n_classifiers = 0, n_datasets = 0,
+                 n_counterexamples = 0, job_column_size = 3;
+
+    if (options->compiled_model_path != NULL) {
+        fprintf(stderr, "[%s: %d] Compiled models are not supported with jobs files.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (options->record_path != NULL) {
+        fprintf(stderr, "[%s: %d] Incremental analysis is not supported with jobs files.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (options->diagram_path != NULL) {
+        fprintf(stderr, "[%s: %d] Decision diagrams are not supported with jobs files.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+
+    /* Reads jobs */
+    stream = fopen(options->jobs_path, "r");
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot read jobs file %s.\n", __FILE__, __LINE__, options->jobs_path);
+        abort();
+    }
+    configuration_create(&configuration);
+    configuration_read(&configuration, stream);
+    fclose(stream);
+    n_jobs = read_jobs(&jobs, configuration, *options);
+
+
+    /* Reads each distinct classifier and dataset once */
+    summaries = (Summary *) malloc(n_jobs * sizeof(Summary));
+    classifiers = (Classifier *) malloc(n_jobs * sizeof(Classifier));
+    datasets = (Dataset *) malloc(n_jobs * sizeof(Dataset));
+    classifier_paths = (const char **) malloc(n_jobs * sizeof(const char *));
+    dataset_paths = (const char **) malloc(n_jobs * sizeof(const char *));
+    classifier_index = (unsigned int *) malloc(n_jobs * sizeof(unsigned int));
+    dataset_index = (unsigned int *) malloc(n_jobs * sizeof(unsigned int));
+    counterexamples_paths = (const char **) malloc(n_jobs * sizeof(const char *));
+    counterexamples_files = (FILE **) malloc(n_jobs * sizeof(FILE *));
+    job_counterexamples_files = (FILE **) malloc(n_jobs * sizeof(FILE *));
+    if (n_jobs > 0 && (summaries == NULL || classifiers == NULL || datasets == NULL
+        || classifier_paths == NULL || dataset_paths == NULL
+        || classifier_index == NULL || dataset_index == NULL
+        || counterexamples_paths == NULL || counterexamples_files == NULL
+        || job_counterexamples_files == NULL)) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    for (i = 0; i < n_jobs; ++i) {
+        const unsigned int n = n_classifiers, m = n_datasets;
+
+        classifier_index[i] = find_path(classifier_paths, &n_classifiers, jobs[i].options.classifier_path);
+        if (n_classifiers > n) {
+            profiler_enter(&options->profiler, "model load");
+            stream = fopen(jobs[i].options.classifier_path, "r");
+            if (stream == NULL) {
+                fprintf(stderr, "[%s: %d] Cannot read classifier %s of job %s.\n", __FILE__, __LINE__, jobs[i].options.classifier_path, jobs[i].name);
+                abort();
+            }
+            classifier_silva_read(classifiers + classifier_index[i], stream);
+            fclose(stream);
+            optimize_classifier(classifiers[classifier_index[i]], options);
+            profiler_exit(&options->profiler);
+        }
+
+        dataset_index[i] = find_path(dataset_paths, &n_datasets, jobs[i].options.dataset_path);
+        if (n_datasets > m) {
+            profiler_enter(&options->profiler, "dataset load");
+            stream = fopen(jobs[i].options.dataset_path, "r");
+            if (stream == NULL) {
+                fprintf(stderr, "[%s: %d] Cannot read dataset %s of job %s.\n", __FILE__, __LINE__, jobs[i].options.dataset_path, jobs[i].name);
+                abort();
+            }
+            datasets[dataset_index[i]] = dataset_read(stream);
+            fclose(stream);
+            profiler_exit(&options->profiler);
+        }
+
+        if (strlen(jobs[i].name) > job_column_size) {
+            job_column_size = strlen(jobs[i].name);
+        }
+    }
+
+
+    /* Opens counterexamples files, which identify records by sample index only */
+    for (i = 0; i < n_jobs; ++i) {
+        const char *path = jobs[i].options.counterexamples_path;
+        const unsigned int n = n_counterexamples;
+        unsigned int index;
+
+        job_counterexamples_files[i] = NULL;
+        if (path == NULL) {
+            continue;
+        }
+
+        index = find_path(counterexamples_paths, &n_counterexamples, path);
+        if (n_counterexamples == n) {
+            fprintf(stderr, "[%s: %d] Counterexamples file %s of job %s is shared with another job.\n", __FILE__, __LINE__, path, jobs[i].name);
+            abort();
+        }
+        counterexamples_files[index] = fopen(path, "w");
+        if (counterexamples_files[index] == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot write counterexamples file %s of job %s.\n", __FILE__, __LINE__, path, jobs[i].name);
+            abort();
+        }
+        job_counterexamples_files[i] = counterexamples_files[index];
+    }
+
+
+    /* Runs jobs, up to the one interrupted by a stop signal */
+    summary_init(&total);
+    print_heading(*options);
+    stopwatch_create(&stopwatch);
+    stopwatch_start(stopwatch);
+    for (i = 0; i < n_jobs && stop_signal == 0; ++i) {
+        Options *job_options = &jobs[i].options;
+        const Classifier classifier = classifiers[classifier_index[i]];
+        AbstractClassifier abstract_classifier;
+
+        if (classifier_get_type(classifier) == CLASSIFIER_FOREST) {
+            forest_set_voting_scheme(classifier_get_forest(classifier), job_options->voting_scheme);
+        }
+
+        abstract_classifier_create(&abstract_classifier, classifier, job_options->abstract_domain, &job_options->tier);
+        analyse(summaries + i, classifier, abstract_classifier, datasets[dataset_index[i]], job_options, job_counterexamples_files[i], NULL, NULL);
+        if (job_options->cascade.enabled) {
+            cascade_print_summary(job_options->cascade, stdout);
+        }
+        profiler_merge(&options->profiler, &job_options->profiler);
+
+        abstract_classifier_delete(&abstract_classifier);
+        tier_delete(&job_options->tier);
+
+        summary_add(&total, summaries + i);
+    }
+    n_run = i;
+    stopwatch_pause(stopwatch);
+    total.wall_time = stopwatch_get_elapsed_time_seconds(stopwatch);
+    stopwatch_delete(&stopwatch);
+    for (; i < n_jobs; ++i) {
+        tier_delete(&jobs[i].options.tier);
+    }
+
+
+    /* Displays combined summary */
+    print_summary_heading(job_column_size);
+    for (i = 0; i < n_run; ++i) {
+        print_summary(summaries[i], jobs[i].name, job_column_size);
+    }
+    print_summary(total, "ALL", job_column_size);
+    print_latency_heading(job_column_size);
+    for (i = 0; i < n_run; ++i) {
+        print_latency(summaries + i, jobs[i].name, job_column_size);
+    }
+    print_latency(&total, "ALL", job_column_size);
+    print_throughput_heading(job_column_size);
+    for (i = 0; i < n_run; ++i) {
+        print_throughput(summaries + i, jobs[i].name, job_column_size);
+    }
+    print_throughput(&total, "ALL", job_column_size);
+    if (options->summary_json_path != NULL) {
+        write_summaries_json(options->summary_json_path, summaries, jobs, n_run, &total);
+    }
+    if (options->profiler.enabled) {
+        profiler_print(&options->profiler, stdout);
+    }
+
+
+    /* Closes counterexamples files */
+    for (i = 0; i < n_counterexamples; ++i) {
+        fclose(counterexamples_files[i]);
+    }
+
+
+    /* Closes perturbation files opened by jobs file, which jobs may share */
+    for (i = 0; i < n_jobs; ++i) {
+        const FILE *perturbation_stream = jobs[i].options.perturbation.type == PERTURBATION_FROM_FILE
+                                        ? jobs[i].options.perturbation.data.from_file.stream
+                                        : NULL;
+        unsigned int j, is_closed = perturbation_stream == NULL
+                                 || (options->perturbation.type == PERTURBATION_FROM_FILE
+                                     && perturbation_stream == options->perturbation.data.from_file.stream);
+
+        for (j = 0; j < i && !is_closed; ++j) {
+            is_closed = jobs[j].options.perturbation.type == PERTURBATION_FROM_FILE
+                     && jobs[j].options.perturbation.data.from_file.stream == perturbation_stream;
+        }
+        if (!is_closed) {
+            fclose(jobs[i].options.perturbation.data.from_file.stream);
+        }
+    }
+
+
+    /* Deallocates memory */
+    for (i = 0; i < n_classifiers; ++i) {
+        classifier_delete(classifiers + i);
+    }
+    for (i = 0; i < n_datasets; ++i) {
+        dataset_delete(datasets + i);
+    }
+    free(summaries);
+    free(classifiers);
+    free(datasets);
+    free(classifier_paths);
+    free(dataset_paths);
+    free(classifier_index);
+    free(dataset_index);
+    free(counterexamples_paths);
+    free(counterexamples_files);
+    free(job_counterexamples_files);
+    free(jobs);
+    configuration_delete(configuration);
+}
+
+
+
+/**
+ * Main.
+ * 
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @return EXIT_SUCCESS in case of success, EXIT_FAILURE otherwise
+ */
+int main(const int argc, const char **argv) {
+    Options options;
+
+
+    /* Parses command-line arguments */
+    if (argc < 3) {
+        display_help(argc, argv);
+        exit(EXIT_FAILURE);
+    }
+    options_read(&options, argc, argv);
+    if (options.trace_path != NULL) {
+        trace_create(&options.trace, options.trace_path);
+    }
+    install_signal_handlers(1);
+
+
+    /* Runs analyses, which stop early on SIGINT or SIGTERM */
+    if (options.jobs_path != NULL) {
+        run_jobs(&options);
+    }
+    else {
+        run_single(&options);
+    }
+
+
+    /* Deallocates memory */
+    if (options.trace != NULL) {
+        trace_delete(&options.trace);
+    }
+    options_delete(&options);
+
+    return stop_signal != 0 ? 128 + stop_signal : EXIT_SUCCESS;
 }
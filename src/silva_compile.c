@@ -0,0 +1,265 @@
+/**
+ * Compiles a forest into native code.
+ *
+ * Generates C source code computing the concrete decision function of a
+ * forest and, optionally, builds it into a shared object which can be
+ * loaded by silva with option --compiled-model. Alternatively, compiles a
+ * forest into a decision diagram, which can be loaded by silva with option
+ * --diagram.
+ *
+ * @file silva_compile.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "classifier.h"
+#include "data_mappers/classifier_silva.h"
+#include "data_mappers/forest_c.h"
+#include "decision_diagram.h"
+
+
+/** Default compiler, used when environment variable CC is not set. */
+#define DEFAULT_COMPILER "cc"
+
+/** Options given to the compiler to build a shared object. */
+#define COMPILER_OPTIONS "-O2 -shared -fPIC"
+
+
+
+/**
+ * Displays help message.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ */
+static void display_help(const int argc, const char **argv) {
+    (void) argc;
+
+    printf("Usage: %s <classifier> <source> [shared object]\n", argv[0]);
+    printf("       %s --diagram <classifier> <diagram> [voting] [budget]\n", argv[0]);
+    printf("Generates C source code computing the decision function of a forest,\n");
+    printf("or compiles it into a decision diagram.\n\n");
+
+    printf("Mandatory arguments:\n");
+    printf("\t%-16s Path to classifier file, in silva format\n", "classifier");
+    printf("\t%-16s Path to C source file to generate\n", "source");
+    printf("\n");
+
+    printf("Optional arguments:\n");
+    printf("\t%-16s Path to shared object to build from source, using compiler in environment variable CC (default: %s)\n", "shared object", DEFAULT_COMPILER);
+    printf("\t%-16s Voting scheme of the diagram, {max | average | softargmax} (default: max)\n", "voting");
+    printf("\t%-16s Maximum number of nodes held while building the diagram (default: %u)\n", "budget", DECISION_DIAGRAM_BUDGET);
+    printf("\n");
+
+    printf("Examples:\n");
+    printf("\t%s my_classifier.silva my_classifier.c my_classifier.so\n", argv[0]);
+    printf("\tsilva my_classifier.silva my_dataset.csv --compiled-model ./my_classifier.so\n");
+    printf("\t%s --diagram my_classifier.silva my_classifier.diagram max\n", argv[0]);
+    printf("\tsilva my_classifier.silva my_dataset.csv --voting max --diagram my_classifier.diagram\n");
+}
+
+
+
+/**
+ * Builds a shared object from a C source file.
+ *
+ * The compiler is run directly, without a shell, so paths are passed
+ * verbatim whatever characters they contain. Compiler and options are
+ * split on blanks, so that CC may carry flags of its own.
+ *
+ * @param[in] compiler Compiler, possibly followed by options
+ * @param[in] source_path Path to C source file
+ * @param[in] shared_path Path to shared object to build
+ * @return 1 if shared object was built, 0 otherwise
+ */
+static unsigned int build_shared_object(const char *compiler, const char *source_path, const char *shared_path) {
+    const char *separators = " \t";
+    char *command, *token;
+    char **arguments;
+    unsigned int n_arguments = 0;
+    pid_t pid;
+    int status;
+
+    command = (char *) malloc(strlen(compiler) + strlen(COMPILER_OPTIONS) + 2);
+    arguments = (char **) malloc((strlen(compiler) + strlen(COMPILER_OPTIONS) + 8) * sizeof(char *));
+    if (command == NULL || arguments == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    sprintf(command, "%s %s", compiler, COMPILER_OPTIONS);
+    for (token = strtok(command, separators); token != NULL; token = strtok(NULL, separators)) {
+        arguments[n_arguments++] = token;
+    }
+    arguments[n_arguments++] = "-o";
+    arguments[n_arguments++] = (char *) shared_path;
+    arguments[n_arguments++] = (char *) source_path;
+    arguments[n_arguments] = NULL;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == -1) {
+        fprintf(stderr, "[%s: %d] Cannot start compiler.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (pid == 0) {
+        execvp(arguments[0], arguments);
+        fprintf(stderr, "[%s: %d] Cannot run compiler %s.\n", __FILE__, __LINE__, arguments[0]);
+        _exit(127);
+    }
+    if (waitpid(pid, &status, 0) == -1) {
+        status = -1;
+    }
+
+    free(arguments);
+    free(command);
+
+    return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+
+/**
+ * Compiles a forest into a decision diagram.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector, starting with --diagram
+ * @return EXIT_SUCCESS in case of success, EXIT_FAILURE if budget was
+ *         exceeded
+ */
+static int compile_diagram(const int argc, const char **argv) {
+    FILE *classifier_file, *diagram_file;
+    Classifier classifier;
+    DecisionDiagram diagram;
+    ForestVotingScheme voting_scheme = FOREST_VOTING_MAX;
+    unsigned int budget = DECISION_DIAGRAM_BUDGET;
+    int status = EXIT_SUCCESS;
+
+    if (argc > 4) {
+        if (strcmp(argv[4], "max") == 0) {
+            voting_scheme = FOREST_VOTING_MAX;
+        }
+        else if (strcmp(argv[4], "average") == 0) {
+            voting_scheme = FOREST_VOTING_AVERAGE;
+        }
+        else if (strcmp(argv[4], "softargmax") == 0) {
+            voting_scheme = FOREST_VOTING_SOFTARGMAX;
+        }
+        else {
+            fprintf(stderr, "[%s: %d] Unsupported voting scheme.\n", __FILE__, __LINE__);
+            abort();
+        }
+    }
+    if (argc > 5 && sscanf(argv[5], "%u", &budget) != 1) {
+        fprintf(stderr, "[%s: %d] Invalid budget.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+
+    /* Reads classifier */
+    classifier_file = fopen(argv[2], "r");
+    if (classifier_file == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot read classifier %s.\n", __FILE__, __LINE__, argv[2]);
+        abort();
+    }
+    classifier_silva_read(&classifier, classifier_file);
+    fclose(classifier_file);
+    if (classifier_get_type(classifier) != CLASSIFIER_FOREST) {
+        fprintf(stderr, "[%s: %d] Only forests can be compiled.\n", __FILE__, __LINE__);
+        abort();
+    }
+    forest_set_voting_scheme(classifier_get_forest(classifier), voting_scheme);
+
+
+    /* Builds and writes diagram, if within budget */
+    if (decision_diagram_create(&diagram, classifier_get_forest(classifier), budget)) {
+        diagram_file = fopen(argv[3], "wb");
+        if (diagram_file == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot write file %s.\n", __FILE__, __LINE__, argv[3]);
+            abort();
+        }
+        decision_diagram_write(diagram, diagram_file);
+        fclose(diagram_file);
+        printf("Decision diagram has %u nodes.\n", decision_diagram_get_n_nodes(diagram));
+        decision_diagram_delete(&diagram);
+    }
+    else {
+        fprintf(stderr, "Decision diagram exceeds budget of %u nodes: no diagram was written, run silva without --diagram to use the search.\n", budget);
+        status = EXIT_FAILURE;
+    }
+
+
+    /* Deallocates memory */
+    classifier_delete(&classifier);
+
+    return status;
+}
+
+
+
+/**
+ * Main.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @return EXIT_SUCCESS in case of success, EXIT_FAILURE otherwise
+ */
+int main(const int argc, const char **argv) {
+    FILE *classifier_file, *source_file;
+    Classifier classifier;
+    const char *compiler;
+    int status = EXIT_SUCCESS;
+
+    if (argc < 3 || (strcmp(argv[1], "--diagram") == 0 && argc < 4)) {
+        display_help(argc, argv);
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(argv[1], "--diagram") == 0) {
+        return compile_diagram(argc, argv);
+    }
+
+
+    /* Reads classifier */
+    classifier_file = fopen(argv[1], "r");
+    if (classifier_file == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot read classifier %s.\n", __FILE__, __LINE__, argv[1]);
+        abort();
+    }
+    classifier_silva_read(&classifier, classifier_file);
+    fclose(classifier_file);
+    if (classifier_get_type(classifier) != CLASSIFIER_FOREST) {
+        fprintf(stderr, "[%s: %d] Only forests can be compiled.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+
+    /* Generates source code */
+    source_file = fopen(argv[2], "w");
+    if (source_file == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot write file %s.\n", __FILE__, __LINE__, argv[2]);
+        abort();
+    }
+    forest_c_create(source_file, classifier_get_forest(classifier));
+    fclose(source_file);
+
+
+    /* Builds shared object, if necessary */
+    if (argc > 3) {
+        compiler = getenv("CC") != NULL ? getenv("CC") : DEFAULT_COMPILER;
+        if (!build_shared_object(compiler, argv[2], argv[3])) {
+            fprintf(stderr, "[%s: %d] Cannot build shared object %s with compiler %s.\n", __FILE__, __LINE__, argv[3], compiler);
+            status = EXIT_FAILURE;
+        }
+    }
+
+
+    /* Deallocates memory */
+    classifier_delete(&classifier);
+
+    return status;
+}
@@ -0,0 +1,111 @@
+/**
+ * Converts a dataset between formats.
+ *
+ * Reads a dataset in any supported format, recognized automatically, and
+ * writes it in the requested one, by default the compressed format.
+ *
+ * @file silva_convert.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dataset.h"
+
+
+
+/**
+ * Displays help message.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ */
+static void display_help(const int argc, const char **argv) {
+    (void) argc;
+
+    printf("Usage: %s <input> <output> [format]\n", argv[0]);
+    printf("Converts a dataset between formats.\n\n");
+
+    printf("Mandatory arguments:\n");
+    printf("\t%-16s Path to dataset file to read, in any format\n", "input");
+    printf("\t%-16s Path to dataset file to write\n", "output");
+    printf("\n");
+
+    printf("Optional arguments:\n");
+    printf("\t%-16s One of csv, binary, encoded, compressed (default: compressed)\n", "format");
+    printf("\n");
+
+    printf("Examples:\n");
+    printf("\t%s my_dataset.csv my_dataset.dat\n", argv[0]);
+    printf("\tsilva my_classifier.silva my_dataset.dat\n");
+}
+
+
+
+/**
+ * Reads a dataset format.
+ *
+ * @param[in] name Name of format
+ * @return Dataset format
+ */
+static DatasetFormat read_format(const char *name) {
+    if (strcmp(name, "csv") == 0) {
+        return DATASET_CSV;
+    }
+    if (strcmp(name, "binary") == 0) {
+        return DATASET_BINARY;
+    }
+    if (strcmp(name, "encoded") == 0) {
+        return DATASET_BINARY_ENCODED;
+    }
+    if (strcmp(name, "compressed") == 0) {
+        return DATASET_COMPRESSED;
+    }
+
+    fprintf(stderr, "[%s: %d] Unsupported dataset format %s.\n", __FILE__, __LINE__, name);
+    abort();
+}
+
+
+
+/**
+ * Main.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @return EXIT_SUCCESS in case of success, EXIT_FAILURE otherwise
+ */
+int main(const int argc, const char **argv) {
+    FILE *input_file, *output_file;
+    Dataset dataset;
+    DatasetFormat format;
+
+    if (argc < 3) {
+        display_help(argc, argv);
+        exit(EXIT_FAILURE);
+    }
+    format = argc > 3 ? read_format(argv[3]) : DATASET_COMPRESSED;
+
+
+    /* Reads dataset */
+    input_file = fopen(argv[1], "rb");
+    dataset = dataset_read(input_file);
+    fclose(input_file);
+
+
+    /* Writes dataset */
+    output_file = fopen(argv[2], "wb");
+    if (output_file == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot open %s.\n", __FILE__, __LINE__, argv[2]);
+        abort();
+    }
+    dataset_write(dataset, format, output_file);
+    fclose(output_file);
+
+
+    /* Deallocates memory */
+    dataset_delete(&dataset);
+
+    return EXIT_SUCCESS;
+}
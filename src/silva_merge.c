@@ -0,0 +1,537 @@
+/**
+ * Merges outputs of sharded silva runs.
+ *
+ * Reads the standard outputs of silva runs over distinct shards of the
+ * same analyses, then prints one report as if a single run analysed every
+ * shard: per-sample results ordered by classifier, dataset and sample ID,
+ * followed by summed summary and cascade statistics. Times are summed
+ * too, giving total analysis time across shards. Optionally merges
+ * counterexample files as well, ordered by sample ID.
+ *
+ * @file silva_merge.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+/** Number of integer columns of a summary row. */
+#define SUMMARY_N_COUNTS 9
+
+/** Maximum number of cascade stages. */
+#define MAX_CASCADE_STAGES 16
+
+/** Size of buffers for names. */
+#define NAME_SIZE 256
+
+
+
+/***********************************************************************
+ * Data structures.
+ **********************************************************************/
+
+/** Structure of a per-sample result, or counterexample, line. */
+struct line {
+    char *text;           /**< Line, including newline. */
+    unsigned int group;   /**< Index of classifier and dataset pair. */
+    unsigned int id;      /**< Sample ID. */
+    unsigned long order;  /**< Position in input, for a stable ordering. */
+};
+
+/** Type of a per-sample result, or counterexample, line. */
+typedef struct line Line;
+
+
+/** Structure of a summary row. */
+struct summary_row {
+    char name[NAME_SIZE];                    /**< Job name, empty if none. */
+    unsigned int size;                       /**< Number of samples. */
+    double time;                             /**< Analysis time. */
+    unsigned int counts[SUMMARY_N_COUNTS];   /**< Remaining columns. */
+};
+
+/** Type of a summary row. */
+typedef struct summary_row SummaryRow;
+
+
+/** Structure of a cascade row. */
+struct cascade_row {
+    char stage[NAME_SIZE];   /**< Name of stage. */
+    unsigned int n_entered;  /**< Samples entering stage. */
+    unsigned int n_decided;  /**< Samples decided by stage. */
+    double time;             /**< Time spent in stage. */
+};
+
+/** Type of a cascade row. */
+typedef struct cascade_row CascadeRow;
+
+
+/** Structure of a merged report. */
+struct report {
+    char *heading;                     /**< Heading of per-sample results. */
+    Line *lines;                       /**< Per-sample results. */
+    unsigned long n_lines;             /**< Number of per-sample results. */
+    unsigned long lines_capacity;      /**< Capacity of per-sample results. */
+    char **groups;                     /**< Classifier and dataset pairs. */
+    unsigned int n_groups;             /**< Number of pairs. */
+    unsigned long groups_capacity;     /**< Capacity of pairs. */
+    SummaryRow *summaries;             /**< Summary rows. */
+    unsigned int n_summaries;          /**< Number of summary rows. */
+    unsigned long summaries_capacity;  /**< Capacity of summary rows. */
+    CascadeRow cascade[MAX_CASCADE_STAGES];  /**< Cascade rows. */
+    unsigned int n_cascade;            /**< Number of cascade rows. */
+};
+
+/** Type of a merged report. */
+typedef struct report Report;
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Grows an array, if full.
+ *
+ * @param[in,out] array Pointer to array
+ * @param[in] size Number of elements
+ * @param[in,out] capacity Pointer to capacity
+ * @param[in] element_size Size of one element
+ */
+static void grow(void **array, const unsigned long size, unsigned long *capacity, const size_t element_size) {
+    if (size < *capacity) {
+        return;
+    }
+
+    *capacity = *capacity == 0 ? 64 : 2 * *capacity;
+    *array = realloc(*array, *capacity * element_size);
+    if (*array == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Duplicates a string.
+ *
+ * @param[in] string String
+ * @return Copy of string
+ */
+static char *duplicate(const char *string) {
+    char *copy = (char *) malloc(strlen(string) + 1);
+
+    if (copy == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    strcpy(copy, string);
+
+    return copy;
+}
+
+
+
+/**
+ * Compares lines by group, ID and input position.
+ *
+ * @param[in] a First line
+ * @param[in] b Second line
+ * @return Negative, zero or positive value as a precedes, equals or follows b
+ */
+static int compare_lines(const void *a, const void *b) {
+    const Line *x = (const Line *) a, *y = (const Line *) b;
+
+    if (x->group != y->group) {
+        return x->group < y->group ? -1 : 1;
+    }
+    if (x->id != y->id) {
+        return x->id < y->id ? -1 : 1;
+    }
+    return x->order < y->order ? -1 : x->order > y->order;
+}
+
+
+
+/**
+ * Returns index of a classifier and dataset pair, adding it if missing.
+ *
+ * @param[in,out] report Report
+ * @param[in] group Pair, as classifier and dataset separated by a space
+ * @return Index of pair
+ */
+static unsigned int find_group(Report *report, const char *group) {
+    unsigned int i;
+
+    for (i = 0; i < report->n_groups; ++i) {
+        if (strcmp(report->groups[i], group) == 0) {
+            return i;
+        }
+    }
+
+    grow((void **) &report->groups, report->n_groups, &report->groups_capacity, sizeof(char *));
+    report->groups[report->n_groups] = duplicate(group);
+    return report->n_groups++;
+}
+
+
+
+/**
+ * Adds a per-sample result line.
+ *
+ * @param[in,out] report Report
+ * @param[in] text Line
+ */
+static void add_sample_line(Report *report, const char *text) {
+    char classifier[NAME_SIZE], dataset[NAME_SIZE], group[2 * NAME_SIZE + 1];
+    unsigned int id;
+    Line *line;
+
+    if (sscanf(text, "%255s %255s %u", classifier, dataset, &id) != 3) {
+        fprintf(stderr, "[%s: %d] Cannot parse line: %s", __FILE__, __LINE__, text);
+        abort();
+    }
+    sprintf(group, "%s %s", classifier, dataset);
+
+    grow((void **) &report->lines, report->n_lines, &report->lines_capacity, sizeof(Line));
+    line = report->lines + report->n_lines;
+    line->text = duplicate(text);
+    line->group = find_group(report, group);
+    line->id = id;
+    line->order = report->n_lines;
+    ++report->n_lines;
+}
+
+
+
+/**
+ * Adds a summary row, summing it to the row of the same job.
+ *
+ * @param[in,out] report Report
+ * @param[in] text Line, without leading tag
+ */
+static void add_summary_row(Report *report, const char *text) {
+    SummaryRow row;
+    const char *numbers = text;
+    unsigned int i, j;
+    int n_read;
+
+    /* Skips headings */
+    if (strstr(text, "Size") != NULL) {
+        return;
+    }
+
+    /* Reads job name, if any, which adds a column to numeric ones */
+    for (i = 0, j = 0; text[i] != '\0'; ++i) {
+        j += !isspace((unsigned char) text[i]) && (i == 0 || isspace((unsigned char) text[i - 1]));
+    }
+    row.name[0] = '\0';
+    if (j > SUMMARY_N_COUNTS + 2) {
+        if (sscanf(text, " %255s%n", row.name, &n_read) != 1) {
+            fprintf(stderr, "[%s: %d] Cannot parse summary: %s", __FILE__, __LINE__, text);
+            abort();
+        }
+        numbers = text + n_read;
+    }
+
+    if (sscanf(numbers, "%u %lf%n", &row.size, &row.time, &n_read) != 2) {
+        fprintf(stderr, "[%s: %d] Cannot parse summary: %s", __FILE__, __LINE__, text);
+        abort();
+    }
+    numbers += n_read;
+    for (i = 0; i < SUMMARY_N_COUNTS; ++i) {
+        if (sscanf(numbers, "%u%n", row.counts + i, &n_read) != 1) {
+            fprintf(stderr, "[%s: %d] Cannot parse summary: %s", __FILE__, __LINE__, text);
+            abort();
+        }
+        numbers += n_read;
+    }
+
+    for (i = 0; i < report->n_summaries; ++i) {
+        SummaryRow *merged = report->summaries + i;
+        if (strcmp(merged->name, row.name) == 0) {
+            merged->size += row.size;
+            merged->time += row.time;
+            for (j = 0; j < SUMMARY_N_COUNTS; ++j) {
+                merged->counts[j] += row.counts[j];
+            }
+            return;
+        }
+    }
+
+    grow((void **) &report->summaries, report->n_summaries, &report->summaries_capacity, sizeof(SummaryRow));
+    report->summaries[report->n_summaries++] = row;
+}
+
+
+
+/**
+ * Adds a cascade row, summing it to the row of the same stage.
+ *
+ * @param[in,out] report Report
+ * @param[in] text Line, without leading tag
+ */
+static void add_cascade_row(Report *report, const char *text) {
+    CascadeRow row;
+    unsigned int i;
+
+    if (sscanf(text, "%255s %u %u %lf", row.stage, &row.n_entered, &row.n_decided, &row.time) != 4) {
+        return;
+    }
+
+    for (i = 0; i < report->n_cascade; ++i) {
+        if (strcmp(report->cascade[i].stage, row.stage) == 0) {
+            report->cascade[i].n_entered += row.n_entered;
+            report->cascade[i].n_decided += row.n_decided;
+            report->cascade[i].time += row.time;
+            return;
+        }
+    }
+
+    if (report->n_cascade == MAX_CASCADE_STAGES) {
+        fprintf(stderr, "[%s: %d] Too many cascade stages.\n", __FILE__, __LINE__);
+        abort();
+    }
+    report->cascade[report->n_cascade++] = row;
+}
+
+
+
+/**
+ * Reads the output of a shard.
+ *
+ * @param[in,out] report Report
+ * @param[in] path Path to output
+ */
+static void read_report(Report *report, const char *path) {
+    FILE *stream = fopen(path, "r");
+    char *text = NULL;
+    size_t capacity = 0;
+
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot read file %s.\n", __FILE__, __LINE__, path);
+        abort();
+    }
+
+    while (getline(&text, &capacity, stream) != -1) {
+        if (strncmp(text, "[SUMMARY]", 9) == 0) {
+            add_summary_row(report, text + 9);
+        }
+        else if (strncmp(text, "[CASCADE]", 9) == 0) {
+            add_cascade_row(report, text + 9);
+        }
+        else if (strncmp(text, "Classifier ", 11) == 0) {
+            if (report->heading == NULL) {
+                report->heading = duplicate(text);
+            }
+        }
+        else if (text[0] != '[' && text[0] != '\n') {
+            add_sample_line(report, text);
+        }
+    }
+
+    free(text);
+    fclose(stream);
+}
+
+
+
+/**
+ * Prints a merged report.
+ *
+ * @param[in] report Report
+ */
+static void print_report(const Report *report) {
+    unsigned int i, j, job_column_size = 3, has_jobs = 0;
+    unsigned long k;
+
+    if (report->heading != NULL) {
+        printf("%s", report->heading);
+    }
+    for (k = 0; k < report->n_lines; ++k) {
+        printf("%s", report->lines[k].text);
+    }
+
+    for (i = 0; i < report->n_summaries; ++i) {
+        if (report->summaries[i].name[0] != '\0') {
+            has_jobs = 1;
+            if (strlen(report->summaries[i].name) > job_column_size) {
+                job_column_size = strlen(report->summaries[i].name);
+            }
+        }
+    }
+
+    printf("[SUMMARY] ");
+    if (has_jobs) {
+        printf("%-*s ", job_column_size, "Job");
+    }
+    printf(
+        "%10s %10s %10s %10s %10s %10s %10s %10s %10s %12s %10s\n",
+        "Size", "Time (s)", "Correct", "Wrong", "Stable", "Unstable",
+        "No info", "Robust", "Fragile", "Vulnerable", "Broken"
+    );
+    for (i = 0; i < report->n_summaries; ++i) {
+        const SummaryRow *row = report->summaries + i;
+
+        printf("[SUMMARY] ");
+        if (has_jobs) {
+            printf("%-*s ", job_column_size, row->name);
+        }
+        printf("%10u %10g", row->size, row->time);
+        for (j = 0; j < SUMMARY_N_COUNTS; ++j) {
+            printf(" %*u", j == SUMMARY_N_COUNTS - 2 ? 12 : 10, row->counts[j]);
+        }
+        printf("\n");
+    }
+
+    if (report->n_cascade > 0) {
+        printf("[CASCADE] %10s %10s %10s %10s\n", "Stage", "Entered", "Decided", "Time (s)");
+        for (i = 0; i < report->n_cascade; ++i) {
+            printf(
+                "[CASCADE] %10s %10u %10u %10g\n",
+                report->cascade[i].stage,
+                report->cascade[i].n_entered,
+                report->cascade[i].n_decided,
+                report->cascade[i].time
+            );
+        }
+    }
+}
+
+
+
+/**
+ * Merges counterexample files, ordering them by sample ID.
+ *
+ * @param[in] output_path Path to merged file
+ * @param[in] input_paths Paths to counterexample files of shards
+ * @param[in] n_inputs Number of counterexample files
+ */
+static void merge_counterexamples(
+    const char *output_path,
+    const char **input_paths,
+    const unsigned int n_inputs
+) {
+    Line *lines = NULL;
+    unsigned long n_lines = 0, capacity = 0, k;
+    char *text = NULL;
+    size_t text_capacity = 0;
+    unsigned int i;
+    FILE *stream;
+
+    for (i = 0; i < n_inputs; ++i) {
+        stream = fopen(input_paths[i], "r");
+        if (stream == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot read file %s.\n", __FILE__, __LINE__, input_paths[i]);
+            abort();
+        }
+        while (getline(&text, &text_capacity, stream) != -1) {
+            grow((void **) &lines, n_lines, &capacity, sizeof(Line));
+            if (sscanf(text, "%u:", &lines[n_lines].id) != 1) {
+                fprintf(stderr, "[%s: %d] Cannot parse counterexample: %s", __FILE__, __LINE__, text);
+                abort();
+            }
+            lines[n_lines].text = duplicate(text);
+            lines[n_lines].group = 0;
+            lines[n_lines].order = n_lines;
+            ++n_lines;
+        }
+        fclose(stream);
+    }
+    free(text);
+
+    qsort(lines, n_lines, sizeof(Line), compare_lines);
+
+    stream = fopen(output_path, "w");
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot write file %s.\n", __FILE__, __LINE__, output_path);
+        abort();
+    }
+    for (k = 0; k < n_lines; ++k) {
+        fprintf(stream, "%s", lines[k].text);
+        free(lines[k].text);
+    }
+    fclose(stream);
+    free(lines);
+}
+
+
+
+/**
+ * Displays help message.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ */
+static void display_help(const int argc, const char **argv) {
+    (void) argc;
+
+    printf("Usage: %s <output>... [--counterexamples <merged> <counterexamples>...]\n", argv[0]);
+    printf("Merges outputs of silva runs over shards of the same analyses.\n\n");
+
+    printf("Mandatory arguments:\n");
+    printf("\t%-16s Path to standard output of a silva shard\n", "output");
+    printf("\n");
+
+    printf("Optional arguments:\n");
+    printf("\t%-32s Merges counterexample files of shards into a single file\n", "--counterexamples <merged> <counterexamples>...");
+    printf("\n");
+
+    printf("Examples:\n");
+    printf("\tsilva model.silva data.csv --shard 0/2 --counterexamples ce0.dat > out0.txt\n");
+    printf("\tsilva model.silva data.csv --shard 1/2 --counterexamples ce1.dat > out1.txt\n");
+    printf("\t%s out0.txt out1.txt --counterexamples ce.dat ce0.dat ce1.dat\n", argv[0]);
+}
+
+
+
+/**
+ * Main.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @return EXIT_SUCCESS in case of success, EXIT_FAILURE otherwise
+ */
+int main(const int argc, const char **argv) {
+    Report report;
+    unsigned int i;
+    unsigned long k;
+    int j;
+
+    if (argc < 2) {
+        display_help(argc, argv);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&report, 0, sizeof(Report));
+    for (j = 1; j < argc && strcmp(argv[j], "--counterexamples") != 0; ++j) {
+        read_report(&report, argv[j]);
+    }
+    if (j + 1 < argc) {
+        merge_counterexamples(argv[j + 1], argv + j + 2, argc - j - 2);
+    }
+
+    qsort(report.lines, report.n_lines, sizeof(Line), compare_lines);
+    print_report(&report);
+
+
+    /* Deallocates memory */
+    for (k = 0; k < report.n_lines; ++k) {
+        free(report.lines[k].text);
+    }
+    for (i = 0; i < report.n_groups; ++i) {
+        free(report.groups[i]);
+    }
+    free(report.lines);
+    free(report.groups);
+    free(report.summaries);
+    free(report.heading);
+
+    return EXIT_SUCCESS;
+}
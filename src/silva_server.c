@@ -0,0 +1,616 @@
+/**
+ * Verification server.
+ *
+ * Loads one or more classifiers once, then answers verification requests
+ * received over a Unix domain socket, using a pool of worker threads.
+ *
+ * Each connection is read by its own thread, which queues requests one at
+ * a time and waits for their replies; workers take single requests from
+ * the queue, so that idle connections never hold a worker.
+ *
+ * Protocol is line based. Each connection may stream any number of
+ * requests, which are answered in order:
+ *  - `VERIFY <model> <magnitude> <x_1> ... <x_n>` analyses the
+ *    \f$L_\infty\f$ ball of given magnitude around sample \f$x\f$ and
+ *    replies `RESULT <verdict> <labels> <time>`, where verdict is one of
+ *    `STABLE`, `UNSTABLE`, `UNKNOWN` and labels are the comma-separated
+ *    concrete labels of the sample. Unstable verdicts are followed by an
+ *    adversarial hyperrectangle on the same line;
+ *  - `MODELS` replies `MODELS <name>...`;
+ *  - `QUIT` closes the connection.
+ *
+ * Malformed requests are answered with `ERROR <message>`.
+ *
+ * @file silva_server.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "libsilva.h"
+
+
+/** Default number of worker threads. */
+#define N_WORKERS 4
+
+/** Maximum number of pending connections, and of pending requests. */
+#define QUEUE_SIZE 64
+
+
+
+/***********************************************************************
+ * Data structures.
+ **********************************************************************/
+
+/** Structure of a loaded model. */
+struct model {
+    const char *name;    /**< Name used in requests. */
+    SilvaModel model;    /**< Model. */
+};
+
+/** Type of a loaded model. */
+typedef struct model Model;
+
+
+/** Structure of a client connection. */
+struct connection {
+    FILE *in;                 /**< Request stream. */
+    FILE *out;                /**< Reply stream. */
+    unsigned int is_open;     /**< Tells whether connection stays open
+                                   after last request. */
+    unsigned int is_served;   /**< Tells whether last request was served. */
+    pthread_mutex_t lock;     /**< Lock on is_open and is_served. */
+    pthread_cond_t served;    /**< Signalled when last request is served. */
+};
+
+/** Type of a client connection. */
+typedef struct connection Connection;
+
+
+/** Structure of a request. */
+struct request {
+    Connection *connection;   /**< Connection the request comes from. */
+    char *line;               /**< Request line. */
+};
+
+/** Type of a request. */
+typedef struct request Request;
+
+
+/** Structure of a verification server. */
+struct server {
+    Model *models;               /**< Array of models. */
+    unsigned int n_models;       /**< Number of models. */
+    unsigned int timeout;        /**< Timeout per request (seconds). */
+    unsigned int memory_limit;   /**< Memory limit per request (megabytes),
+                                      0 for no limit. */
+    unsigned int use_cascade;    /**< Tells whether cascade is enabled. */
+    Request queue[QUEUE_SIZE];   /**< Circular queue of requests. */
+    unsigned int queue_head;     /**< Position of first request. */
+    unsigned int queue_size;     /**< Number of queued requests. */
+    pthread_mutex_t lock;        /**< Lock on queue. */
+    pthread_cond_t not_empty;    /**< Signalled when queue gets an element. */
+    pthread_cond_t not_full;     /**< Signalled when queue loses an element. */
+};
+
+/** Type of a verification server. */
+typedef struct server Server;
+
+
+/** Structure of the arguments of a reader thread. */
+struct reader_arguments {
+    Server *server;    /**< Server. */
+    int connection;    /**< Connection file descriptor. */
+};
+
+
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Finds a model by name.
+ *
+ * @param[in] server Server
+ * @param[in] name Name of the model
+ * @return Pointer to model, NULL if not found
+ */
+static Model *find_model(const Server *server, const char *name) {
+    unsigned int i;
+
+    for (i = 0; i < server->n_models; ++i) {
+        if (strcmp(server->models[i].name, name) == 0) {
+            return server->models + i;
+        }
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * Answers a verification request.
+ *
+ * @param[in] server Server
+ * @param[in,out] save_pointer Tokenizer state, positioned after command
+ * @param[out] out Reply stream
+ */
+static void handle_verify(const Server *server, char **save_pointer, FILE *out) {
+    const char *name = strtok_r(NULL, " \t\r\n", save_pointer),
+               *token;
+    Model *model;
+    unsigned int i, space_size, n_labels, is_first;
+    double magnitude, *sample, *counterexample;
+    unsigned char *labels;
+    SilvaContext context;
+    SilvaResult result;
+
+    if (name == NULL || (model = find_model(server, name)) == NULL) {
+        fprintf(out, "ERROR unknown model\n");
+        return;
+    }
+
+    token = strtok_r(NULL, " \t\r\n", save_pointer);
+    if (token == NULL || sscanf(token, "%lf", &magnitude) != 1) {
+        fprintf(out, "ERROR cannot parse magnitude\n");
+        return;
+    }
+
+    space_size = silva_model_get_feature_space_size(model->model);
+    n_labels = silva_model_get_n_labels(model->model);
+    sample = (double *) malloc(space_size * sizeof(double));
+    counterexample = (double *) malloc(2 * space_size * sizeof(double));
+    labels = (unsigned char *) malloc(n_labels * sizeof(unsigned char));
+    if (sample == NULL || counterexample == NULL || labels == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    for (i = 0; i < space_size; ++i) {
+        token = strtok_r(NULL, " \t\r\n", save_pointer);
+        if (token == NULL || sscanf(token, "%lf", sample + i) != 1) {
+            fprintf(out, "ERROR expected %u features\n", space_size);
+            free(labels);
+            free(counterexample);
+            free(sample);
+            return;
+        }
+    }
+
+
+    /* Runs analysis */
+    silva_context_create(&context, model->model);
+    silva_context_set_timeout(context, server->timeout);
+    silva_context_set_memory_limit(context, server->memory_limit);
+    silva_context_set_cascade(context, server->use_cascade, SILVA_DEFAULT_CASCADE_SAMPLES, SILVA_DEFAULT_CASCADE_BUDGET);
+    silva_verify(context, &result, sample, magnitude, labels, counterexample);
+    silva_context_delete(&context);
+
+
+    /* Replies */
+    fprintf(out, "RESULT %s ",
+        result.verdict == SILVA_STABLE
+        ? "STABLE"
+        : result.verdict == SILVA_UNSTABLE ? "UNSTABLE" : "UNKNOWN"
+    );
+    for (i = 0, is_first = 1; i < n_labels; ++i) {
+        if (labels[i]) {
+            fprintf(out, "%s%s", is_first ? "" : ",", silva_model_get_label(model->model, i));
+            is_first = 0;
+        }
+    }
+    fprintf(out, " %g", result.time);
+    if (result.verdict == SILVA_UNSTABLE) {
+        fprintf(out, " [");
+        for (i = 0; i < space_size; ++i) {
+            if (counterexample[2 * i] <= counterexample[2 * i + 1]) {
+                fprintf(out, "%s[%g,%g]", i > 0 ? "," : "", counterexample[2 * i], counterexample[2 * i + 1]);
+            }
+            else {
+                fprintf(out, "%sbottom", i > 0 ? "," : "");
+            }
+        }
+        fprintf(out, "]");
+    }
+    fprintf(out, "\n");
+
+
+    /* Deallocates memory */
+    free(labels);
+    free(counterexample);
+    free(sample);
+}
+
+
+
+/**
+ * Answers a request.
+ *
+ * @param[in] server Server
+ * @param[in,out] line Request line, modified by the tokenizer
+ * @param[out] out Reply stream
+ * @return 0 if connection has to be closed, 1 otherwise
+ */
+static unsigned int handle_request(const Server *server, char *line, FILE *out) {
+    char *command, *save_pointer;
+    unsigned int i;
+
+    command = strtok_r(line, " \t\r\n", &save_pointer);
+    if (command == NULL) {
+        return 1;
+    }
+
+    if (strcmp(command, "VERIFY") == 0) {
+        handle_verify(server, &save_pointer, out);
+    }
+    else if (strcmp(command, "MODELS") == 0) {
+        fprintf(out, "MODELS");
+        for (i = 0; i < server->n_models; ++i) {
+            fprintf(out, " %s", server->models[i].name);
+        }
+        fprintf(out, "\n");
+    }
+    else if (strcmp(command, "QUIT") == 0) {
+        return 0;
+    }
+    else {
+        fprintf(out, "ERROR unknown command\n");
+    }
+    fflush(out);
+
+    return 1;
+}
+
+
+
+/**
+ * Queues a request and waits until a worker has answered it.
+ *
+ * @param[in,out] server Server
+ * @param[in,out] connection Connection the request comes from
+ * @param[in] line Request line
+ * @return 0 if connection has to be closed, 1 otherwise
+ */
+static unsigned int submit_request(Server *server, Connection *connection, char *line) {
+    unsigned int is_open;
+
+    pthread_mutex_lock(&connection->lock);
+    connection->is_served = 0;
+    pthread_mutex_unlock(&connection->lock);
+
+    pthread_mutex_lock(&server->lock);
+    while (server->queue_size == QUEUE_SIZE) {
+        pthread_cond_wait(&server->not_full, &server->lock);
+    }
+    server->queue[(server->queue_head + server->queue_size) % QUEUE_SIZE].connection = connection;
+    server->queue[(server->queue_head + server->queue_size) % QUEUE_SIZE].line = line;
+    ++server->queue_size;
+    pthread_cond_signal(&server->not_empty);
+    pthread_mutex_unlock(&server->lock);
+
+    pthread_mutex_lock(&connection->lock);
+    while (!connection->is_served) {
+        pthread_cond_wait(&connection->served, &connection->lock);
+    }
+    is_open = connection->is_open;
+    pthread_mutex_unlock(&connection->lock);
+
+    return is_open;
+}
+
+
+
+/**
+ * Reader thread: queues requests streamed over a connection, one at a
+ * time, until it is closed.
+ *
+ * @param[in] data Pointer to reader arguments, freed by the reader
+ * @return NULL
+ */
+static void *reader(void *data) {
+    struct reader_arguments *arguments = (struct reader_arguments *) data;
+    Server *server = arguments->server;
+    Connection connection;
+    char *line = NULL;
+    size_t capacity = 0;
+
+    connection.in = fdopen(arguments->connection, "r");
+    connection.out = fdopen(dup(arguments->connection), "w");
+    if (connection.in == NULL || connection.out == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot open connection.\n", __FILE__, __LINE__);
+        if (connection.in != NULL) {
+            fclose(connection.in);
+        }
+        else {
+            close(arguments->connection);
+        }
+        if (connection.out != NULL) {
+            fclose(connection.out);
+        }
+        free(arguments);
+        return NULL;
+    }
+    free(arguments);
+    connection.is_open = 1;
+    connection.is_served = 1;
+    pthread_mutex_init(&connection.lock, NULL);
+    pthread_cond_init(&connection.served, NULL);
+
+    while (getline(&line, &capacity, connection.in) != -1
+           && submit_request(server, &connection, line)) {
+        continue;
+    }
+
+    pthread_cond_destroy(&connection.served);
+    pthread_mutex_destroy(&connection.lock);
+    free(line);
+    fclose(connection.in);
+    fclose(connection.out);
+
+    return NULL;
+}
+
+
+
+/**
+ * Worker thread: answers queued requests.
+ *
+ * @param[in] data Pointer to server
+ * @return NULL
+ */
+static void *worker(void *data) {
+    Server *server = (Server *) data;
+
+    while (1) {
+        Request request;
+        unsigned int is_open;
+
+        pthread_mutex_lock(&server->lock);
+        while (server->queue_size == 0) {
+            pthread_cond_wait(&server->not_empty, &server->lock);
+        }
+        request = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1) % QUEUE_SIZE;
+        --server->queue_size;
+        pthread_cond_signal(&server->not_full);
+        pthread_mutex_unlock(&server->lock);
+
+        is_open = handle_request(server, request.line, request.connection->out);
+
+        pthread_mutex_lock(&request.connection->lock);
+        request.connection->is_open = is_open;
+        request.connection->is_served = 1;
+        pthread_cond_signal(&request.connection->served);
+        pthread_mutex_unlock(&request.connection->lock);
+    }
+
+    return NULL;
+}
+
+
+
+/**
+ * Loads a model.
+ *
+ * @param[out] model Model to load
+ * @param[in] argument Either a path or name=path
+ * @param[in] voting_scheme Voting scheme for forests
+ */
+static void load_model(Model *model, const char *argument, const SilvaVotingScheme voting_scheme) {
+    const char *separator = strchr(argument, '='),
+               *path = separator != NULL ? separator + 1 : argument;
+
+    if (separator != NULL) {
+        char *name = (char *) malloc(separator - argument + 1);
+        if (name == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+            abort();
+        }
+        memcpy(name, argument, separator - argument);
+        name[separator - argument] = '\0';
+        model->name = name;
+    }
+    else {
+        model->name = argument;
+    }
+
+    if (silva_model_load(&model->model, path) != 0) {
+        fprintf(stderr, "[%s: %d] Cannot open file %s.\n", __FILE__, __LINE__, path);
+        abort();
+    }
+    silva_model_set_voting_scheme(model->model, voting_scheme);
+}
+
+
+
+/**
+ * Displays help message.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ */
+static void display_help(const int argc, const char **argv) {
+    (void) argc;
+
+    printf("Usage: %s <socket> <classifier>... [options]\n", argv[0]);
+    printf("Answers verification requests over a Unix domain socket.\n\n");
+
+    printf("Mandatory arguments:\n");
+    printf("\t%-16s Path to Unix domain socket to create\n", "socket");
+    printf("\t%-16s Path to classifier file, in silva format, optionally prefixed by a name as name=path\n", "classifier");
+    printf("\n");
+
+    printf("Optional arguments:\n");
+    printf("\t%-32s Number of worker threads (default: %u)\n", "--workers VALUE", N_WORKERS);
+    printf("\t%-32s Voting scheme to use for forests (default: max)\n", "--voting {max | average | softargmax}");
+    printf("\t%-32s Maximum allowed execution time for each request, in seconds (default: %u)\n", "--sample-timeout VALUE", SILVA_DEFAULT_TIMEOUT);
+    printf("\t%-32s Maximum memory held by the search of each request, in megabytes, 0 for no limit (default: 0)\n", "--sample-memory-limit VALUE");
+    printf("\t%-32s Analyses each request with a cascade: concrete attack, interval check, bounded search, full search\n", "--cascade");
+    printf("\n");
+
+    printf("Requests, one per line:\n");
+    printf("\tVERIFY <model> <magnitude> <x_1> ... <x_n>\n");
+    printf("\tMODELS\n");
+    printf("\tQUIT\n");
+}
+
+
+
+/**
+ * Main.
+ *
+ * @param[in] argc ARGument Counter
+ * @param[in] argv ARGument Vector
+ * @return EXIT_SUCCESS in case of success, EXIT_FAILURE otherwise
+ */
+int main(const int argc, const char **argv) {
+    Server server;
+    SilvaVotingScheme voting_scheme = SILVA_VOTING_MAX;
+    unsigned int n_workers = N_WORKERS, i;
+    struct sockaddr_un address;
+    struct reader_arguments *arguments;
+    pthread_t thread;
+    int listener, j;
+
+    if (argc < 3) {
+        display_help(argc, argv);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* Parses command-line arguments */
+    server.models = (Model *) malloc(argc * sizeof(Model));
+    if (server.models == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    server.n_models = 0;
+    server.timeout = SILVA_DEFAULT_TIMEOUT;
+    server.memory_limit = 0;
+    server.use_cascade = 0;
+    for (j = 2; j < argc; ++j) {
+        if (strcmp(argv[j], "--workers") == 0 && j + 1 < argc) {
+            ++j;
+            if (sscanf(argv[j], "%u", &n_workers) != 1 || n_workers < 1) {
+                fprintf(stderr, "[%s: %d] Number of workers must be at least 1.\n\n", __FILE__, __LINE__);
+                display_help(argc, argv);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[j], "--voting") == 0 && j + 1 < argc) {
+            ++j;
+            if (strcmp(argv[j], "max") == 0) {
+                voting_scheme = SILVA_VOTING_MAX;
+            }
+            else if (strcmp(argv[j], "average") == 0) {
+                voting_scheme = SILVA_VOTING_AVERAGE;
+            }
+            else if (strcmp(argv[j], "softargmax") == 0) {
+                voting_scheme = SILVA_VOTING_SOFTARGMAX;
+            }
+            else {
+                fprintf(stderr, "[%s: %d] Unsupported voting scheme %s.\n\n", __FILE__, __LINE__, argv[j]);
+                display_help(argc, argv);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[j], "--sample-timeout") == 0 && j + 1 < argc) {
+            ++j;
+            sscanf(argv[j], "%u", &server.timeout);
+        }
+        else if (strcmp(argv[j], "--sample-memory-limit") == 0 && j + 1 < argc) {
+            ++j;
+            sscanf(argv[j], "%u", &server.memory_limit);
+        }
+        else if (strcmp(argv[j], "--cascade") == 0) {
+            server.use_cascade = 1;
+        }
+    }
+
+
+    /* Loads models */
+    for (j = 2; j < argc; ++j) {
+        if (strcmp(argv[j], "--workers") == 0
+            || strcmp(argv[j], "--voting") == 0
+            || strcmp(argv[j], "--sample-timeout") == 0
+            || strcmp(argv[j], "--sample-memory-limit") == 0) {
+            ++j;
+        }
+        else if (strncmp(argv[j], "--", 2) != 0) {
+            load_model(server.models + server.n_models, argv[j], voting_scheme);
+            ++server.n_models;
+        }
+    }
+
+
+    /* Opens socket */
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1 || strlen(argv[1]) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "[%s: %d] Cannot create socket.\n", __FILE__, __LINE__);
+        abort();
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, argv[1]);
+    unlink(argv[1]);
+    if (bind(listener, (struct sockaddr *) &address, sizeof(address)) == -1
+        || listen(listener, QUEUE_SIZE) == -1) {
+        fprintf(stderr, "[%s: %d] Cannot listen on socket %s.\n", __FILE__, __LINE__, argv[1]);
+        abort();
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+
+    /* Starts workers */
+    server.queue_head = 0;
+    server.queue_size = 0;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.not_empty, NULL);
+    pthread_cond_init(&server.not_full, NULL);
+    for (i = 0; i < n_workers; ++i) {
+        if (pthread_create(&thread, NULL, worker, &server) != 0) {
+            fprintf(stderr, "[%s: %d] Cannot create worker.\n", __FILE__, __LINE__);
+            abort();
+        }
+        pthread_detach(thread);
+    }
+    fprintf(stderr, "Listening on %s with %u models and %u workers.\n", argv[1], server.n_models, n_workers);
+
+
+    /* Accepts connections, starting a reader for each of them */
+    while (1) {
+        const int connection = accept(listener, NULL, NULL);
+        if (connection == -1) {
+            continue;
+        }
+
+        arguments = (struct reader_arguments *) malloc(sizeof(struct reader_arguments));
+        if (arguments == NULL) {
+            fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+            abort();
+        }
+        arguments->server = &server;
+        arguments->connection = connection;
+        if (pthread_create(&thread, NULL, reader, arguments) != 0) {
+            fprintf(stderr, "[%s: %d] Cannot create reader.\n", __FILE__, __LINE__);
+            free(arguments);
+            close(connection);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,9 +1,11 @@
 /**
- * Implements a stopwatch to measure CPU time.
+ * Implements a stopwatch to measure wall time and CPU time.
  *
- * @file stopwatch.h
+ * @file stopwatch.c
  * @author Marco Zanella <marco.zanella.1991@gmail.com>
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include "stopwatch.h"
 
 #include <stdio.h>
@@ -13,12 +15,18 @@
 
 /** Structure of a stopwatch. */
 struct stopwatch {
-    double elapsed_time;  /**< Elapsed time, in milliseconds. */
-    clock_t start_clock;  /**< Start clock. */
+    double elapsed_time;  /**< Elapsed wall time, in seconds. */
+    double cpu_time;      /**< Elapsed CPU time, in seconds. */
+    double start_wall;    /**< Wall time at start, in seconds. */
+    double start_cpu;     /**< CPU time at start, in seconds. */
 };
 
 
 
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
 void stopwatch_create(Stopwatch *S) {
     Stopwatch s = (Stopwatch) malloc(sizeof(struct stopwatch));
     if (s == NULL) {
@@ -27,7 +35,9 @@ void stopwatch_create(Stopwatch *S) {
     }
 
     s->elapsed_time = 0.0;
-    s->start_clock = clock();
+    s->cpu_time = 0.0;
+    s->start_wall = stopwatch_read_clock(STOPWATCH_CLOCK_WALL);
+    s->start_cpu = stopwatch_read_clock(STOPWATCH_CLOCK_CPU);
 
     *S = s;
 }
@@ -57,12 +67,33 @@ double stopwatch_get_elapsed_time_seconds(const Stopwatch S) {
 
 
 
+double stopwatch_get_cpu_time_seconds(const Stopwatch S) {
+    if (S == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    return S->cpu_time;
+}
+
+
+
 double stopwatch_get_elapsed_time_milliseconds(const Stopwatch S) {
     return stopwatch_get_elapsed_time_seconds(S) * 1e3;
 }
 
 
 
+double stopwatch_read_clock(const StopwatchClock clock) {
+    struct timespec t;
+
+    clock_gettime(clock == STOPWATCH_CLOCK_CPU ? CLOCK_THREAD_CPUTIME_ID : CLOCK_MONOTONIC, &t);
+
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+
+
 void stopwatch_reset(Stopwatch S) {
     if (S == NULL) {
         fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
@@ -70,7 +101,9 @@ void stopwatch_reset(Stopwatch S) {
     }
 
     S->elapsed_time = 0.0;
-    S->start_clock = clock();
+    S->cpu_time = 0.0;
+    S->start_wall = stopwatch_read_clock(STOPWATCH_CLOCK_WALL);
+    S->start_cpu = stopwatch_read_clock(STOPWATCH_CLOCK_CPU);
 }
 
 
@@ -81,7 +114,8 @@ void stopwatch_start(Stopwatch S) {
         abort();
     }
 
-    S->start_clock = clock();
+    S->start_wall = stopwatch_read_clock(STOPWATCH_CLOCK_WALL);
+    S->start_cpu = stopwatch_read_clock(STOPWATCH_CLOCK_CPU);
 }
 
 
@@ -92,7 +126,8 @@ void stopwatch_pause(Stopwatch S) {
         abort();
     }
 
-    S->elapsed_time += (double) (clock() - S->start_clock) / (double) CLOCKS_PER_SEC;
+    S->elapsed_time += stopwatch_read_clock(STOPWATCH_CLOCK_WALL) - S->start_wall;
+    S->cpu_time += stopwatch_read_clock(STOPWATCH_CLOCK_CPU) - S->start_cpu;
 }
 
 
@@ -1,5 +1,9 @@
 /**
- * Defines a stopwatch to measure CPU time.
+ * Defines a stopwatch to measure wall time and CPU time.
+ *
+ * Elapsed time is wall time, read from a monotonic clock. CPU time is the
+ * one spent by the calling thread, so that neither is affected by other
+ * threads or processes running in parallel.
  *
  * @file stopwatch.h
  * @author Marco Zanella <marco.zanella.1991@gmail.com>
@@ -7,6 +11,13 @@
 #ifndef STOPWATCH_H
 #define STOPWATCH_H
 
+/** Clocks which can be read. */
+typedef enum {
+    STOPWATCH_CLOCK_WALL,  /**< Monotonic wall clock. */
+    STOPWATCH_CLOCK_CPU    /**< CPU clock of the calling thread. */
+} StopwatchClock;
+
+
 /** Type of a stopwatch. */
 typedef struct stopwatch *Stopwatch;
 
@@ -39,6 +50,15 @@ void stopwatch_delete(Stopwatch *S);
 double stopwatch_get_elapsed_time_seconds(const Stopwatch S);
 
 
+/**
+ * Returns CPU time of the calling thread in seconds.
+ *
+ * @param[in] S Stopwatch
+ * @return CPU time, in seconds
+ */
+double stopwatch_get_cpu_time_seconds(const Stopwatch S);
+
+
 /**
  * Returns elapsed time in milliseconds.
  *
@@ -49,6 +69,19 @@ double stopwatch_get_elapsed_time_milliseconds(const Stopwatch S);
 
 
 
+/**
+ * Reads a clock.
+ *
+ * Readings of the same clock can be subtracted to measure time without a
+ * stopwatch.
+ *
+ * @param[in] clock Clock
+ * @return Time, in seconds
+ */
+double stopwatch_read_clock(const StopwatchClock clock);
+
+
+
 /**
  * Resets a stopwatch.
  *
@@ -0,0 +1,177 @@
+/**
+ * Tests that compiled forests are attached only to the forest they were
+ * generated from.
+ *
+ * Two forests having the same number of trees, labels and features, but
+ * different thresholds, are written to temporary files; the first one is
+ * compiled into a shared object, which must be accepted by the first
+ * forest and rejected by the second one, since its decision function and
+ * reachable leaves refer to leaves of the first forest by position.
+ *
+ * @file compiled_forest.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../forest.h"
+#include "../compiled_forest.h"
+#include "../data_mappers/forest_silva.h"
+#include "../data_mappers/forest_c.h"
+
+
+/** Forest the shared object is generated from. */
+static const char * const FOREST_A =
+    "classifier-forest 2\n"
+    "classifier-decision-tree 2 2\n"
+    "a b\n"
+    "SPLIT 0 0.5\n"
+    "LEAF 1 0\n"
+    "LEAF 0 1\n"
+    "classifier-decision-tree 2 2\n"
+    "a b\n"
+    "SPLIT 1 0.5\n"
+    "LEAF 0 1\n"
+    "LEAF 1 0\n";
+
+/** Forest of the same shape, with different thresholds. */
+static const char * const FOREST_B =
+    "classifier-forest 2\n"
+    "classifier-decision-tree 2 2\n"
+    "a b\n"
+    "SPLIT 0 0.25\n"
+    "LEAF 1 0\n"
+    "LEAF 0 1\n"
+    "classifier-decision-tree 2 2\n"
+    "a b\n"
+    "SPLIT 1 0.75\n"
+    "LEAF 0 1\n"
+    "LEAF 1 0\n";
+
+
+
+/**
+ * Reads a forest from a string.
+ *
+ * @param[out] F Pointer to forest to read
+ * @param[in] text Forest, in silva format
+ */
+static void read_forest(Forest *F, const char *text) {
+    FILE *stream = tmpfile();
+
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot create temporary file.\n", __FILE__, __LINE__);
+        abort();
+    }
+    fputs(text, stream);
+    rewind(stream);
+    forest_silva_read(F, stream);
+    fclose(stream);
+}
+
+
+
+/**
+ * Tells whether attaching a compiled forest to a forest aborts.
+ *
+ * Attachment runs in a child process, so that an abort does not stop the
+ * test.
+ *
+ * @param[in] C Compiled forest
+ * @param[in] F Forest
+ * @return 1 if attachment aborted, 0 otherwise
+ */
+static unsigned int attach_aborts(const CompiledForest C, Forest F) {
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == -1) {
+        fprintf(stderr, "[%s: %d] Cannot start child process.\n", __FILE__, __LINE__);
+        abort();
+    }
+    if (pid == 0) {
+        /* Expected error message is not shown */
+        if (freopen("/dev/null", "w", stderr) == NULL) {
+            _exit(EXIT_FAILURE);
+        }
+        compiled_forest_attach(C, F);
+        _exit(EXIT_SUCCESS);
+    }
+
+    waitpid(pid, &status, 0);
+
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+
+
+/**
+ * Main.
+ *
+ * @return EXIT_SUCCESS if every check passes, EXIT_FAILURE otherwise
+ */
+int main(void) {
+    char source_path[] = "/tmp/silva-test-XXXXXX", shared_path[sizeof(source_path) + 3], command[256];
+    const char *compiler = getenv("CC") != NULL ? getenv("CC") : "cc";
+    Forest A, B;
+    CompiledForest C;
+    FILE *source;
+    int fd;
+    unsigned int n_failures = 0;
+
+    read_forest(&A, FOREST_A);
+    read_forest(&B, FOREST_B);
+
+
+    /* Compiles first forest */
+    fd = mkstemp(source_path);
+    if (fd == -1 || (source = fdopen(fd, "w")) == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot create temporary file.\n", __FILE__, __LINE__);
+        abort();
+    }
+    forest_c_create(source, A);
+    fclose(source);
+    sprintf(shared_path, "%s.so", source_path);
+    sprintf(command, "%s -x c -O0 -shared -fPIC -o '%s' '%s'", compiler, shared_path, source_path);
+    if (system(command) != 0) {
+        fprintf(stderr, "[%s: %d] Cannot build shared object: %s\n", __FILE__, __LINE__, command);
+        remove(source_path);
+        return EXIT_FAILURE;
+    }
+    compiled_forest_create(&C, shared_path);
+
+
+    /* Checks attachment */
+    if (attach_aborts(C, A)) {
+        printf("FAIL: compiled forest rejected by its own forest\n");
+        ++n_failures;
+    }
+    else {
+        printf("PASS: compiled forest accepted by its own forest\n");
+    }
+    if (!attach_aborts(C, B)) {
+        printf("FAIL: compiled forest accepted by another forest of the same shape\n");
+        ++n_failures;
+    }
+    else {
+        printf("PASS: compiled forest rejected by another forest of the same shape\n");
+    }
+
+
+    /* Deallocates memory */
+    compiled_forest_delete(&C);
+    forest_delete(&A);
+    forest_delete(&B);
+    remove(source_path);
+    remove(shared_path);
+
+    return n_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
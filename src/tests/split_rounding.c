@@ -0,0 +1,209 @@
+/**
+ * Tests analysis of splits whose thresholds are rounded when stored.
+ *
+ * Random three-label forests are generated with thresholds which single
+ * precision cannot represent exactly, and samples are built from those
+ * thresholds, so that with STORAGE=FLOAT they fall between the two
+ * rounded thresholds of a split. For every voting scheme, a region of
+ * radius zero must be stable, and the midpoint of every counterexample
+ * must get labels different from those of its sample. Checks hold in
+ * every build, but are meaningful with STORAGE=FLOAT.
+ *
+ * @file split_rounding.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../libsilva.h"
+
+
+/** Number of features. */
+#define SPACE_SIZE 3
+
+/** Number of labels. */
+#define N_LABELS 3
+
+/** Number of trees of each forest. */
+#define N_TREES 8
+
+/** Maximum depth of trees. */
+#define MAX_DEPTH 4
+
+/** Maximum number of thresholds of a forest. */
+#define MAX_THRESHOLDS (N_TREES << MAX_DEPTH)
+
+/** Number of forests generated for each voting scheme. */
+#define N_FORESTS 8
+
+/** Number of samples analysed for each forest. */
+#define N_SAMPLES 40
+
+/** Magnitude of perturbations of non-zero radius. */
+#define MAGNITUDE 0.05
+
+/** Timeout of each analysis, in seconds. */
+#define TIMEOUT 5
+
+
+
+/**
+ * Returns a random number in [0, 1).
+ *
+ * @return Random number
+ */
+static double random_unit(void) {
+    return (double) rand() / ((double) RAND_MAX + 1.0);
+}
+
+
+
+/**
+ * Writes a random subtree, collecting its thresholds.
+ *
+ * @param[in,out] stream Stream
+ * @param[out] thresholds Thresholds of the forest
+ * @param[in,out] n_thresholds Number of thresholds
+ * @param[in] depth Remaining depth
+ */
+static void write_subtree(FILE *stream, double *thresholds, unsigned int *n_thresholds, const unsigned int depth) {
+    if (depth == 0 || random_unit() < 0.2) {
+        fprintf(stream, "LEAF %u %u %u\n", rand() % 10, rand() % 10, 1 + rand() % 9);
+    }
+    else {
+        const double threshold = random_unit();
+        fprintf(stream, "SPLIT %u %.9f\n", rand() % SPACE_SIZE, threshold);
+        thresholds[(*n_thresholds)++] = threshold;
+        write_subtree(stream, thresholds, n_thresholds, depth - 1);
+        write_subtree(stream, thresholds, n_thresholds, depth - 1);
+    }
+}
+
+
+
+/**
+ * Writes a random forest, collecting its thresholds as written.
+ *
+ * @param[in] path Path of forest
+ * @param[out] thresholds Thresholds of the forest
+ * @return Number of thresholds
+ */
+static unsigned int write_forest(const char *path, double *thresholds) {
+    FILE *stream = fopen(path, "w");
+    unsigned int t, i, n_thresholds = 0;
+    char text[32];
+
+    if (stream == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot create temporary file.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(stream, "classifier-forest %u\n", N_TREES);
+    for (t = 0; t < N_TREES; ++t) {
+        fprintf(stream, "classifier-decision-tree %u %u\na b c\n", SPACE_SIZE, N_LABELS);
+        write_subtree(stream, thresholds, &n_thresholds, MAX_DEPTH);
+    }
+    fclose(stream);
+
+    /* Thresholds as parsed back from the file */
+    for (i = 0; i < n_thresholds; ++i) {
+        sprintf(text, "%.9f", thresholds[i]);
+        thresholds[i] = strtod(text, NULL);
+    }
+
+    return n_thresholds;
+}
+
+
+
+/**
+ * Main.
+ *
+ * @return EXIT_SUCCESS if every check passes, EXIT_FAILURE otherwise
+ */
+int main(void) {
+    const char *scheme_names[] = {"max", "average", "softargmax"};
+    const SilvaVotingScheme schemes[] = {SILVA_VOTING_MAX, SILVA_VOTING_AVERAGE, SILVA_VOTING_SOFTARGMAX};
+    char path[] = "/tmp/silva-test-XXXXXX";
+    double thresholds[MAX_THRESHOLDS];
+    unsigned int scheme, f, i, j, n_failures = 0;
+    int fd;
+
+    /* File is reopened by name whenever forests are rewritten */
+    fd = mkstemp(path);
+    if (fd == -1) {
+        fprintf(stderr, "[%s: %d] Cannot create temporary file.\n", __FILE__, __LINE__);
+        abort();
+    }
+    close(fd);
+    srand(42);
+
+    for (scheme = 0; scheme < 3; ++scheme) {
+        unsigned int n_unstable_points = 0, n_wrong_counterexamples = 0, n_counterexamples = 0;
+
+        for (f = 0; f < N_FORESTS; ++f) {
+            const unsigned int n_thresholds = write_forest(path, thresholds);
+            SilvaModel model;
+            SilvaContext context;
+
+            if (silva_model_load(&model, path) != 0) {
+                fprintf(stderr, "[%s: %d] Cannot read model %s.\n", __FILE__, __LINE__, path);
+                abort();
+            }
+            silva_model_set_voting_scheme(model, schemes[scheme]);
+            silva_context_create(&context, model);
+            silva_context_set_timeout(context, TIMEOUT);
+
+            for (i = 0; i < N_SAMPLES; ++i) {
+                double sample[SPACE_SIZE], box[2 * SPACE_SIZE], midpoint[SPACE_SIZE];
+                unsigned char labels[N_LABELS], midpoint_labels[N_LABELS];
+                SilvaResult result;
+
+                for (j = 0; j < SPACE_SIZE; ++j) {
+                    sample[j] = n_thresholds > 0 && random_unit() < 0.7
+                              ? thresholds[rand() % n_thresholds]
+                              : random_unit();
+                }
+
+                silva_verify(context, &result, sample, 0.0, labels, NULL);
+                if (result.verdict == SILVA_UNSTABLE) {
+                    ++n_unstable_points;
+                }
+
+                silva_verify(context, &result, sample, MAGNITUDE, labels, box);
+                if (result.verdict == SILVA_UNSTABLE) {
+                    ++n_counterexamples;
+                    for (j = 0; j < SPACE_SIZE; ++j) {
+                        midpoint[j] = box[2 * j] + (box[2 * j + 1] - box[2 * j]) / 2.0;
+                    }
+                    silva_verify(context, &result, midpoint, 0.0, midpoint_labels, NULL);
+                    if (memcmp(labels, midpoint_labels, sizeof(labels)) == 0) {
+                        ++n_wrong_counterexamples;
+                    }
+                }
+            }
+
+            silva_context_delete(&context);
+            silva_model_delete(&model);
+        }
+
+        if (n_unstable_points > 0 || n_wrong_counterexamples > 0) {
+            printf(
+                "FAIL: %s voting: %u regions of radius zero unstable, %u of %u counterexamples get labels of their sample\n",
+                scheme_names[scheme], n_unstable_points, n_wrong_counterexamples, n_counterexamples
+            );
+            ++n_failures;
+        }
+        else {
+            printf("PASS: %s voting: regions of radius zero stable, %u counterexamples hold\n", scheme_names[scheme], n_counterexamples);
+        }
+    }
+
+    remove(path);
+
+    return n_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
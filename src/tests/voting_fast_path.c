@@ -0,0 +1,262 @@
+/**
+ * Tests the binary-classification fast path of hyperrectangle analysis.
+ *
+ * Random two-label forests are generated with both kinds of leaves, the
+ * ones counting samples and the ones holding logarithmic probabilities.
+ * Each forest has a twin with a third label which never gets maximal
+ * score, so that the twin is analysed by the generic n-label kernels
+ * while the original takes the fast path based on score margin. For
+ * every voting scheme, both forests must give the same verdict on the
+ * same regions, and every region declared stable around a sample having
+ * a single label must contain only points getting that label.
+ *
+ * @file voting_fast_path.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../libsilva.h"
+
+
+/** Number of features. */
+#define SPACE_SIZE 3
+
+/** Number of trees of each forest. */
+#define N_TREES 12
+
+/** Maximum depth of trees. */
+#define MAX_DEPTH 3
+
+/** Number of forests generated for each kind of leaf. */
+#define N_FORESTS 8
+
+/** Number of samples analysed for each forest and voting scheme. */
+#define N_SAMPLES 40
+
+/** Number of random points checked in each stable region. */
+#define N_POINTS 200
+
+/** Magnitude of perturbations. */
+#define MAGNITUDE 0.1
+
+/** Timeout of each analysis, in seconds. */
+#define TIMEOUT 5
+
+
+
+/**
+ * Returns a random number in [0, 1).
+ *
+ * @return Random number
+ */
+static double random_unit(void) {
+    return (double) rand() / ((double) RAND_MAX + 1.0);
+}
+
+
+
+/**
+ * Writes a random subtree to two streams, the second one having an
+ * additional label which never gets maximal score.
+ *
+ * @param[in,out] binary Stream of two-label forest
+ * @param[in,out] padded Stream of three-label forest
+ * @param[in] is_logarithmic 1 to write logarithmic leaves, 0 otherwise
+ * @param[in] depth Remaining depth
+ */
+static void write_subtree(FILE *binary, FILE *padded, const unsigned int is_logarithmic, const unsigned int depth) {
+    if (depth == 0 || random_unit() < 0.2) {
+        if (is_logarithmic) {
+            const double a = -3.0 * random_unit(), b = -3.0 * random_unit();
+            fprintf(binary, "LEAF_LOGARITHMIC %.2f %.2f\n", a, b);
+            fprintf(padded, "LEAF_LOGARITHMIC %.2f %.2f -1000\n", a, b);
+        }
+        else {
+            const unsigned int a = rand() % 10, b = 1 + rand() % 9;
+            fprintf(binary, "LEAF %u %u\n", a, b);
+            fprintf(padded, "LEAF %u %u 0\n", a, b);
+        }
+    }
+    else {
+        const unsigned int feature = rand() % SPACE_SIZE;
+        const double threshold = random_unit();
+        fprintf(binary, "SPLIT %u %.3f\n", feature, threshold);
+        fprintf(padded, "SPLIT %u %.3f\n", feature, threshold);
+        write_subtree(binary, padded, is_logarithmic, depth - 1);
+        write_subtree(binary, padded, is_logarithmic, depth - 1);
+    }
+}
+
+
+
+/**
+ * Writes a random forest and its twin with an additional label.
+ *
+ * @param[in] binary_path Path of two-label forest
+ * @param[in] padded_path Path of three-label forest
+ * @param[in] is_logarithmic 1 to write logarithmic leaves, 0 otherwise
+ */
+static void write_forests(const char *binary_path, const char *padded_path, const unsigned int is_logarithmic) {
+    FILE *binary = fopen(binary_path, "w"),
+         *padded = fopen(padded_path, "w");
+    unsigned int t;
+
+    if (binary == NULL || padded == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot create temporary file.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    fprintf(binary, "classifier-forest %u\n", N_TREES);
+    fprintf(padded, "classifier-forest %u\n", N_TREES);
+    for (t = 0; t < N_TREES; ++t) {
+        fprintf(binary, "classifier-decision-tree %u 2\na b\n", SPACE_SIZE);
+        fprintf(padded, "classifier-decision-tree %u 3\na b c\n", SPACE_SIZE);
+        write_subtree(binary, padded, is_logarithmic, MAX_DEPTH);
+    }
+
+    fclose(binary);
+    fclose(padded);
+}
+
+
+
+/**
+ * Loads a model.
+ *
+ * @param[out] M Pointer to model to load
+ * @param[in] path Path of model
+ * @param[in] voting_scheme Voting scheme
+ */
+static void load_model(SilvaModel *M, const char *path, const SilvaVotingScheme voting_scheme) {
+    if (silva_model_load(M, path) != 0) {
+        fprintf(stderr, "[%s: %d] Cannot read model %s.\n", __FILE__, __LINE__, path);
+        abort();
+    }
+    silva_model_set_voting_scheme(*M, voting_scheme);
+}
+
+
+
+/**
+ * Checks that every point of a random sample of a region gets given
+ * labels.
+ *
+ * @param[in,out] C Context
+ * @param[in] sample Center of the region
+ * @param[in] labels Expected labels
+ * @return 1 if every point gets expected labels, 0 otherwise
+ */
+static unsigned int check_region(SilvaContext C, const double *sample, const unsigned char *labels) {
+    double point[SPACE_SIZE];
+    unsigned char point_labels[2];
+    SilvaResult result;
+    unsigned int i, j;
+
+    for (i = 0; i < N_POINTS; ++i) {
+        for (j = 0; j < SPACE_SIZE; ++j) {
+            point[j] = sample[j] + MAGNITUDE * (2.0 * random_unit() - 1.0);
+        }
+        silva_verify(C, &result, point, 0.0, point_labels, NULL);
+        if (memcmp(point_labels, labels, sizeof(point_labels)) != 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+
+/**
+ * Main.
+ *
+ * @return EXIT_SUCCESS if every check passes, EXIT_FAILURE otherwise
+ */
+int main(void) {
+    const char *scheme_names[] = {"max", "average", "softargmax"},
+               *kind_names[] = {"LEAF", "LEAF_LOGARITHMIC"};
+    const SilvaVotingScheme schemes[] = {SILVA_VOTING_MAX, SILVA_VOTING_AVERAGE, SILVA_VOTING_SOFTARGMAX};
+    char binary_path[] = "/tmp/silva-test-XXXXXX", padded_path[] = "/tmp/silva-test-XXXXXX";
+    unsigned int kind, scheme, f, i, j, n_failures = 0;
+    int binary_fd, padded_fd;
+
+    /* Files are reopened by name whenever forests are rewritten */
+    binary_fd = mkstemp(binary_path);
+    padded_fd = mkstemp(padded_path);
+    if (binary_fd == -1 || padded_fd == -1) {
+        fprintf(stderr, "[%s: %d] Cannot create temporary file.\n", __FILE__, __LINE__);
+        abort();
+    }
+    close(binary_fd);
+    close(padded_fd);
+    srand(42);
+
+    for (kind = 0; kind < 2; ++kind) {
+        for (scheme = 0; scheme < 3; ++scheme) {
+            unsigned int n_mismatches = 0, n_unsound = 0, n_compared = 0;
+
+            for (f = 0; f < N_FORESTS; ++f) {
+                SilvaModel binary, padded;
+                SilvaContext binary_context, padded_context;
+
+                write_forests(binary_path, padded_path, kind);
+                load_model(&binary, binary_path, schemes[scheme]);
+                load_model(&padded, padded_path, schemes[scheme]);
+                silva_context_create(&binary_context, binary);
+                silva_context_create(&padded_context, padded);
+                silva_context_set_timeout(binary_context, TIMEOUT);
+                silva_context_set_timeout(padded_context, TIMEOUT);
+
+                for (i = 0; i < N_SAMPLES; ++i) {
+                    double sample[SPACE_SIZE];
+                    unsigned char labels[2], padded_labels[3];
+                    SilvaResult fast, generic;
+
+                    for (j = 0; j < SPACE_SIZE; ++j) {
+                        sample[j] = random_unit();
+                    }
+                    silva_verify(binary_context, &fast, sample, MAGNITUDE, labels, NULL);
+                    silva_verify(padded_context, &generic, sample, MAGNITUDE, padded_labels, NULL);
+                    if (fast.verdict == SILVA_UNKNOWN || generic.verdict == SILVA_UNKNOWN) {
+                        continue;
+                    }
+
+                    ++n_compared;
+                    if (fast.verdict != generic.verdict || memcmp(labels, padded_labels, sizeof(labels)) != 0) {
+                        ++n_mismatches;
+                    }
+                    if (fast.verdict == SILVA_STABLE && labels[0] != labels[1]
+                        && !check_region(binary_context, sample, labels)) {
+                        ++n_unsound;
+                    }
+                }
+
+                silva_context_delete(&padded_context);
+                silva_context_delete(&binary_context);
+                silva_model_delete(&padded);
+                silva_model_delete(&binary);
+            }
+
+            if (n_mismatches > 0 || n_unsound > 0 || n_compared == 0) {
+                printf(
+                    "FAIL: %s leaves, %s voting: %u of %u verdicts differ from generic path, %u stable regions contain other labels\n",
+                    kind_names[kind], scheme_names[scheme], n_mismatches, n_compared, n_unsound
+                );
+                ++n_failures;
+            }
+            else {
+                printf("PASS: %s leaves, %s voting: %u verdicts match generic path\n", kind_names[kind], scheme_names[scheme], n_compared);
+            }
+        }
+    }
+
+    remove(binary_path);
+    remove(padded_path);
+
+    return n_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,204 @@
+/**
+ * Implements a trace of timestamped events.
+ *
+ * Trace files are JSON arrays of events, as read by Chrome and Perfetto
+ * trace viewers. Timestamps are read from the monotonic clock, in
+ * microseconds, thus events of different processes are comparable.
+ *
+ * @file trace.c
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace.h"
+#include "stopwatch.h"
+#include "descriptor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/** Maximum size of a formatted event. */
+#define TRACE_EVENT_SIZE 256
+
+
+/** Structure of an event. */
+struct trace_event {
+    TracePhase phase;   /**< Phase of event. */
+    const char *name;   /**< Name of event. */
+    double timestamp;   /**< Timestamp, in microseconds. */
+    const char *key_1;  /**< Name of first argument, or NULL. */
+    double value_1;     /**< Value of first argument. */
+    const char *key_2;  /**< Name of second argument, or NULL. */
+    double value_2;     /**< Value of second argument. */
+};
+
+
+/** Structure of a trace. */
+struct trace {
+    int fd;                       /**< Descriptor of trace file. */
+    unsigned int n_events;        /**< Number of buffered events. */
+    struct trace_event *events;   /**< Buffered events. */
+    char *text;                   /**< Buffer of formatted events. */
+};
+
+
+
+/***********************************************************************
+ * Internal functions.
+ **********************************************************************/
+
+/**
+ * Writes a buffer to the trace file, with a single write unless
+ * interrupted.
+ *
+ * @param[in] fd Descriptor of trace file
+ * @param[in] buffer Buffer
+ * @param[in] size Size of buffer
+ */
+static void write_all(const int fd, const char *buffer, size_t size) {
+    if (!descriptor_write_all(fd, buffer, size)) {
+        fprintf(stderr, "[%s: %d] Cannot write trace.\n", __FILE__, __LINE__);
+        abort();
+    }
+}
+
+
+
+/**
+ * Formats an event.
+ *
+ * @param[out] text Formatted event
+ * @param[in] event Event
+ * @param[in] pid Identifier of process
+ * @return Number of characters written
+ */
+static int format_event(char *text, const struct trace_event *event, const int pid) {
+    int n = snprintf(
+        text,
+        TRACE_EVENT_SIZE,
+        "{\"name\":\"%s\",\"cat\":\"silva\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d",
+        event->name,
+        (char) event->phase,
+        event->timestamp,
+        pid,
+        pid
+    );
+
+    if (event->phase == TRACE_INSTANT) {
+        n += snprintf(text + n, TRACE_EVENT_SIZE - n, ",\"s\":\"t\"");
+    }
+    if (event->key_1 != NULL) {
+        n += snprintf(text + n, TRACE_EVENT_SIZE - n, ",\"args\":{\"%s\":%.17g", event->key_1, event->value_1);
+        if (event->key_2 != NULL) {
+            n += snprintf(text + n, TRACE_EVENT_SIZE - n, ",\"%s\":%.17g", event->key_2, event->value_2);
+        }
+        n += snprintf(text + n, TRACE_EVENT_SIZE - n, "}");
+    }
+    n += snprintf(text + n, TRACE_EVENT_SIZE - n, "},\n");
+
+    return n;
+}
+
+
+
+/***********************************************************************
+ * Public functions.
+ **********************************************************************/
+
+void trace_create(Trace *T, const char *path) {
+    Trace t = (Trace) malloc(sizeof(struct trace));
+
+    if (t == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    t->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (t->fd == -1) {
+        fprintf(stderr, "[%s: %d] Cannot open trace file %s.\n", __FILE__, __LINE__, path);
+        abort();
+    }
+
+    t->n_events = 0;
+    t->events = (struct trace_event *) malloc(TRACE_BUFFER_SIZE * sizeof(struct trace_event));
+    t->text = (char *) malloc(TRACE_BUFFER_SIZE * TRACE_EVENT_SIZE);
+    if (t->events == NULL || t->text == NULL) {
+        fprintf(stderr, "[%s: %d] Cannot allocate memory.\n", __FILE__, __LINE__);
+        abort();
+    }
+    write_all(t->fd, "[\n", 2);
+
+    *T = t;
+}
+
+
+
+void trace_delete(Trace *T) {
+    int n;
+
+    if (T == NULL || *T == NULL) {
+        fprintf(stderr, "[%s: %d] Unexpected NULL pointer.\n", __FILE__, __LINE__);
+        abort();
+    }
+
+    /* Closes the array with a metadata event, having no trailing comma */
+    trace_flush(*T);
+    n = snprintf(
+        (*T)->text,
+        TRACE_EVENT_SIZE,
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"silva\"}}\n]\n",
+        (int) getpid()
+    );
+    write_all((*T)->fd, (*T)->text, n);
+    close((*T)->fd);
+
+    free((*T)->events);
+    free((*T)->text);
+    free(*T);
+    *T = NULL;
+}
+
+
+
+void trace_add(
+    Trace T,
+    const TracePhase phase,
+    const char *name,
+    const char *key_1,
+    const double value_1,
+    const char *key_2,
+    const double value_2
+) {
+    struct trace_event *event;
+
+    if (T->n_events == TRACE_BUFFER_SIZE) {
+        trace_flush(T);
+    }
+
+    event = T->events + T->n_events++;
+    event->phase = phase;
+    event->name = name;
+    event->timestamp = stopwatch_read_clock(STOPWATCH_CLOCK_WALL) * 1e6;
+    event->key_1 = key_1;
+    event->value_1 = value_1;
+    event->key_2 = key_2;
+    event->value_2 = value_2;
+}
+
+
+
+void trace_flush(Trace T) {
+    const int pid = (int) getpid();
+    size_t size = 0;
+    unsigned int i;
+
+    for (i = 0; i < T->n_events; ++i) {
+        size += format_event(T->text + size, T->events + i, pid);
+    }
+    write_all(T->fd, T->text, size);
+    T->n_events = 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * Defines a trace of timestamped events.
+ *
+ * Events are kept in a fixed-size buffer of the trace, one per process,
+ * and appended to the trace file in Chrome trace JSON format when the
+ * buffer is full or flushed, so that recording an event only costs a
+ * clock read. Each flush is a single write to a file opened in append
+ * mode, thus processes forked after a flush may share a trace; events of
+ * a process are shown on a single track, whose thread identifier is the
+ * process identifier. A trace is not thread-safe: threads recording
+ * events concurrently need a trace each.
+ *
+ * @file trace.h
+ * @author Marco Zanella <marco.zanella.1991@gmail.com>
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+
+/** Number of events buffered before being written. */
+#define TRACE_BUFFER_SIZE 4096
+
+
+/** Phases of an event, as given by the Chrome trace format. */
+typedef enum {
+    TRACE_BEGIN = 'B',   /**< Begin of a duration. */
+    TRACE_END = 'E',     /**< End of the last duration begun. */
+    TRACE_INSTANT = 'i'  /**< Instant event. */
+} TracePhase;
+
+
+/** Type of a trace. */
+typedef struct trace *Trace;
+
+
+
+/**
+ * Creates a trace, truncating its file.
+ *
+ * @param[out] T Pointer to trace
+ * @param[in] path Path to trace file
+ * @warning #trace_delete should be called to ensure proper memory
+ *          deallocation and a well-formed trace file.
+ */
+void trace_create(Trace *T, const char *path);
+
+
+/**
+ * Deletes a trace, writing pending events and closing its file.
+ *
+ * Must be called by the process which created the trace, once other
+ * processes sharing it are over.
+ *
+ * @param[in,out] T Pointer to trace
+ */
+void trace_delete(Trace *T);
+
+
+
+/**
+ * Records an event with up to two numeric arguments.
+ *
+ * @param[in,out] T Trace
+ * @param[in] phase Phase of event
+ * @param[in] name Name of event, a string literal
+ * @param[in] key_1 Name of first argument, a string literal, or NULL
+ * @param[in] value_1 Value of first argument
+ * @param[in] key_2 Name of second argument, a string literal, or NULL
+ * @param[in] value_2 Value of second argument
+ * @warning Concurrent calls on the same trace are not safe.
+ */
+void trace_add(
+    Trace T,
+    const TracePhase phase,
+    const char *name,
+    const char *key_1,
+    const double value_1,
+    const char *key_2,
+    const double value_2
+);
+
+
+/**
+ * Writes buffered events to the trace file.
+ *
+ * Should be called before forking and before a forked process exits.
+ *
+ * @param[in,out] T Trace
+ */
+void trace_flush(Trace T);
+
+#endif
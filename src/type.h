@@ -12,17 +12,137 @@
 #include <math.h>
 
 #ifdef ENFORCE_SOUNDNESS
-    /** Sets floating point rounding mode to \f$\rightarrow -\infty\f$. */
-    #define round_down fesetround(FE_DOWNWARD)
+#include <fenv.h>
+
+/**
+ * Sound arithmetic relies on the floating point rounding mode being set to
+ * \f$\rightarrow +\infty\f$ once for a whole kernel (see #rounding_begin),
+ * instead of switching rounding mode at each operation. Upperbounds are
+ * computed directly, lowerbounds use the identity
+ * \f$\nabla(x \circ y) = -\Delta(-x \circ' y)\f$. Operations are plain
+ * floating point expressions, thus they can be pipelined and vectorised.
+ */
+
+/** Type of a saved floating point rounding mode. */
+typedef int RoundingMode;
+
+/**
+ * Sets floating point rounding mode to \f$\rightarrow +\infty\f$.
+ *
+ * @return Previous rounding mode, to be restored by #rounding_end
+ */
+static inline RoundingMode rounding_begin(void) {
+    const RoundingMode mode = fegetround();
+    fesetround(FE_UPWARD);
+    return mode;
+}
+
+/**
+ * Restores a floating point rounding mode.
+ *
+ * @param[in] mode Rounding mode returned by #rounding_begin
+ */
+static inline void rounding_end(const RoundingMode mode) {
+    fesetround(mode);
+}
+
+/** Computes \f$x + y\f$ rounded towards \f$-\infty\f$. */
+#define add_down(x, y) (-(-(x) - (y)))
+
+/** Computes \f$x + y\f$ rounded towards \f$+\infty\f$. */
+#define add_up(x, y) ((x) + (y))
+
+/** Computes \f$x - y\f$ rounded towards \f$-\infty\f$. */
+#define sub_down(x, y) (-((y) - (x)))
+
+/** Computes \f$x - y\f$ rounded towards \f$+\infty\f$. */
+#define sub_up(x, y) ((x) - (y))
+
+/** Computes \f$x \cdot y\f$ rounded towards \f$-\infty\f$. */
+#define mul_down(x, y) (-((-(x)) * (y)))
+
+/** Computes \f$x \cdot y\f$ rounded towards \f$+\infty\f$. */
+#define mul_up(x, y) ((x) * (y))
+
+/** Computes \f$x / y\f$ rounded towards \f$-\infty\f$. */
+#define div_down(x, y) (-((-(x)) / (y)))
+
+/** Computes \f$x / y\f$ rounded towards \f$+\infty\f$. */
+#define div_up(x, y) ((x) / (y))
+
+/** Computes a lowerbound of \f$e^x\f$, assuming a faithful exp. */
+#define exp_down(x) nextafter(exp(x), -INFINITY)
+
+/** Computes an upperbound of \f$e^x\f$, assuming a faithful exp. */
+#define exp_up(x) nextafter(exp(x), +INFINITY)
+
+/**
+ * Converts a lowerbound to #Real rounding towards \f$-\infty\f$: a plain
+ * conversion would round it upwards when #Real is narrower than the
+ * expression.
+ */
+#define to_real_down(x) (-(Real) -(x))
+
+/** Converts an upperbound to #Real rounding towards \f$+\infty\f$. */
+#define to_real_up(x) ((Real) (x))
 
-    /** Sets floating point rounding mode to \f$\rightarrow +\infty\f$. */
-    #define round_up   fesetround(FE_UPWARD)
 #else
-    /** Sets floating point rounding mode to \f$\rightarrow -\infty\f$. */
-    #define round_down
+/** Type of a saved floating point rounding mode. */
+typedef int RoundingMode;
+
+/**
+ * Sets floating point rounding mode to \f$\rightarrow +\infty\f$.
+ *
+ * @return Previous rounding mode, to be restored by #rounding_end
+ */
+static inline RoundingMode rounding_begin(void) {
+    return 0;
+}
 
-    /** Sets floating point rounding mode to \f$\rightarrow +\infty\f$. */
-    #define round_up
+/**
+ * Restores a floating point rounding mode.
+ *
+ * @param[in] mode Rounding mode returned by #rounding_begin
+ */
+static inline void rounding_end(const RoundingMode mode) {
+    (void) mode;
+}
+
+/** Computes \f$x + y\f$ rounded towards \f$-\infty\f$. */
+#define add_down(x, y) ((x) + (y))
+
+/** Computes \f$x + y\f$ rounded towards \f$+\infty\f$. */
+#define add_up(x, y) ((x) + (y))
+
+/** Computes \f$x - y\f$ rounded towards \f$-\infty\f$. */
+#define sub_down(x, y) ((x) - (y))
+
+/** Computes \f$x - y\f$ rounded towards \f$+\infty\f$. */
+#define sub_up(x, y) ((x) - (y))
+
+/** Computes \f$x \cdot y\f$ rounded towards \f$-\infty\f$. */
+#define mul_down(x, y) ((x) * (y))
+
+/** Computes \f$x \cdot y\f$ rounded towards \f$+\infty\f$. */
+#define mul_up(x, y) ((x) * (y))
+
+/** Computes \f$x / y\f$ rounded towards \f$-\infty\f$. */
+#define div_down(x, y) ((x) / (y))
+
+/** Computes \f$x / y\f$ rounded towards \f$+\infty\f$. */
+#define div_up(x, y) ((x) / (y))
+
+/** Computes a lowerbound of \f$e^x\f$. */
+#define exp_down(x) exp(x)
+
+/** Computes an upperbound of \f$e^x\f$. */
+#define exp_up(x) exp(x)
+
+/** Converts a lowerbound to #Real rounding towards \f$-\infty\f$. */
+#define to_real_down(x) ((Real) (x))
+
+/** Converts an upperbound to #Real rounding towards \f$+\infty\f$. */
+#define to_real_up(x) ((Real) (x))
 #endif
 
 
@@ -39,6 +159,50 @@ typedef float Real;
 #endif
 
 
+/** Type of a stored value: dataset features and split thresholds. */
+#ifdef STORAGE_FLOAT
+typedef float Storage;
+
+#else
+typedef double Storage;
+
+#endif
+
+
+/**
+ * Converts a value to #Storage, rounding towards \f$-\infty\f$.
+ *
+ * @param[in] x Value to convert
+ * @return Greatest stored value less than or equal to x
+ */
+static inline Storage storage_round_down(const double x) {
+    Storage y = (Storage) x;
+#ifdef STORAGE_FLOAT
+    if ((double) y > x) {
+        y = nextafterf(y, -INFINITY);
+    }
+#endif
+    return y;
+}
+
+
+/**
+ * Converts a value to #Storage, rounding towards \f$+\infty\f$.
+ *
+ * @param[in] x Value to convert
+ * @return Least stored value greater than or equal to x
+ */
+static inline Storage storage_round_up(const double x) {
+    Storage y = (Storage) x;
+#ifdef STORAGE_FLOAT
+    if ((double) y < x) {
+        y = nextafterf(y, +INFINITY);
+    }
+#endif
+    return y;
+}
+
+
 /**
  * Returns \f$\min(x, y)\f$.
  *